@@ -162,9 +162,20 @@
 #include <wchar.h>
 #ifdef __cplusplus
 #include <map>
+#include <vector>
 #endif
 
 #define MAX_FONT_SIZE 100
+#define FTGX_TEXT_BUFFER_SIZE 256 /**< Characters decoded by FT_DrawText/FT_GetWidth before the text buffer is grown. */
+
+#define FTGX_PREWARM_PRIORITY	20		/**< Thread priority of the glyph pre-warm worker. */
+#define FTGX_PREWARM_STACK_SIZE	32768	/**< Stack size of the glyph pre-warm worker. */
+
+#define FTGX_DEFAULT_GLYPH_BUDGET	(1024 * 1024)	/**< Default memory budget of the rendered glyph textures in bytes. */
+#define FTGX_FORMAT_COUNT	16	/**< Number of texture format (GX_TF_*) slots in ftgxCacheStats. */
+
+#define FTGX_CACHE_MAGIC	0x46544743	/**< Font cache file identifier ("FTGC"). */
+#define FTGX_CACHE_VERSION	1			/**< Font cache file layout version. */
 
 /*! \struct ftgxCharData_
  *
@@ -183,6 +194,7 @@ typedef struct ftgxCharData_ {
 	int16_t renderOffsetMin;	/**< Texture Y axis bearing minimum value. */
 
 	uint32_t* glyphDataTexture;	/**< Glyph texture bitmap data buffer. */
+	uint32_t lastUsed;			/**< Retrace count at which the glyph was last drawn or measured. */
 } ftgxCharData;
 
 /*! \struct ftgxDataOffset_
@@ -196,6 +208,31 @@ typedef struct ftgxDataOffset_ {
 	int16_t min;		/**< Minimum data offset. */
 } ftgxDataOffset;
 
+/*! \struct ftgxKerningPair_
+ *
+ * Prebaked kerning adjustment between two glyphs of the same size.
+ */
+typedef struct ftgxKerningPair_ {
+	uint16_t leftIndex;		/**< Glyph index of the left character. */
+	uint16_t rightIndex;	/**< Glyph index of the right character. */
+	int16_t deltaX;			/**< Kerning X adjustment in pixels. */
+	uint16_t padding;		/**< Unused, keeps the records 32-bit aligned. */
+} ftgxKerningPair;
+
+/*! \struct ftgxCacheStats_
+ *
+ * Glyph cache memory usage statistics.
+ */
+typedef struct ftgxCacheStats_ {
+	uint32_t budgetBytes;		/**< Memory budget of the rendered glyphs, 0 if unlimited. */
+	uint32_t totalBytes;		/**< Memory used by the rendered glyphs. */
+	uint32_t prebakedBytes;		/**< Memory used by the loaded font cache (not subject to the budget). */
+	uint32_t glyphCount;		/**< Number of rendered glyphs. */
+	uint32_t evictedCount;		/**< Number of glyphs evicted since start up. */
+	uint32_t sizeBytes[MAX_FONT_SIZE + 1];	/**< Memory used by the rendered glyphs per pixel size. */
+	uint32_t formatBytes[FTGX_FORMAT_COUNT];	/**< Memory used by the rendered glyphs per texture format (GX_TF_*). */
+} ftgxCacheStats;
+
 #if 0
 typedef struct ftgxCharData_ ftgxCharData;
 typedef struct ftgxDataOffset_ ftgxDataOffset;
@@ -247,6 +284,16 @@ wchar_t* charToWideChar(const char* p);
 void ClearFontData();
 void FT_DrawText( int16_t x, int16_t y, FT_UInt pixelSize, char *text, GXColor color, uint16_t textStyle );
 uint16_t FT_GetWidth( FT_UInt pixelSize, char *text );
+int FT_SaveFontCache( const char *path, const FT_UInt *sizes, int sizeCount );
+int FT_LoadFontCache( const char *path );
+int FT_InitFontCache( const char *path, const FT_UInt *sizes, int sizeCount );
+void FT_PrewarmText( const char *text );
+void FT_StartPrewarm( const FT_UInt *sizes, int sizeCount );
+void FT_StopPrewarm();
+void FT_SetGlyphMissBudget( int budget );
+void FT_SetGlyphBudget( uint32_t bytes );
+uint32_t FT_TrimFontCache( uint32_t bytes );
+void FT_GetFontCacheStats( ftgxCacheStats *stats );
 extern GXColor ftgxWhite; 
 
 #ifdef __cplusplus
@@ -255,6 +302,16 @@ extern GXColor ftgxWhite;
 
 #ifdef __cplusplus
 
+/*! \struct ftgxGlyphUsage_
+ *
+ * Entry used to select the least recently used glyphs for eviction.
+ */
+typedef struct ftgxGlyphUsage_ {
+	uint32_t lastUsed;		/**< Retrace count at which the glyph was last used. */
+	FT_UInt pixelSize;		/**< Pixel size of the glyph. */
+	wchar_t charCode;		/**< Character code of the glyph. */
+} ftgxGlyphUsage;
+
 /*! \class FreeTypeGX
  * \brief Wrapper class for the libFreeType library with GX rendering.
  * \author Armin Tamzarian
@@ -269,6 +326,12 @@ class FreeTypeGX {
 	private:
 		FT_UInt ftPointSize;	/**< Requested size of the rendered font. */
 		bool ftKerningEnabled;	/**< Flag indicating the availability of font kerning data. */
+		bool ftMetricsLoaded;	/**< Flag indicating that the ascender and descender have been read. */
+		int16_t ftAscender;		/**< Font ascender in pixels at the requested size. */
+		int16_t ftDescender;	/**< Font descender in pixels at the requested size. */
+
+		const ftgxKerningPair *kerningPairs;	/**< Sorted prebaked kerning pairs, NULL if kerning is read from the face. */
+		uint32_t kerningPairCount;	/**< Number of entries in kerningPairs. */
 
 		uint8_t textureFormat;	/**< Defined texture format of the target EFB. */
 		uint8_t vertexIndex;	/**< Vertex format descriptor index. */
@@ -283,8 +346,10 @@ class FreeTypeGX {
 
 		void unloadFont();
 		ftgxCharData *cacheGlyphData(wchar_t charCode);
+		ftgxCharData *lookupGlyphData(wchar_t charCode);
 		uint16_t cacheGlyphDataComplete();
 		void loadGlyphData(FT_Bitmap *bmp, ftgxCharData *charData);
+		void loadMetrics();
 
 		void setDefaultMode();
 
@@ -299,6 +364,18 @@ class FreeTypeGX {
 		void setVertexFormat(uint8_t vertexIndex);
 		void setCompatibilityMode(uint32_t compatibilityMode);
 
+		static uint32_t getTextureSize(uint16_t textureWidth, uint16_t textureHeight, uint8_t textureFormat);
+		uint8_t getTextureFormat();
+		ftgxCharData *getGlyphData(wchar_t charCode);
+		void setGlyphData(wchar_t charCode, const ftgxCharData *charData);
+		bool isKerningEnabled();
+		int16_t getKerning(uint16_t leftIndex, uint16_t rightIndex);
+		void getMetrics(int16_t *ascender, int16_t *descender);
+		void getGlyphUsage(std::vector<ftgxGlyphUsage> &usage);
+		uint32_t evictGlyph(wchar_t charCode);
+		void getCacheUsage(uint32_t *renderedBytes, uint32_t *prebakedBytes, uint32_t *glyphCount);
+		void setMetrics(int16_t ascender, int16_t descender, bool kerningEnabled, const ftgxKerningPair *pairs, uint32_t pairCount);
+
 		uint16_t drawText(int16_t x, int16_t y, wchar_t *text, GXColor color = ftgxWhite, uint16_t textStyling = FTGX_NULL);
 		uint16_t drawText(int16_t x, int16_t y, wchar_t const *text, GXColor color = ftgxWhite, uint16_t textStyling = FTGX_NULL);
 
@@ -65,6 +65,9 @@
  * \li convertBufferToRGB565
  * \li convertBufferToRGB5A3
  * 
+ * 8-bit intensity images (such as rendered font glyphs) can be converted in a single pass, without a temporary RGBA buffer,
+ * into a caller provided texture buffer using convertIntensityToTexture or one of the convertIntensityTo* routines.
+ * 
  * \section sec_license License
  * 
  * Metaphrasis is distributed under the GNU Lesser General Public License.
@@ -108,6 +111,15 @@ class Metaphrasis {
 		static uint32_t* convertBufferToRGB565(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
 		static uint32_t* convertBufferToRGB5A3(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
 		
+		static void convertIntensityToTexture(uint8_t textureFormat, const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static void convertIntensityToI4(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static void convertIntensityToI8(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static void convertIntensityToIA4(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static void convertIntensityToIA8(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static void convertIntensityToRGBA8(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static void convertIntensityToRGB565(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static void convertIntensityToRGB5A3(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+
 		static uint8_t convertRGBAToIA4(uint32_t rgba);
 		static uint16_t convertRGBAToIA8(uint32_t rgba);
 		static uint16_t convertRGBAToRGB565(uint32_t rgba);
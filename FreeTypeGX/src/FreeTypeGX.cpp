@@ -27,81 +27,604 @@
 #include "net_print.h"  
 #endif
 
-static FT_Library ftLibrary;	/**< FreeType FT_Library instance. */
+#include <stdio.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+static FT_Library ftLibrary = NULL;	/**< FreeType FT_Library instance. */
 static FT_Face ftFace;			/**< FreeType reusable FT_Face typographic object. */
 static FT_GlyphSlot ftSlot;		/**< FreeType reusable FT_GlyphSlot glyph container object. */
 
-static FT_UInt currFontSize = 0;
+static uint8_t *ftFontBuffer = NULL;	/**< Font buffer supplied to InitFreeType, parsed on first use. */
+static FT_Long ftFontBufferSize = 0;	/**< Size of the font buffer in bytes. */
+static bool ftFaceLoaded = false;		/**< Whether ftFace has been created from the font buffer. */
+static FT_UInt ftFaceSize = 0;			/**< Pixel size currently selected on ftFace. */
+
+static uint8_t *ftCacheData = NULL;		/**< Loaded font cache, owns the textures of the prebaked glyphs. */
+static uint32_t ftCacheDataSize = 0;	/**< Size of the loaded font cache in bytes. */
+
+static const FT_UInt ftCacheDefaultSizes[] = { 12, 14, 18 };
+
+static mutex_t ftMutex = LWP_MUTEX_NULL;	/**< Guards the font data shared with the pre-warm worker. */
+static lwp_t ftPrewarmThread = LWP_THREAD_NULL;	/**< Glyph pre-warm worker. */
+static u8 ftPrewarmStack[FTGX_PREWARM_STACK_SIZE] ATTRIBUTE_ALIGN(32);
+static volatile bool ftPrewarmQuit = false;	/**< Signals the pre-warm worker to exit. */
+static std::set<wchar_t> ftPrewarmPending;	/**< Code points collected by FT_PrewarmText. */
+static std::vector<wchar_t> ftPrewarmChars;	/**< Code points being rasterized by the worker. */
+static std::vector<FT_UInt> ftPrewarmSizes;	/**< Pixel sizes being rasterized by the worker. */
+
+static int ftMissBudget = -1;		/**< Glyphs that may be rasterized while drawing per frame, -1 for no limit. */
+static int ftMissCount = 0;			/**< Glyphs rasterized while drawing in the current frame. */
+static u32 ftMissRetrace = 0;		/**< Retrace count of the current frame. */
+
+#define FTGX_EVICT_AGE 2	/**< Retraces after which a glyph's texture is no longer referenced by the GPU. */
+
+static uint32_t ftGlyphBudget = FTGX_DEFAULT_GLYPH_BUDGET;	/**< Memory budget of the rendered glyphs, 0 if unlimited. */
+static uint32_t ftGlyphBytes = 0;		/**< Memory used by the rendered glyphs. */
+static uint32_t ftEvictedCount = 0;		/**< Number of glyphs evicted. */
+
+static wchar_t ftTextBuffer[FTGX_TEXT_BUFFER_SIZE];	/**< Initial scratch buffer of the decoded text. */
+static wchar_t *ftText = ftTextBuffer;	/**< Scratch buffer of the decoded text. */
+static size_t ftTextSize = FTGX_TEXT_BUFFER_SIZE;	/**< Size of the scratch buffer in characters. */
 
 GXColor ftgxWhite = (GXColor){0xff, 0xff, 0xff, 0xff};
 
 FreeTypeGX *fontSystem[MAX_FONT_SIZE+1];
 
-void InitFreeType(uint8_t* fontBuffer, FT_Long bufferSize)
+/*! \struct ftgxCacheHeader_
+ *
+ * Font cache file header.
+ */
+typedef struct ftgxCacheHeader_ {
+	uint32_t magic;			/**< FTGX_CACHE_MAGIC. */
+	uint32_t version;		/**< FTGX_CACHE_VERSION. */
+	uint32_t fontSize;		/**< Size of the font buffer the cache was baked from. */
+	uint32_t fontHash;		/**< Hash of the font buffer the cache was baked from. */
+	uint32_t textureFormat;	/**< Format (GX_TF_*) of the glyph textures. */
+	uint32_t sizeCount;		/**< Number of ftgxCacheSize records following the header. */
+	uint32_t fileSize;		/**< Total size of the cache in bytes. */
+} ftgxCacheHeader;
+
+/*! \struct ftgxCacheSize_
+ *
+ * Font cache record describing the glyphs baked for a single pixel size.
+ */
+typedef struct ftgxCacheSize_ {
+	uint32_t pixelSize;		/**< Pixel size of the glyphs. */
+	int16_t ascender;		/**< Font ascender in pixels. */
+	int16_t descender;		/**< Font descender in pixels. */
+	uint32_t kerningEnabled;	/**< Whether the face provides kerning data. */
+	uint32_t glyphCount;	/**< Number of ftgxCacheGlyph records. */
+	uint32_t glyphOffset;	/**< File offset of the ftgxCacheGlyph records. */
+	uint32_t kerningCount;	/**< Number of ftgxKerningPair records. */
+	uint32_t kerningOffset;	/**< File offset of the ftgxKerningPair records, sorted by glyph indices. */
+} ftgxCacheSize;
+
+/*! \struct ftgxCacheGlyph_
+ *
+ * Font cache record describing a single prebaked glyph.
+ */
+typedef struct ftgxCacheGlyph_ {
+	uint32_t charCode;		/**< Character code of the glyph. */
+	int16_t renderOffsetX;	/**< See ftgxCharData. */
+	uint16_t glyphAdvanceX;
+	uint16_t glyphIndex;
+	uint16_t textureWidth;
+	uint16_t textureHeight;
+	int16_t renderOffsetY;
+	int16_t renderOffsetMax;
+	int16_t renderOffsetMin;
+	uint32_t textureOffset;	/**< File offset of the (32 byte aligned) glyph texture. */
+} ftgxCacheGlyph;
+
+/**
+ * Computes the hash used to match a font cache against the font buffer.
+ *
+ * @param buffer	Font buffer.
+ * @param size	Size of the font buffer in bytes.
+ * @return The FNV-1a hash of the buffer.
+ */
+static uint32_t hashFontBuffer(const uint8_t *buffer, FT_Long size)
+{
+	uint32_t hash = 2166136261u;
+	for(FT_Long i = 0; i < size; i++)
+		hash = (hash ^ buffer[i]) * 16777619u;
+	return hash;
+}
+
+/**
+ * Whether the specified glyph texture lives in the loaded font cache (and therefore must not be freed).
+ *
+ * @param texture	Glyph texture.
+ */
+static bool isCacheTexture(const uint32_t *texture)
+{
+	const uint8_t *p = (const uint8_t *)texture;
+	return ftCacheData && p >= ftCacheData && p < ftCacheData + ftCacheDataSize;
+}
+
+/**
+ * Creates the FreeType face from the font buffer on first use.
+ *
+ * The face is not created by InitFreeType so that a fully prebaked font cache avoids parsing the font at all.
+ */
+static void loadFace()
 {
-	FT_Init_FreeType(&ftLibrary);
-	FT_New_Memory_Face(ftLibrary, (FT_Byte *)fontBuffer, bufferSize, 0, &ftFace);
+	if(ftFaceLoaded)
+		return;
+
+	if(!ftLibrary)
+		FT_Init_FreeType(&ftLibrary);
+	FT_New_Memory_Face(ftLibrary, (FT_Byte *)ftFontBuffer, ftFontBufferSize, 0, &ftFace);
 	ftSlot = ftFace->glyph;
+	ftFaceSize = 0;
+	ftFaceLoaded = true;
+}
 
-	for(int i=0; i<50; i++)
-		fontSystem[i] = NULL;
+/**
+ * Creates the mutex guarding the font data, once.
+ *
+ * Called by every entry point that locks the font data or starts the pre-warm worker, so that
+ * they may be used before InitFreeType. Entry points are called from the main thread only.
+ */
+static void initFontData()
+{
+	if(ftMutex == LWP_MUTEX_NULL)
+		LWP_MutexInit(&ftMutex, false);
+}
+
+/**
+ * Locks the font data against the pre-warm worker.
+ */
+static void lockFontData()
+{
+	initFontData();
+	LWP_MutexLock(ftMutex);
+}
+
+/**
+ * Unlocks the font data.
+ */
+static void unlockFontData()
+{
+	LWP_MutexUnlock(ftMutex);
+}
+
+void InitFreeType(uint8_t* fontBuffer, FT_Long bufferSize)
+{
+	// Frees the glyphs of the previous font (and stops the worker, which
+	// may be rasterizing with the face)
+	ClearFontData();
+
+	lockFontData();
+	if(ftFaceLoaded)
+	{
+		FT_Done_Face(ftFace);
+		ftFaceLoaded = false;
+	}
+	ftFontBuffer = fontBuffer;
+	ftFontBufferSize = bufferSize;
+	ftGlyphBytes = 0;
+	unlockFontData();
 }
 
 void ChangeFontSize(FT_UInt pixelSize)
 {
-	FT_Set_Pixel_Sizes(ftFace, 0, pixelSize);
+	loadFace();
+	if(ftFaceSize != pixelSize)
+	{
+		FT_Set_Pixel_Sizes(ftFace, 0, pixelSize);
+		ftFaceSize = pixelSize;
+	}
 }
 
 void ClearFontData()
 {
-	for(int i=0; i<50; i++)
+	FT_StopPrewarm();
+
+	for(int i=0; i<=MAX_FONT_SIZE; i++)
 	{
 		if(fontSystem[i])
 			delete fontSystem[i];
 		fontSystem[i] = NULL;
 	}
+
+	// The text buffer of decodeWideText, if it was grown
+	if(ftText != ftTextBuffer)
+	{
+		delete [] ftText;
+		ftText = ftTextBuffer;
+		ftTextSize = FTGX_TEXT_BUFFER_SIZE;
+	}
+
+	if(ftCacheData)
+	{
+		free(ftCacheData);
+		ftCacheData = NULL;
+		ftCacheDataSize = 0;
+	}
+}
+
+/**
+ * Whether a glyph missing from the cache may be rasterized while drawing.
+ *
+ * Counts against the per-frame budget set by FT_SetGlyphMissBudget. Glyphs over the
+ * budget are skipped and picked up on a later frame (or by the pre-warm worker).
+ *
+ * @return Whether the glyph may be rasterized.
+ */
+static bool consumeGlyphMiss()
+{
+	if(ftMissBudget < 0)
+		return true;
+
+	u32 retrace = VIDEO_GetRetraceCount();
+	if(retrace != ftMissRetrace)
+	{
+		ftMissRetrace = retrace;
+		ftMissCount = 0;
+	}
+
+	if(ftMissCount >= ftMissBudget)
+		return false;
+	ftMissCount++;
+	return true;
+}
+
+/**
+ * Orders glyphs from least to most recently used.
+ */
+static bool compareGlyphUsage(const ftgxGlyphUsage &a, const ftgxGlyphUsage &b)
+{
+	return a.lastUsed < b.lastUsed;
+}
+
+/**
+ * Evicts the least recently used rendered glyphs (across all sizes) until their memory use is within the specified size.
+ *
+ * @param bytes	Target memory use in bytes.
+ * @param minAge	Glyphs used within this many retraces are kept, as their textures may still be referenced by the GPU.
+ * @return The number of bytes freed.
+ */
+static uint32_t evictGlyphs(uint32_t bytes, uint32_t minAge)
+{
+	if(ftGlyphBytes <= bytes)
+		return 0;
+
+	std::vector<ftgxGlyphUsage> usage;
+	for(int i=0; i<=MAX_FONT_SIZE; i++)
+	{
+		if(fontSystem[i])
+			fontSystem[i]->getGlyphUsage(usage);
+	}
+	std::sort(usage.begin(), usage.end(), compareGlyphUsage);
+
+	u32 frame = VIDEO_GetRetraceCount();
+	uint32_t freed = 0;
+	for(size_t i = 0; i < usage.size() && ftGlyphBytes > bytes; i++)
+	{
+		if(frame - usage[i].lastUsed < minAge)
+			break;
+		freed += fontSystem[usage[i].pixelSize]->evictGlyph(usage[i].charCode);
+	}
+	return freed;
 }
 
 static void updatePixelSize( FT_UInt pixelSize )
 {
-  if( currFontSize != pixelSize )
+  if( !fontSystem[pixelSize] )
   {
-    ChangeFontSize( pixelSize );
-    if( !fontSystem[pixelSize] )
-    {
-      fontSystem[pixelSize] = new FreeTypeGX( pixelSize );    
-    }
-    currFontSize = pixelSize;
+    fontSystem[pixelSize] = new FreeTypeGX( pixelSize );
   }
-  
+
   fontSystem[pixelSize]->setVertexFormat( GX_VTXFMT1 );  
 }
 
+/**
+ * Decodes a UTF-8 string into the supplied wide character buffer.
+ *
+ * Code points are decoded inline, so no locale state or temporary buffers are
+ * required. Bytes which do not form a valid UTF-8 sequence are passed through
+ * as-is (Latin-1), which matches the previous mbstowcs() fallback behavior.
+ *
+ * @param strChar	UTF-8 string to decode.
+ * @param strWChar	Destination buffer, must hold at least strlen(strChar) + 1 characters.
+ * @return The number of characters written (excluding the terminator).
+ */
+static size_t utf8ToWideChar(const char* strChar, wchar_t* strWChar)
+{
+	const uint8_t *src = (const uint8_t *)strChar;
+	wchar_t *dst = strWChar;
+
+	while(*src)
+	{
+		uint32_t c = *src;
+		uint32_t extra = 0;
+
+		if(c >= 0xc2 && c <= 0xdf)
+			extra = 1;
+		else if(c >= 0xe0 && c <= 0xef)
+			extra = 2;
+		else if(c >= 0xf0 && c <= 0xf4)
+			extra = 3;
+
+		uint32_t i = 1;
+		for(; i <= extra; i++)
+		{
+			if((src[i] & 0xc0) != 0x80)
+				break;
+			c = (i == 1 ? c & (0x3f >> extra) : c) << 6 | (src[i] & 0x3f);
+		}
+
+		if(i <= extra ||
+		   (extra == 2 && c < 0x800) ||
+		   (extra == 3 && (c < 0x10000 || c > 0x10ffff)))
+		{
+			// Invalid sequence, treat the lead byte as Latin-1
+			*dst++ = (wchar_t)*src++;
+			continue;
+		}
+
+		*dst++ = (wchar_t)c;
+		src += extra + 1;
+	}
+	*dst = (wchar_t)'\0';
+
+	return dst - strWChar;
+}
+
+/**
+ * Returns a wide character version of the specified text.
+ *
+ * The text is decoded into a scratch buffer shared by the text functions. It starts out static and is
+ * only grown (and kept) for text longer than any decoded before, so the per-frame text paths do not
+ * touch the heap. Must be called with the font data locked.
+ *
+ * @param text	UTF-8 string to decode.
+ * @return The decoded text, valid until the next call.
+ */
+static wchar_t* decodeWideText(const char* text)
+{
+  size_t len = strlen( text ) + 1;
+  if( len > ftTextSize )
+  {
+    size_t size = ftTextSize;
+    while( size < len )
+      size *= 2;
+    if( ftText != ftTextBuffer )
+      delete [] ftText;
+    ftText = new wchar_t[size];
+    ftTextSize = size;
+  }
+  utf8ToWideChar( text, ftText );
+  return ftText;
+}
+
 void FT_DrawText( int16_t x, int16_t y, FT_UInt pixelSize, char *text, GXColor color, uint16_t textStyle )
 {
+  lockFontData();
   updatePixelSize( pixelSize );    
 
-  wchar_t* wtext = charToWideChar( text );
+  wchar_t* wtext = decodeWideText( text );
   fontSystem[pixelSize]->drawText( x, y, wtext, color, textStyle );
-  delete [] wtext;
+  unlockFontData();
 }
 
 uint16_t FT_GetWidth( FT_UInt pixelSize, char *text )
 {
+  lockFontData();
   updatePixelSize( pixelSize );    
 
-  wchar_t* wtext = charToWideChar( text );
+  wchar_t* wtext = decodeWideText( text );
   uint16_t width = fontSystem[pixelSize]->getWidth( wtext );
-  delete [] wtext;
+  unlockFontData();
 
   return width;
 }
 
-#if 0
 /**
- * Convert a short char sctring to a wide char string.
+ * Adds the characters of the specified text to the set of glyphs rasterized by the next FT_StartPrewarm.
+ *
+ * @param text	UTF-8 text, typically the translated messages and fixed UI strings.
+ */
+void FT_PrewarmText( const char *text )
+{
+  lockFontData();
+  wchar_t* wtext = decodeWideText( text );
+  for( wchar_t* c = wtext; *c; c++ )
+  {
+    if( *c >= 0x20 )
+      ftPrewarmPending.insert( *c );
+  }
+  unlockFontData();
+}
+
+/**
+ * Rasterizes the pending pre-warm glyphs for the specified sizes.
+ *
+ * @param arg	Unused.
+ */
+static void* prewarmThread( void *arg )
+{
+  for( size_t s = 0; s < ftPrewarmSizes.size() && !ftPrewarmQuit; s++ )
+  {
+    FreeTypeGX *font = fontSystem[ftPrewarmSizes[s]];
+    for( size_t c = 0; c < ftPrewarmChars.size() && !ftPrewarmQuit; c++ )
+    {
+      // One glyph per lock so a pending draw waits for at most a single glyph
+      lockFontData();
+      bool full = ftGlyphBudget && ftGlyphBytes >= ftGlyphBudget;
+      if( !full )
+        font->getGlyphData( ftPrewarmChars[c] );
+      unlockFontData();
+
+      // Pre-warming must not evict glyphs that are in use
+      if( full )
+        return NULL;
+      LWP_YieldThread();
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Starts rasterizing the glyphs collected by FT_PrewarmText on a low priority worker thread.
+ *
+ * The glyphs are cached before they are first drawn, avoiding hitches when new (e.g. translated) text
+ * is displayed. Any worker that is already running is stopped first.
+ *
+ * @param sizes	Pixel sizes to pre-warm, NULL for the default sizes (12, 14 and 18).
+ * @param sizeCount	Number of entries in sizes.
+ */
+void FT_StartPrewarm( const FT_UInt *sizes, int sizeCount )
+{
+  FT_StopPrewarm();
+  initFontData();
+
+  if( !ftFontBuffer )
+    return;
+
+  if( !sizes )
+  {
+    sizes = ftCacheDefaultSizes;
+    sizeCount = sizeof( ftCacheDefaultSizes ) / sizeof( FT_UInt );
+  }
+
+  ftPrewarmSizes.clear();
+  for( int i = 0; i < sizeCount; i++ )
+  {
+    if( sizes[i] > 0 && sizes[i] <= MAX_FONT_SIZE )
+    {
+      // Created here as the constructor sets up GX state
+      updatePixelSize( sizes[i] );
+      ftPrewarmSizes.push_back( sizes[i] );
+    }
+  }
+
+  ftPrewarmChars.assign( ftPrewarmPending.begin(), ftPrewarmPending.end() );
+  ftPrewarmPending.clear();
+
+  if( ftPrewarmChars.empty() || ftPrewarmSizes.empty() )
+    return;
+
+  ftPrewarmQuit = false;
+  LWP_CreateThread( &ftPrewarmThread, prewarmThread, NULL, ftPrewarmStack,
+    FTGX_PREWARM_STACK_SIZE, FTGX_PREWARM_PRIORITY );
+}
+
+/**
+ * Stops the glyph pre-warm worker (if running) and waits for it to exit.
+ */
+void FT_StopPrewarm()
+{
+  if( ftPrewarmThread == LWP_THREAD_NULL )
+    return;
+
+  ftPrewarmQuit = true;
+  LWP_JoinThread( ftPrewarmThread, NULL );
+  ftPrewarmThread = LWP_THREAD_NULL;
+}
+
+/**
+ * Limits the number of uncached glyphs rasterized per frame while drawing.
+ *
+ * Glyphs over the budget are skipped for the frame. This bounds the cost of a frame that displays
+ * a lot of new text, at the expense of the text completing over several frames. Measuring text
+ * (FT_GetWidth, justification and alignment) is not limited and rasterizes the glyphs it needs.
+ *
+ * @param budget	Glyphs per frame, or -1 for no limit (default).
+ */
+void FT_SetGlyphMissBudget( int budget )
+{
+  ftMissBudget = budget;
+  ftMissCount = 0;
+}
+
+/**
+ * Sets the memory budget of the rendered glyph textures.
+ *
+ * When the budget is exceeded the least recently used glyphs of all sizes are evicted, except for those
+ * drawn in the last few frames.
+ *
+ * @param bytes	Budget in bytes, or 0 for no limit. Defaults to FTGX_DEFAULT_GLYPH_BUDGET.
+ */
+void FT_SetGlyphBudget( uint32_t bytes )
+{
+  lockFontData();
+  ftGlyphBudget = bytes;
+  if( bytes )
+    evictGlyphs( bytes, FTGX_EVICT_AGE );
+  unlockFontData();
+}
+
+/**
+ * Evicts the least recently used rendered glyphs until their memory use is within the specified size.
+ *
+ * Typically called with 0 to release all rendered glyphs before an emulator starts. Sizes left without
+ * glyphs are released as well. Unlike the budget, recently drawn glyphs are evicted too, so this must
+ * not be called while text may still be rendering. Glyphs of a loaded font cache are kept.
+ *
+ * @param bytes	Target memory use in bytes.
+ * @return The number of bytes freed.
+ */
+uint32_t FT_TrimFontCache( uint32_t bytes )
+{
+  FT_StopPrewarm();
+
+  lockFontData();
+  uint32_t freed = evictGlyphs( bytes, 0 );
+
+  for( int i = 0; i <= MAX_FONT_SIZE; i++ )
+  {
+    uint32_t rendered, prebaked, count;
+    if( !fontSystem[i] )
+      continue;
+
+    fontSystem[i]->getCacheUsage( &rendered, &prebaked, &count );
+    if( count == 0 && prebaked == 0 )
+    {
+      delete fontSystem[i];
+      fontSystem[i] = NULL;
+    }
+  }
+  unlockFontData();
+
+  return freed;
+}
+
+/**
+ * Returns the memory usage statistics of the glyph caches.
+ *
+ * @param stats	Receives the statistics.
+ */
+void FT_GetFontCacheStats( ftgxCacheStats *stats )
+{
+  memset( stats, 0, sizeof( ftgxCacheStats ) );
+
+  lockFontData();
+  stats->budgetBytes = ftGlyphBudget;
+  stats->totalBytes = ftGlyphBytes;
+  stats->prebakedBytes = ftCacheDataSize;
+  stats->evictedCount = ftEvictedCount;
+
+  for( int i = 0; i <= MAX_FONT_SIZE; i++ )
+  {
+    uint32_t rendered, prebaked, count;
+    if( !fontSystem[i] )
+      continue;
+
+    fontSystem[i]->getCacheUsage( &rendered, &prebaked, &count );
+    stats->sizeBytes[i] = rendered;
+    stats->formatBytes[fontSystem[i]->getTextureFormat() % FTGX_FORMAT_COUNT] += rendered;
+    stats->glyphCount += count;
+  }
+  unlockFontData();
+}
+
+/**
+ * Convert a UTF-8 char string to a wide char string.
  *
- * This routine converts a supplied shot character string into a wide character string.
  * Note that it is the user's responsibility to clear the returned buffer once it is no longer needed.
  *
  * @param strChar	Character string to be converted.
@@ -109,47 +632,366 @@ uint16_t FT_GetWidth( FT_UInt pixelSize, char *text )
  */
 wchar_t* charToWideChar(const char* strChar)
 {
-	wchar_t *strWChar;
-	strWChar = new wchar_t[strlen(strChar) + 1];
+	wchar_t *strWChar = new wchar_t[strlen(strChar) + 1];
+	if(!strWChar)
+		return NULL;
 
-	char *tempSrc = (char *)strChar;
-	wchar_t *tempDest = strWChar;
-	while((*tempDest++ = *tempSrc++));
+	utf8ToWideChar(strChar, strWChar);
 
 	return strWChar;
 }
+
+/**
+ * Appends zero padding to the font cache until its size is a multiple of the specified alignment.
+ *
+ * @param data	Font cache being built.
+ * @param alignment	Required alignment in bytes.
+ */
+static void alignCacheData(std::vector<uint8_t> &data, size_t alignment)
+{
+	while(data.size() % alignment)
+		data.push_back(0);
+}
+
+/**
+ * Appends a block of memory to the font cache being built.
+ *
+ * @param data	Font cache being built.
+ * @param src	Memory to append.
+ * @param size	Size of the memory in bytes.
+ * @return The offset of the block within the font cache.
+ */
+static uint32_t appendCacheData(std::vector<uint8_t> &data, const void *src, size_t size)
+{
+	uint32_t offset = data.size();
+	data.insert(data.end(), (const uint8_t *)src, (const uint8_t *)src + size);
+	return offset;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/**
+ * Byte swaps the fields of a font cache record in place.
+ *
+ * @param p	The record.
+ * @param layout	The sizes of the record's fields in bytes ('2' or '4' per field).
+ */
+static void swapCacheFields(uint8_t *p, const char *layout)
+{
+	for(; *layout; layout++)
+	{
+		if(*layout == '4')
+		{
+			uint32_t v;
+			memcpy(&v, p, 4);
+			v = __builtin_bswap32(v);
+			memcpy(p, &v, 4);
+			p += 4;
+		}
+		else
+		{
+			uint16_t v;
+			memcpy(&v, p, 2);
+			v = __builtin_bswap16(v);
+			memcpy(p, &v, 2);
+			p += 2;
+		}
+	}
+}
+
+/**
+ * Converts the records of a font cache built on a little-endian host (the font cache baker) to the big-endian
+ * layout the Wii reads in place. The glyph textures are in GX byte order already.
+ *
+ * @param data	Font cache being built.
+ */
+static void storeCacheBigEndian(std::vector<uint8_t> &data)
+{
+	ftgxCacheHeader *header = (ftgxCacheHeader *)&data[0];
+	ftgxCacheSize *sizeRecords = (ftgxCacheSize *)(header + 1);
+	for(uint32_t i = 0; i < header->sizeCount; i++)
+	{
+		ftgxCacheSize *rec = &sizeRecords[i];
+		for(uint32_t g = 0; g < rec->glyphCount; g++)
+			swapCacheFields(&data[rec->glyphOffset + g * sizeof(ftgxCacheGlyph)], "4222222224");
+		for(uint32_t k = 0; k < rec->kerningCount; k++)
+			swapCacheFields(&data[rec->kerningOffset + k * sizeof(ftgxKerningPair)], "2222");
+		swapCacheFields((uint8_t *)rec, "42244444");
+	}
+	swapCacheFields(&data[0], "4444444");
+}
 #endif
 
-wchar_t* charToWideChar(const char* strChar)
+/**
+ * Bakes the glyphs of the specified sizes and writes them to a font cache file.
+ *
+ * The printable ASCII and Latin-1 characters are rasterized and converted to the texture format used by
+ * FT_DrawText, and stored along with the glyph metrics and kerning pairs so that FT_LoadFontCache can
+ * restore them without FreeType. This is typically run once (on first launch) after InitFreeType, or ahead of
+ * time on a Linux host with the font cache baker (tools/ftgx_bake).
+ *
+ * @param path	Path of the font cache file to write.
+ * @param sizes	Pixel sizes to bake, NULL for the default sizes (12, 14 and 18).
+ * @param sizeCount	Number of entries in sizes.
+ * @return 1 if the cache was written, 0 otherwise.
+ */
+int FT_SaveFontCache( const char *path, const FT_UInt *sizes, int sizeCount )
 {
-#if 0
-#ifdef WII_NETTRACE
-  const char* str = strChar;
-  char buf[512] = "";
-  char *pbuf = buf;
-  for( int i = 0; i < strlen(str) && ((pbuf - buf) < (sizeof(buf) - 4)); i++ )
+  if( !ftFontBuffer )
+    return 0;
+
+  if( !sizes )
   {
-    sprintf( pbuf, "%x ", (u8)str[i] );
-    pbuf += 3;
+    sizes = ftCacheDefaultSizes;
+    sizeCount = sizeof( ftCacheDefaultSizes ) / sizeof( FT_UInt );
   }
-  net_print_string( NULL, 0, "charToWideChar: %s, %s\n", str, buf );
-#endif
+
+  lockFontData();
+
+  // Glyphs are held across frames while baking, so nothing may be evicted
+  uint32_t budget = ftGlyphBudget;
+  ftGlyphBudget = 0;
+
+  std::vector<uint8_t> data;
+  ftgxCacheHeader header;
+  memset( &header, 0, sizeof( header ) );
+  appendCacheData( data, &header, sizeof( header ) );
+  uint32_t sizeOffset = data.size();
+  data.resize( data.size() + sizeCount * sizeof( ftgxCacheSize ) );
+
+  uint8_t textureFormat = GX_TF_RGBA8;
+  int count = 0;
+  for( int i = 0; i < sizeCount; i++ )
+  {
+    FT_UInt pixelSize = sizes[i];
+    if( pixelSize == 0 || pixelSize > MAX_FONT_SIZE )
+      continue;
+
+    updatePixelSize( pixelSize );
+    FreeTypeGX *font = fontSystem[pixelSize];
+    textureFormat = font->getTextureFormat();
+
+    std::vector<ftgxCacheGlyph> glyphs;
+    std::vector<uint32_t*> textures;
+    for( wchar_t charCode = 0x20; charCode <= 0xff; charCode++ )
+    {
+      if( charCode == 0x7f )
+        charCode = 0xa0;
+
+      ftgxCharData *glyphData = font->getGlyphData( charCode );
+      if( !glyphData )
+        continue;
+
+      ftgxCacheGlyph glyph = {
+        (uint32_t)charCode,
+        glyphData->renderOffsetX,
+        glyphData->glyphAdvanceX,
+        glyphData->glyphIndex,
+        glyphData->textureWidth,
+        glyphData->textureHeight,
+        glyphData->renderOffsetY,
+        glyphData->renderOffsetMax,
+        glyphData->renderOffsetMin,
+        0
+      };
+      glyphs.push_back( glyph );
+      textures.push_back( glyphData->glyphDataTexture );
+    }
+
+    // Only the non-zero pairs are stored, sorted so they can be searched
+    std::map<uint32_t, int16_t> pairs;
+    if( font->isKerningEnabled() )
+    {
+      for( size_t l = 0; l < glyphs.size(); l++ )
+      {
+        for( size_t r = 0; r < glyphs.size(); r++ )
+        {
+          int16_t delta = font->getKerning( glyphs[l].glyphIndex, glyphs[r].glyphIndex );
+          if( delta )
+            pairs[(uint32_t)glyphs[l].glyphIndex << 16 | glyphs[r].glyphIndex] = delta;
+        }
+      }
+    }
+
+    for( size_t g = 0; g < glyphs.size(); g++ )
+    {
+      alignCacheData( data, 32 );
+      glyphs[g].textureOffset = appendCacheData( data, textures[g],
+        FreeTypeGX::getTextureSize( glyphs[g].textureWidth, glyphs[g].textureHeight, textureFormat ) );
+    }
+
+    ftgxCacheSize sizeRecord;
+    memset( &sizeRecord, 0, sizeof( sizeRecord ) );
+    sizeRecord.pixelSize = pixelSize;
+    font->getMetrics( &sizeRecord.ascender, &sizeRecord.descender );
+    sizeRecord.kerningEnabled = font->isKerningEnabled();
+
+    alignCacheData( data, 4 );
+    sizeRecord.glyphCount = glyphs.size();
+    sizeRecord.glyphOffset = data.size();
+    if( !glyphs.empty() )
+      appendCacheData( data, &glyphs[0], glyphs.size() * sizeof( ftgxCacheGlyph ) );
+
+    sizeRecord.kerningCount = pairs.size();
+    sizeRecord.kerningOffset = data.size();
+    for( std::map<uint32_t, int16_t>::iterator p = pairs.begin(); p != pairs.end(); p++ )
+    {
+      ftgxKerningPair pair = { (uint16_t)(p->first >> 16), (uint16_t)(p->first & 0xffff), p->second, 0 };
+      appendCacheData( data, &pair, sizeof( pair ) );
+    }
+
+    memcpy( &data[sizeOffset + count * sizeof( ftgxCacheSize )], &sizeRecord, sizeof( sizeRecord ) );
+    count++;
+  }
+
+  alignCacheData( data, 32 );
+  header.magic = FTGX_CACHE_MAGIC;
+  header.version = FTGX_CACHE_VERSION;
+  header.fontSize = ftFontBufferSize;
+  header.fontHash = hashFontBuffer( ftFontBuffer, ftFontBufferSize );
+  header.textureFormat = textureFormat;
+  header.sizeCount = count;
+  header.fileSize = data.size();
+  memcpy( &data[0], &header, sizeof( header ) );
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  storeCacheBigEndian( data );
 #endif
-	wchar_t *strWChar = new wchar_t[strlen(strChar) + 1];
-	if(!strWChar)
-		return NULL;
 
-	int bt = mbstowcs(strWChar, strChar, strlen(strChar));
-	if (bt > 0)
-	{
-		strWChar[bt] = (wchar_t)'\0';
-		return strWChar;
-	}
+  ftGlyphBudget = budget;
+  unlockFontData();
 
-	wchar_t *tempDest = strWChar;
-	while((*tempDest++ = (unsigned char)*strChar++));
+  FILE *fp = fopen( path, "wb" );
+  if( !fp )
+    return 0;
+  size_t written = fwrite( &data[0], 1, data.size(), fp );
+  fclose( fp );
 
-	return strWChar;
+  return written == data.size();
+}
+
+/**
+ * Loads a font cache written by FT_SaveFontCache.
+ *
+ * The file is read with a single read into one aligned buffer and flushed once, the glyph textures are used
+ * in place. The cache is rejected if it was baked from a different font buffer than the one passed to
+ * InitFreeType. Any previously loaded font data is cleared.
+ *
+ * @param path	Path of the font cache file to read.
+ * @return 1 if the cache was loaded, 0 otherwise.
+ */
+int FT_LoadFontCache( const char *path )
+{
+  if( !ftFontBuffer )
+    return 0;
+
+  FILE *fp = fopen( path, "rb" );
+  if( !fp )
+    return 0;
+
+  fseek( fp, 0, SEEK_END );
+  long size = ftell( fp );
+  fseek( fp, 0, SEEK_SET );
+
+  uint8_t *data = NULL;
+  if( size >= (long)sizeof( ftgxCacheHeader ) )
+  {
+    data = (uint8_t *)memalign( 32, size );
+    if( data && fread( data, 1, size, fp ) != (size_t)size )
+    {
+      free( data );
+      data = NULL;
+    }
+  }
+  fclose( fp );
+  if( !data )
+    return 0;
+
+  uint32_t fileSize = size;
+  ftgxCacheHeader *header = (ftgxCacheHeader *)data;
+  bool valid =
+    header->magic == FTGX_CACHE_MAGIC &&
+    header->version == FTGX_CACHE_VERSION &&
+    header->fileSize == fileSize &&
+    header->fontSize == (uint32_t)ftFontBufferSize &&
+    header->sizeCount <= ( fileSize - sizeof( ftgxCacheHeader ) ) / sizeof( ftgxCacheSize ) &&
+    header->fontHash == hashFontBuffer( ftFontBuffer, ftFontBufferSize );
+
+  ftgxCacheSize *sizeRecords = (ftgxCacheSize *)( data + sizeof( ftgxCacheHeader ) );
+  for( uint32_t i = 0; valid && i < header->sizeCount; i++ )
+  {
+    ftgxCacheSize *rec = &sizeRecords[i];
+    valid = rec->pixelSize > 0 && rec->pixelSize <= MAX_FONT_SIZE &&
+      rec->glyphOffset <= fileSize && rec->glyphCount <= ( fileSize - rec->glyphOffset ) / sizeof( ftgxCacheGlyph ) &&
+      rec->kerningOffset <= fileSize && rec->kerningCount <= ( fileSize - rec->kerningOffset ) / sizeof( ftgxKerningPair );
+
+    ftgxCacheGlyph *glyphs = (ftgxCacheGlyph *)( data + rec->glyphOffset );
+    for( uint32_t g = 0; valid && g < rec->glyphCount; g++ )
+    {
+      uint32_t textureSize = FreeTypeGX::getTextureSize( glyphs[g].textureWidth, glyphs[g].textureHeight, header->textureFormat );
+      valid = ( glyphs[g].textureOffset & 31 ) == 0 &&
+        glyphs[g].textureOffset <= fileSize && textureSize <= fileSize - glyphs[g].textureOffset;
+    }
+  }
+
+  if( !valid )
+  {
+    free( data );
+    return 0;
+  }
+
+  DCFlushRange( data, fileSize );
+
+  ClearFontData();
+  ftCacheData = data;
+  ftCacheDataSize = fileSize;
+
+  for( uint32_t i = 0; i < header->sizeCount; i++ )
+  {
+    ftgxCacheSize *rec = &sizeRecords[i];
+    FreeTypeGX *font = new FreeTypeGX( rec->pixelSize, header->textureFormat );
+    font->setMetrics( rec->ascender, rec->descender, rec->kerningEnabled,
+      (const ftgxKerningPair *)( data + rec->kerningOffset ), rec->kerningCount );
+
+    ftgxCacheGlyph *glyphs = (ftgxCacheGlyph *)( data + rec->glyphOffset );
+    for( uint32_t g = 0; g < rec->glyphCount; g++ )
+    {
+      ftgxCharData charData = {
+        glyphs[g].renderOffsetX,
+        glyphs[g].glyphAdvanceX,
+        glyphs[g].glyphIndex,
+        glyphs[g].textureWidth,
+        glyphs[g].textureHeight,
+        glyphs[g].renderOffsetY,
+        glyphs[g].renderOffsetMax,
+        glyphs[g].renderOffsetMin,
+        (uint32_t *)( data + glyphs[g].textureOffset ),
+        0
+      };
+      font->setGlyphData( glyphs[g].charCode, &charData );
+    }
+
+    delete fontSystem[rec->pixelSize];
+    fontSystem[rec->pixelSize] = font;
+  }
+
+  return 1;
+}
+
+/**
+ * Loads the font cache, baking and writing it first if it is missing or stale.
+ *
+ * @param path	Path of the font cache file.
+ * @param sizes	Pixel sizes to bake, NULL for the default sizes (12, 14 and 18).
+ * @param sizeCount	Number of entries in sizes.
+ * @return 1 if an existing cache was loaded, 0 if it had to be (re)built.
+ */
+int FT_InitFontCache( const char *path, const FT_UInt *sizes, int sizeCount )
+{
+  if( FT_LoadFontCache( path ) )
+    return 1;
+
+  FT_SaveFontCache( path, sizes, sizeCount );
+  return 0;
 }
 
 /**
@@ -164,7 +1006,12 @@ FreeTypeGX::FreeTypeGX(FT_UInt pixelSize, uint8_t textureFormat, uint8_t vertexI
 	this->setVertexFormat(vertexIndex);
 	this->setCompatibilityMode(FTGX_COMPATIBILITY_DEFAULT_TEVOP_GX_PASSCLR | FTGX_COMPATIBILITY_DEFAULT_VTXDESC_GX_NONE);
 	this->ftPointSize = pixelSize;
-	this->ftKerningEnabled = FT_HAS_KERNING(ftFace);
+	this->ftKerningEnabled = false;
+	this->ftMetricsLoaded = false;
+	this->ftAscender = 0;
+	this->ftDescender = 0;
+	this->kerningPairs = NULL;
+	this->kerningPairCount = 0;
 }
 
 /**
@@ -268,7 +1115,13 @@ void FreeTypeGX::unloadFont()
 	if(this->fontData.size() == 0)
 		return;
 	for(std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.begin(); i != this->fontData.end(); i++)
-		free(i->second.glyphDataTexture);
+	{
+		if(!isCacheTexture(i->second.glyphDataTexture))
+		{
+			ftGlyphBytes -= getTextureSize(i->second.textureWidth, i->second.textureHeight, this->textureFormat);
+			free(i->second.glyphDataTexture);
+		}
+	}
 	this->fontData.clear();
 }
 
@@ -350,6 +1203,13 @@ ftgxCharData *FreeTypeGX::cacheGlyphData(wchar_t charCode)
 	FT_UInt gIndex;
 	uint16_t textureWidth = 0, textureHeight = 0;
 
+	// The face is live from here on, so use its kerning for glyphs outside of the prebaked set
+	ChangeFontSize(this->ftPointSize);
+	this->kerningPairs = NULL;
+
+	if(ftGlyphBudget && ftGlyphBytes >= ftGlyphBudget)
+		evictGlyphs(ftGlyphBudget - (ftGlyphBudget >> 2), FTGX_EVICT_AGE);
+
 	gIndex = FT_Get_Char_Index( ftFace, charCode );
 	if (!FT_Load_Glyph(ftFace, gIndex, FT_LOAD_DEFAULT )) {
 		FT_Render_Glyph( ftSlot, FT_RENDER_MODE_NORMAL );
@@ -369,9 +1229,11 @@ ftgxCharData *FreeTypeGX::cacheGlyphData(wchar_t charCode)
 				ftSlot->bitmap_top,
 				ftSlot->bitmap_top,
 				glyphBitmap->rows - ftSlot->bitmap_top,
-				NULL
+				NULL,
+				VIDEO_GetRetraceCount()
 			};
 			this->loadGlyphData(glyphBitmap, &this->fontData[charCode]);
+			ftGlyphBytes += getTextureSize(textureWidth, textureHeight, this->textureFormat);
 
 			return &this->fontData[charCode];
 		}
@@ -389,6 +1251,7 @@ uint16_t FreeTypeGX::cacheGlyphDataComplete()
 {
 	uint16_t i = 0;
 	FT_UInt gIndex;
+	ChangeFontSize(this->ftPointSize);
 	FT_ULong charCode = FT_Get_First_Char( ftFace, &gIndex );
 	while ( gIndex != 0 )
 	{
@@ -400,54 +1263,263 @@ uint16_t FreeTypeGX::cacheGlyphDataComplete()
 }
 
 /**
- * Loads the rendered bitmap into the relevant structure's data buffer.
- *
- * This routine does a simple byte-wise copy of the glyph's rendered 8-bit grayscale bitmap into the structure's buffer.
- * Each byte is converted from the bitmap's intensity value into the a uint32_t RGBA value.
+ * Reads the size specific font metrics from the face.
  *
- * @param bmp	A pointer to the most recently rendered glyph's bitmap.
- * @param charData	A pointer to an allocated ftgxCharData structure whose data represent that of the last rendered glyph.
+ * This is deferred until the metrics are first needed, and skipped entirely when they were restored from a font cache.
  */
-void FreeTypeGX::loadGlyphData(FT_Bitmap *bmp, ftgxCharData *charData)
+void FreeTypeGX::loadMetrics()
 {
-	uint32_t *glyphData = (uint32_t *)memalign(32, charData->textureWidth * charData->textureHeight * 4);
-	memset(glyphData, 0x00, charData->textureWidth * charData->textureHeight * 4);
+	if(this->ftMetricsLoaded)
+		return;
 
-	for (uint16_t imagePosY = 0; imagePosY < bmp->rows; imagePosY++)
-	{
-		for (uint16_t imagePosX = 0; imagePosX < bmp->width; imagePosX++)
-		{
-			uint32_t pixel = (uint32_t) bmp->buffer[imagePosY * bmp->width + imagePosX];
-			glyphData[imagePosY * charData->textureWidth + imagePosX] = 0x00000000 | (pixel << 24) | (pixel << 16) | (pixel << 8) | pixel;
-		}
-	}
+	ChangeFontSize(this->ftPointSize);
+	this->ftKerningEnabled = FT_HAS_KERNING(ftFace);
+	this->ftAscender = ftFace->size->metrics.ascender >> 6;
+	this->ftDescender = ftFace->size->metrics.descender >> 6;
+	this->ftMetricsLoaded = true;
+}
 
-	switch(this->textureFormat)
+/**
+ * Returns the size in bytes of a texture of the given dimensions and format.
+ *
+ * @param textureWidth	The (adjusted) texture width.
+ * @param textureHeight	The (adjusted) texture height.
+ * @param textureFormat	The texture format (GX_TF_*).
+ * @return The size of the texture data in bytes.
+ */
+uint32_t FreeTypeGX::getTextureSize(uint16_t textureWidth, uint16_t textureHeight, uint8_t textureFormat)
+{
+	switch(textureFormat)
 	{
 		case GX_TF_I4:
-			charData->glyphDataTexture = Metaphrasis::convertBufferToI4(glyphData, charData->textureWidth, charData->textureHeight);
-			break;
+			return textureWidth * textureHeight >> 1;
 		case GX_TF_I8:
-			charData->glyphDataTexture = Metaphrasis::convertBufferToI8(glyphData, charData->textureWidth, charData->textureHeight);
-			break;
 		case GX_TF_IA4:
-			charData->glyphDataTexture = Metaphrasis::convertBufferToIA4(glyphData, charData->textureWidth, charData->textureHeight);
-			break;
+			return textureWidth * textureHeight;
 		case GX_TF_IA8:
-			charData->glyphDataTexture = Metaphrasis::convertBufferToIA8(glyphData, charData->textureWidth, charData->textureHeight);
-			break;
 		case GX_TF_RGB565:
-			charData->glyphDataTexture = Metaphrasis::convertBufferToRGB565(glyphData, charData->textureWidth, charData->textureHeight);
-			break;
 		case GX_TF_RGB5A3:
-			charData->glyphDataTexture = Metaphrasis::convertBufferToRGB5A3(glyphData, charData->textureWidth, charData->textureHeight);
-			break;
+			return textureWidth * textureHeight << 1;
 		case GX_TF_RGBA8:
 		default:
-			charData->glyphDataTexture = Metaphrasis::convertBufferToRGBA8(glyphData, charData->textureWidth, charData->textureHeight);
-			break;
+			return textureWidth * textureHeight << 2;
 	}
-	free(glyphData);
+}
+
+/**
+ * Returns the texture format of the glyphs.
+ */
+uint8_t FreeTypeGX::getTextureFormat()
+{
+	return this->textureFormat;
+}
+
+/**
+ * Returns the data for the given glyph, caching it first if necessary.
+ *
+ * @param charCode	The requested glyph's character code.
+ * @return A pointer to the glyph data or NULL if the glyph could not be rendered.
+ */
+ftgxCharData *FreeTypeGX::getGlyphData(wchar_t charCode)
+{
+	std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.find(charCode);
+	if(i != this->fontData.end())
+	{
+		i->second.lastUsed = VIDEO_GetRetraceCount();
+		return &i->second;
+	}
+	return this->cacheGlyphData(charCode);
+}
+
+/**
+ * Returns the data for the given glyph while drawing text.
+ *
+ * Unlike getGlyphData, uncached glyphs are only rasterized within the per-frame budget set by FT_SetGlyphMissBudget.
+ * Measuring text always uses getGlyphData, so widths and offsets are exact even when glyphs are skipped.
+ *
+ * @param charCode	The requested glyph's character code.
+ * @return A pointer to the glyph data or NULL if the glyph is unavailable.
+ */
+ftgxCharData *FreeTypeGX::lookupGlyphData(wchar_t charCode)
+{
+	std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.find(charCode);
+	if(i != this->fontData.end())
+	{
+		i->second.lastUsed = VIDEO_GetRetraceCount();
+		return &i->second;
+	}
+	return consumeGlyphMiss() ? this->cacheGlyphData(charCode) : NULL;
+}
+
+/**
+ * Stores prebaked data for the given glyph.
+ *
+ * The glyph texture remains owned by the caller.
+ *
+ * @param charCode	The glyph's character code.
+ * @param charData	The glyph data.
+ */
+void FreeTypeGX::setGlyphData(wchar_t charCode, const ftgxCharData *charData)
+{
+	this->fontData[charCode] = *charData;
+}
+
+/**
+ * Whether kerning should be applied between glyphs.
+ */
+bool FreeTypeGX::isKerningEnabled()
+{
+	this->loadMetrics();
+	return this->ftKerningEnabled;
+}
+
+/**
+ * Returns the kerning adjustment between two glyphs.
+ *
+ * Prebaked pairs are searched when available, otherwise the kerning is read from the face.
+ *
+ * @param leftIndex	Glyph index of the left character.
+ * @param rightIndex	Glyph index of the right character.
+ * @return The X adjustment in pixels.
+ */
+int16_t FreeTypeGX::getKerning(uint16_t leftIndex, uint16_t rightIndex)
+{
+	if(this->kerningPairs)
+	{
+		uint32_t key = (uint32_t)leftIndex << 16 | rightIndex;
+		int32_t low = 0, high = (int32_t)this->kerningPairCount - 1;
+		while(low <= high)
+		{
+			int32_t mid = (low + high) >> 1;
+			const ftgxKerningPair *pair = &this->kerningPairs[mid];
+			uint32_t pairKey = (uint32_t)pair->leftIndex << 16 | pair->rightIndex;
+			if(pairKey == key)
+				return pair->deltaX;
+			if(pairKey < key)
+				low = mid + 1;
+			else
+				high = mid - 1;
+		}
+		return 0;
+	}
+
+	FT_Vector pairDelta;
+	ChangeFontSize(this->ftPointSize);
+	FT_Get_Kerning( ftFace, leftIndex, rightIndex, FT_KERNING_DEFAULT, &pairDelta );
+	return pairDelta.x >> 6;
+}
+
+/**
+ * Returns the font ascender and descender in pixels.
+ *
+ * @param ascender	Receives the ascender.
+ * @param descender	Receives the descender.
+ */
+void FreeTypeGX::getMetrics(int16_t *ascender, int16_t *descender)
+{
+	this->loadMetrics();
+	*ascender = this->ftAscender;
+	*descender = this->ftDescender;
+}
+
+/**
+ * Appends the rendered (evictable) glyphs of this size to the specified usage list.
+ *
+ * @param usage	Receives the glyphs.
+ */
+void FreeTypeGX::getGlyphUsage(std::vector<ftgxGlyphUsage> &usage)
+{
+	for(std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.begin(); i != this->fontData.end(); i++)
+	{
+		if(isCacheTexture(i->second.glyphDataTexture))
+			continue;
+		ftgxGlyphUsage entry = { i->second.lastUsed, this->ftPointSize, i->first };
+		usage.push_back(entry);
+	}
+}
+
+/**
+ * Releases the given rendered glyph.
+ *
+ * @param charCode	The glyph's character code.
+ * @return The number of bytes freed.
+ */
+uint32_t FreeTypeGX::evictGlyph(wchar_t charCode)
+{
+	std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.find(charCode);
+	if(i == this->fontData.end() || isCacheTexture(i->second.glyphDataTexture))
+		return 0;
+
+	uint32_t bytes = getTextureSize(i->second.textureWidth, i->second.textureHeight, this->textureFormat);
+	free(i->second.glyphDataTexture);
+	this->fontData.erase(i);
+
+	ftGlyphBytes -= bytes;
+	ftEvictedCount++;
+	return bytes;
+}
+
+/**
+ * Returns the memory used by the glyphs of this size.
+ *
+ * @param renderedBytes	Receives the memory used by the rendered glyphs.
+ * @param prebakedBytes	Receives the memory used by the glyphs of the loaded font cache.
+ * @param glyphCount	Receives the number of rendered glyphs.
+ */
+void FreeTypeGX::getCacheUsage(uint32_t *renderedBytes, uint32_t *prebakedBytes, uint32_t *glyphCount)
+{
+	*renderedBytes = *prebakedBytes = *glyphCount = 0;
+	for(std::map<wchar_t, ftgxCharData>::iterator i = this->fontData.begin(); i != this->fontData.end(); i++)
+	{
+		uint32_t bytes = getTextureSize(i->second.textureWidth, i->second.textureHeight, this->textureFormat);
+		if(isCacheTexture(i->second.glyphDataTexture))
+		{
+			*prebakedBytes += bytes;
+		}
+		else
+		{
+			*renderedBytes += bytes;
+			(*glyphCount)++;
+		}
+	}
+}
+
+/**
+ * Stores prebaked font metrics, so that the face does not need to be loaded to render the prebaked glyphs.
+ *
+ * @param ascender	Font ascender in pixels.
+ * @param descender	Font descender in pixels.
+ * @param kerningEnabled	Whether the face provides kerning data.
+ * @param pairs	Non-zero kerning pairs between the prebaked glyphs, sorted by glyph indices. Remains owned by the caller.
+ * @param pairCount	Number of entries in pairs.
+ */
+void FreeTypeGX::setMetrics(int16_t ascender, int16_t descender, bool kerningEnabled, const ftgxKerningPair *pairs, uint32_t pairCount)
+{
+	this->ftAscender = ascender;
+	this->ftDescender = descender;
+	this->ftKerningEnabled = kerningEnabled;
+	this->ftMetricsLoaded = true;
+	this->kerningPairs = pairs;
+	this->kerningPairCount = pairCount;
+}
+
+/**
+ * Loads the rendered bitmap into the relevant structure's data buffer.
+ *
+ * This routine converts the glyph's rendered 8-bit grayscale bitmap directly into the tiled texture format in a single pass,
+ * without an intermediate RGBA buffer.
+ *
+ * @param bmp	A pointer to the most recently rendered glyph's bitmap.
+ * @param charData	A pointer to an allocated ftgxCharData structure whose data represent that of the last rendered glyph.
+ */
+void FreeTypeGX::loadGlyphData(FT_Bitmap *bmp, ftgxCharData *charData)
+{
+	uint32_t textureSize = getTextureSize(charData->textureWidth, charData->textureHeight, this->textureFormat);
+	charData->glyphDataTexture = (uint32_t *)memalign(32, textureSize);
+
+	Metaphrasis::convertIntensityToTexture(this->textureFormat, bmp->buffer, bmp->width, bmp->rows, bmp->pitch,
+		charData->glyphDataTexture, charData->textureWidth, charData->textureHeight);
+	DCFlushRange(charData->glyphDataTexture, textureSize);
 }
 
 /**
@@ -525,8 +1597,9 @@ uint16_t FreeTypeGX::drawText(int16_t x, int16_t y, wchar_t *text, GXColor color
 	uint16_t x_pos = x, printed = 0;
 	uint16_t x_offset = 0, y_offset = 0;
 	GXTexObj glyphTexture;
-	FT_Vector pairDelta;
 	ftgxDataOffset offset;
+	ftgxCharData* prevGlyph = NULL;
+	bool kerning = this->isKerningEnabled();
 
   y = -y;
 
@@ -542,22 +1615,13 @@ uint16_t FreeTypeGX::drawText(int16_t x, int16_t y, wchar_t *text, GXColor color
 
 	for (uint16_t i = 0; i < strLength; i++)
 	{
-		ftgxCharData* glyphData = NULL;
-		if( this->fontData.find(text[i]) != this->fontData.end() )
-		{
-			glyphData = &this->fontData[text[i]];
-		}
-		else
-		{
-			glyphData = this->cacheGlyphData(text[i]);
-		}
+		ftgxCharData* glyphData = this->lookupGlyphData(text[i]);
 
 		if(glyphData != NULL)
 		{
-			if(this->ftKerningEnabled && i)
+			if(kerning && prevGlyph)
 			{
-				FT_Get_Kerning( ftFace, this->fontData[text[i - 1]].glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta );
-				x_pos += pairDelta.x >> 6;
+				x_pos += this->getKerning(prevGlyph->glyphIndex, glyphData->glyphIndex);
 			}
 
 			GX_InitTexObj(&glyphTexture, glyphData->glyphDataTexture, glyphData->textureWidth, glyphData->textureHeight, this->textureFormat, GX_CLAMP, GX_CLAMP, GX_FALSE);
@@ -566,6 +1630,7 @@ uint16_t FreeTypeGX::drawText(int16_t x, int16_t y, wchar_t *text, GXColor color
 			x_pos += glyphData->glyphAdvanceX;
 			printed++;
 		}
+		prevGlyph = glyphData;
 	}
 
 	if(textStyle & FTGX_STYLE_MASK)
@@ -609,30 +1674,22 @@ uint16_t FreeTypeGX::getWidth(wchar_t *text)
 {
 	uint16_t strLength = wcslen(text);
 	uint16_t strWidth = 0;
-	FT_Vector pairDelta;
+	ftgxCharData* prevGlyph = NULL;
+	bool kerning = this->isKerningEnabled();
 
 	for (uint16_t i = 0; i < strLength; i++)
 	{
-
-		ftgxCharData* glyphData = NULL;
-		if( this->fontData.find(text[i]) != this->fontData.end() )
-		{
-			glyphData = &this->fontData[text[i]];
-		}
-		else
-		{
-			glyphData = this->cacheGlyphData(text[i]);
-		}
+		ftgxCharData* glyphData = this->getGlyphData(text[i]);
 
 		if(glyphData != NULL)
 		{
-			if(this->ftKerningEnabled && (i > 0))
+			if(kerning && prevGlyph)
 			{
-				FT_Get_Kerning( ftFace, this->fontData[text[i - 1]].glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta );
-				strWidth += pairDelta.x >> 6;
+				strWidth += this->getKerning(prevGlyph->glyphIndex, glyphData->glyphIndex);
 			}
 			strWidth += glyphData->glyphAdvanceX;
 		}
+		prevGlyph = glyphData;
 	}
 	return strWidth;
 }
@@ -688,16 +1745,7 @@ void FreeTypeGX::getOffset(wchar_t *text, ftgxDataOffset* offset)
 
 	for (uint16_t i = 0; i < strLength; i++)
 	{
-
-		ftgxCharData* glyphData = NULL;
-		if( this->fontData.find(text[i]) != this->fontData.end() )
-		{
-			glyphData = &this->fontData[text[i]];
-		}
-		else
-		{
-			glyphData = this->cacheGlyphData(text[i]);
-		}
+		ftgxCharData* glyphData = this->getGlyphData(text[i]);
 
 		if(glyphData != NULL)
 		{
@@ -705,8 +1753,7 @@ void FreeTypeGX::getOffset(wchar_t *text, ftgxDataOffset* offset)
 			strMin = glyphData->renderOffsetMin < strMin ? glyphData->renderOffsetMin : strMin;
 		}
 	}
-	offset->ascender = ftFace->size->metrics.ascender>>6;
-	offset->descender = ftFace->size->metrics.descender>>6;
+	this->getMetrics(&offset->ascender, &offset->descender);
 	offset->max = strMax;
 	offset->min = strMin;
 }
@@ -717,7 +1764,7 @@ void FreeTypeGX::getOffset(wchar_t *text, ftgxDataOffset* offset)
  */
 void FreeTypeGX::getOffset(wchar_t const *text, ftgxDataOffset* offset)
 {
-	this->getOffset(text, offset);
+	this->getOffset((wchar_t *)text, offset);
 }
 
 /**
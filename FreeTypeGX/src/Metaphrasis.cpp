@@ -20,6 +20,7 @@
  */
 
 #include "Metaphrasis.h"
+#include "wii_swizzle.h"
 
 /**
  * Default constructor for the Metaphrasis class.
@@ -49,21 +50,8 @@ Metaphrasis::~Metaphrasis() {
 uint32_t* Metaphrasis::convertBufferToI4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = bufferWidth * bufferHeight >> 1;
 	uint32_t* dataBufferI4 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferI4, 0x00, bufferSize);
-
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferI4;
-
-	for(uint16_t y = 0; y < bufferHeight; y += 8) {
-		for(uint16_t x = 0; x < bufferWidth; x += 8) {
-			for(uint16_t rows = 0; rows < 8; rows++) {
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 0)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 1)] & 0xf0) >> 4);
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 2)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 3)] & 0xf0) >> 4);
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 4)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 5)] & 0xf0) >> 4);
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 5)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 7)] & 0xf0) >> 4);
-			}
-		}
-	}
+
+	wii_swizzle<SwizzleI4>(SwizzlePitchRows(rgbaBuffer, bufferWidth << 2), SwizzlePixelRGBA32(), 0, bufferWidth, bufferHeight, dataBufferI4, bufferWidth, 0, 0);
 	DCFlushRange(dataBufferI4, bufferSize);
 
 	return dataBufferI4;
@@ -83,25 +71,8 @@ uint32_t* Metaphrasis::convertBufferToI4(uint32_t* rgbaBuffer, uint16_t bufferWi
 uint32_t* Metaphrasis::convertBufferToI8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = bufferWidth * bufferHeight;
 	uint32_t* dataBufferI8 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferI8, 0x00, bufferSize);
-
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferI8;
-
-	for(uint16_t y = 0; y < bufferHeight; y += 4) {
-		for(uint16_t x = 0; x < bufferWidth; x += 8) {
-			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 0)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 1)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 2)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 3)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 4)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 5)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 6)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 7)] & 0xff;
-			}
-		}
-	}
+
+	wii_swizzle<SwizzleI8>(SwizzlePitchRows(rgbaBuffer, bufferWidth << 2), SwizzlePixelRGBA32(), 0, bufferWidth, bufferHeight, dataBufferI8, bufferWidth, 0, 0);
 	DCFlushRange(dataBufferI8, bufferSize);
 
 	return dataBufferI8;
@@ -139,25 +110,8 @@ uint8_t Metaphrasis::convertRGBAToIA4(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToIA4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = bufferWidth * bufferHeight;
 	uint32_t* dataBufferIA4 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferIA4, 0x00, bufferSize);
-
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferIA4;
-
-	for(uint16_t y = 0; y < bufferHeight; y += 4) {
-		for(uint16_t x = 0; x < bufferWidth; x += 8) {
-			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 3)]);
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 4)]);
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 5)]);
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 6)]);
-				*dst++ = Metaphrasis::convertRGBAToIA4(src[((y + rows) * bufferWidth) + (x + 7)]);
-			}
-		}
-	}
+
+	wii_swizzle<SwizzleTexel8<Metaphrasis::convertRGBAToIA4> >(SwizzlePitchRows(rgbaBuffer, bufferWidth << 2), SwizzlePixelRGBA32(), 0, bufferWidth, bufferHeight, dataBufferIA4, bufferWidth, 0, 0);
 	DCFlushRange(dataBufferIA4, bufferSize);
 
 	return dataBufferIA4;
@@ -195,21 +149,8 @@ uint16_t Metaphrasis::convertRGBAToIA8(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToIA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 1;
 	uint32_t* dataBufferIA8 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferIA8, 0x00, bufferSize);
-
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint16_t *dst = (uint16_t *)dataBufferIA8;
-
-	for(uint16_t y = 0; y < bufferHeight; y += 4) {
-		for(uint16_t x = 0; x < bufferWidth; x += 4) {
-			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = Metaphrasis::convertRGBAToIA8(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = Metaphrasis::convertRGBAToIA8(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = Metaphrasis::convertRGBAToIA8(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = Metaphrasis::convertRGBAToIA8(src[((y + rows) * bufferWidth) + (x + 3)]);
-			}
-		}
-	}
+
+	wii_swizzle<SwizzleTexel16<Metaphrasis::convertRGBAToIA8> >(SwizzlePitchRows(rgbaBuffer, bufferWidth << 2), SwizzlePixelRGBA32(), 0, bufferWidth, bufferHeight, dataBufferIA8, bufferWidth, 0, 0);
 	DCFlushRange(dataBufferIA8, bufferSize);
 
 	return dataBufferIA8;
@@ -229,27 +170,8 @@ uint32_t* Metaphrasis::convertBufferToIA8(uint32_t* rgbaBuffer, uint16_t bufferW
 uint32_t* Metaphrasis::convertBufferToRGBA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 2;
 	uint32_t* dataBufferRGBA8 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferRGBA8, 0x00, bufferSize);
-
-	uint8_t *src = (uint8_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferRGBA8;
-
-	for(uint16_t block = 0; block < bufferHeight; block += 4) {
-		for(uint16_t i = 0; i < bufferWidth; i += 4) {
-			for (uint16_t c = 0; c < 4; c++) {
-				for (uint16_t ar = 0; ar < 4; ar++) {
-					*dst++ = src[(((i + ar) + ((block + c) * bufferWidth)) * 4) + 3];
-					*dst++ = src[((i + ar) + ((block + c) * bufferWidth)) * 4];
-				}
-			}
-			for (uint16_t c = 0; c < 4; c++) {
-				for (uint16_t gb = 0; gb < 4; gb++) {
-					*dst++ = src[(((i + gb) + ((block + c) * bufferWidth)) * 4) + 1];
-					*dst++ = src[(((i + gb) + ((block + c) * bufferWidth)) * 4) + 2];
-				}
-			}
-		}
-	}
+
+	wii_swizzle<SwizzleRGBA8>(SwizzlePitchRows(rgbaBuffer, bufferWidth << 2), SwizzlePixelRGBA32(), 0, bufferWidth, bufferHeight, dataBufferRGBA8, bufferWidth, 0, 0);
 	DCFlushRange(dataBufferRGBA8, bufferSize);
 
 	return dataBufferRGBA8;
@@ -266,11 +188,15 @@ uint32_t* Metaphrasis::convertBufferToRGBA8(uint32_t* rgbaBuffer, uint16_t buffe
  */
 
 uint16_t Metaphrasis::convertRGBAToRGB565(uint32_t rgba) {
-	uint8_t r, g, b;
+	uint32_t r, g, b;
 	
-	r = (((rgba >> 24) & 0xff) * 31) / 255;
-	g = (((rgba >> 16) & 0xff) * 63) / 255;
-	b = (((rgba >>  8) & 0xff) * 31) / 255;
+	// v / 255 == (v + 1 + (v >> 8)) >> 8 for all v < 65535, avoiding the division per texel
+	r = ((rgba >> 24) & 0xff) * 31;
+	g = ((rgba >> 16) & 0xff) * 63;
+	b = ((rgba >>  8) & 0xff) * 31;
+	r = (r + 1 + (r >> 8)) >> 8;
+	g = (g + 1 + (g >> 8)) >> 8;
+	b = (b + 1 + (b >> 8)) >> 8;
 
 	return (((r << 6) | g ) << 5 ) | b;
 }
@@ -289,21 +215,8 @@ uint16_t Metaphrasis::convertRGBAToRGB565(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToRGB565(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 1;
 	uint32_t* dataBufferRGB565 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferRGB565, 0x00, bufferSize);
-
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint16_t *dst = (uint16_t *)dataBufferRGB565;
-
-	for(uint16_t y = 0; y < bufferHeight; y += 4) {
-		for(uint16_t x = 0; x < bufferWidth; x += 4) {
-			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = Metaphrasis::convertRGBAToRGB565(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = Metaphrasis::convertRGBAToRGB565(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = Metaphrasis::convertRGBAToRGB565(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = Metaphrasis::convertRGBAToRGB565(src[((y + rows) * bufferWidth) + (x + 3)]);
-			}
-		}
-	}
+
+	wii_swizzle<SwizzleTexel16<Metaphrasis::convertRGBAToRGB565> >(SwizzlePitchRows(rgbaBuffer, bufferWidth << 2), SwizzlePixelRGBA32(), 0, bufferWidth, bufferHeight, dataBufferRGB565, bufferWidth, 0, 0);
 	DCFlushRange(dataBufferRGB565, bufferSize);
 
 	return dataBufferRGB565;
@@ -362,22 +275,234 @@ uint16_t Metaphrasis::convertRGBAToRGB5A3(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToRGB5A3(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 1;
 	uint32_t* dataBufferRGB5A3 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferRGB5A3, 0x00, bufferSize);
-
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint16_t *dst = (uint16_t *)dataBufferRGB5A3;
-
-	for(uint16_t y = 0; y < bufferHeight; y += 4) {
-		for(uint16_t x = 0; x < bufferWidth; x += 4) {
-			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = Metaphrasis::convertRGBAToRGB5A3(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = Metaphrasis::convertRGBAToRGB5A3(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = Metaphrasis::convertRGBAToRGB5A3(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = Metaphrasis::convertRGBAToRGB5A3(src[((y + rows) * bufferWidth) + (x + 3)]);
-			}
-		}
-	}
+
+	wii_swizzle<SwizzleTexel16<Metaphrasis::convertRGBAToRGB5A3> >(SwizzlePitchRows(rgbaBuffer, bufferWidth << 2), SwizzlePixelRGBA32(), 0, bufferWidth, bufferHeight, dataBufferRGB5A3, bufferWidth, 0, 0);
 	DCFlushRange(dataBufferRGB5A3, bufferSize);
 
 	return dataBufferRGB5A3;
 }
+
+static uint16_t intensityRGB565[256];
+static uint16_t intensityRGB5A3[256];
+
+static uint16_t packIntensityRGB565(uint32_t rgba) {
+	return intensityRGB565[rgba & 0xff];
+}
+
+static uint16_t packIntensityRGB5A3(uint32_t rgba) {
+	return intensityRGB5A3[rgba & 0xff];
+}
+
+/**
+ * Convert the specified 8-bit intensity image into a tiled texture.
+ * 
+ * Texels outside of the image are zero, allowing the texture buffer to be larger than the image.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture.
+ * @param bufferWidth	Pixel width of the texture, a multiple of the tile width.
+ * @param bufferHeight	Pixel height of the texture, a multiple of the tile height.
+ */
+
+template <class Texture>
+static inline void convertIntensity(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	uint16_t width = imageWidth < bufferWidth ? imageWidth : bufferWidth;
+	uint16_t height = imageHeight < bufferHeight ? imageHeight : bufferHeight;
+
+	// Tiles that the image does not reach at all are not written by the swizzler
+	if(bufferWidth - width >= Texture::TILE_W || bufferHeight - height >= Texture::TILE_H)
+		memset(textureBuffer, 0x00, (bufferWidth / Texture::TILE_W) * (bufferHeight / Texture::TILE_H) * Texture::TILE_BYTES);
+
+	wii_swizzle<Texture>(SwizzlePitchRows(intensityBuffer, imagePitch), SwizzlePixelI8(), 0, width, height, textureBuffer, bufferWidth, 0, 0);
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the texture format
+ * 
+ * This routine dispatches to the convertIntensityTo* routine for the specified texture format.
+ * 
+ * @param textureFormat	Format (GX_TF_*) of the texture.
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture, must hold the full (aligned) texture dimensions.
+ * @param bufferWidth	Pixel width of the texture, aligned to the tile width of the format.
+ * @param bufferHeight	Pixel height of the texture, aligned to the tile height of the format.
+ */
+
+void Metaphrasis::convertIntensityToTexture(uint8_t textureFormat, const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	switch(textureFormat) {
+		case GX_TF_I4:
+			Metaphrasis::convertIntensityToI4(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+			break;
+		case GX_TF_I8:
+			Metaphrasis::convertIntensityToI8(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+			break;
+		case GX_TF_IA4:
+			Metaphrasis::convertIntensityToIA4(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+			break;
+		case GX_TF_IA8:
+			Metaphrasis::convertIntensityToIA8(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+			break;
+		case GX_TF_RGB565:
+			Metaphrasis::convertIntensityToRGB565(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+			break;
+		case GX_TF_RGB5A3:
+			Metaphrasis::convertIntensityToRGB5A3(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+			break;
+		case GX_TF_RGBA8:
+		default:
+			Metaphrasis::convertIntensityToRGBA8(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+			break;
+	}
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the I4 texture format
+ * 
+ * This routine converts the intensity image into the I4 texture format (8x8 tiles) in a single pass. The result
+ * matches convertBufferToI4 for an RGBA buffer whose channels all hold the intensity.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture (bufferWidth * bufferHeight / 2 bytes).
+ * @param bufferWidth	Pixel width of the texture, a multiple of 8.
+ * @param bufferHeight	Pixel height of the texture, a multiple of 8.
+ */
+
+void Metaphrasis::convertIntensityToI4(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	convertIntensity<SwizzleI4>(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the I8 texture format
+ * 
+ * This routine converts the intensity image into the I8 texture format (8x4 tiles) in a single pass.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture (bufferWidth * bufferHeight bytes).
+ * @param bufferWidth	Pixel width of the texture, a multiple of 8.
+ * @param bufferHeight	Pixel height of the texture, a multiple of 4.
+ */
+
+void Metaphrasis::convertIntensityToI8(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	convertIntensity<SwizzleI8>(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the IA4 texture format
+ * 
+ * This routine converts the intensity image into the IA4 texture format (8x4 tiles) in a single pass, using the
+ * intensity for both the intensity and alpha components.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture (bufferWidth * bufferHeight bytes).
+ * @param bufferWidth	Pixel width of the texture, a multiple of 8.
+ * @param bufferHeight	Pixel height of the texture, a multiple of 4.
+ */
+
+void Metaphrasis::convertIntensityToIA4(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	convertIntensity<SwizzleIA4>(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the IA8 texture format
+ * 
+ * This routine converts the intensity image into the IA8 texture format (4x4 tiles) in a single pass, using the
+ * intensity for both the intensity and alpha components.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture (bufferWidth * bufferHeight * 2 bytes).
+ * @param bufferWidth	Pixel width of the texture, a multiple of 4.
+ * @param bufferHeight	Pixel height of the texture, a multiple of 4.
+ */
+
+void Metaphrasis::convertIntensityToIA8(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	convertIntensity<SwizzleIA8>(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the RGBA8 texture format
+ * 
+ * This routine converts the intensity image into the RGBA8 texture format (4x4 tiles, AR then GB) in a single pass,
+ * using the intensity for all four components.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture (bufferWidth * bufferHeight * 4 bytes).
+ * @param bufferWidth	Pixel width of the texture, a multiple of 4.
+ * @param bufferHeight	Pixel height of the texture, a multiple of 4.
+ */
+
+void Metaphrasis::convertIntensityToRGBA8(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	convertIntensity<SwizzleRGBA8>(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the RGB565 texture format
+ * 
+ * This routine converts the intensity image into the RGB565 texture format (4x4 tiles) in a single pass, using a
+ * lookup table built from convertRGBAToRGB565.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture (bufferWidth * bufferHeight * 2 bytes).
+ * @param bufferWidth	Pixel width of the texture, a multiple of 4.
+ * @param bufferHeight	Pixel height of the texture, a multiple of 4.
+ */
+
+void Metaphrasis::convertIntensityToRGB565(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	static bool lutReady = false;
+	if(!lutReady) {
+		for(uint32_t i = 0; i < 256; i++)
+			intensityRGB565[i] = Metaphrasis::convertRGBAToRGB565(i * 0x01010101);
+		lutReady = true;
+	}
+
+	convertIntensity<SwizzleTexel16<packIntensityRGB565> >(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+}
+
+/**
+ * Convert the specified 8-bit intensity image into the RGB5A3 texture format
+ * 
+ * This routine converts the intensity image into the RGB5A3 texture format (4x4 tiles) in a single pass, using a
+ * lookup table built from convertRGBAToRGB5A3.
+ * 
+ * @param intensityBuffer	Buffer containing the 8-bit intensity image.
+ * @param imageWidth	Pixel width of the image.
+ * @param imageHeight	Pixel height of the image.
+ * @param imagePitch	Byte offset between the rows of the image.
+ * @param textureBuffer	Buffer receiving the texture (bufferWidth * bufferHeight * 2 bytes).
+ * @param bufferWidth	Pixel width of the texture, a multiple of 4.
+ * @param bufferHeight	Pixel height of the texture, a multiple of 4.
+ */
+
+void Metaphrasis::convertIntensityToRGB5A3(const uint8_t* intensityBuffer, uint16_t imageWidth, uint16_t imageHeight, int32_t imagePitch, void* textureBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	static bool lutReady = false;
+	if(!lutReady) {
+		for(uint32_t i = 0; i < 256; i++)
+			intensityRGB5A3[i] = Metaphrasis::convertRGBAToRGB5A3(i * 0x01010101);
+		lutReady = true;
+	}
+
+	convertIntensity<SwizzleTexel16<packIntensityRGB5A3> >(intensityBuffer, imageWidth, imageHeight, imagePitch, textureBuffer, bufferWidth, bufferHeight);
+}
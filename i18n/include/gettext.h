@@ -3,5 +3,6 @@
 
 bool LoadLanguage(const char* langfile);
 const char* gettextmsg(const char* msg);
+void gettextforeach(void (*callback)(const char* msgstr));
 
 #endif /* _GETTEXT_H_ */
@@ -227,3 +227,10 @@ const char* gettextmsg(const char* msgid) {
     }
     return msgid;
 }
+
+void gettextforeach(void (*callback)(const char* msgstr)) {
+    for (map<string, string>::iterator iter = msgmap.begin();
+         iter != msgmap.end(); ++iter) {
+        callback(iter->second.c_str());
+    }
+}
@@ -36,6 +36,8 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  *
  ****************************************************************************************/
+#include <gctypes.h>
+
 typedef enum {
     VI_GM_0_1 = 1,
     VI_GM_0_2,
@@ -69,5 +71,35 @@ typedef enum {
     VI_GM_3_0
 } VIGamma;
 
+/* I2C transactions of the encoder register writes */
+typedef struct {
+    u32 issued;  /* Writes sent to the encoder */
+    u32 skipped; /* Writes skipped as the registers held the values already */
+} VIEncoderStats;
+
 extern void VIDEO_SetGamma(VIGamma gamma);
 extern void VIDEO_SetTrapFilter(int enable);
+
+/* Forgets the shadowed encoder registers (after they were written elsewhere,
+   such as by libogc when the video mode is configured). Applications must
+   call it after each VIDEO_Configure of their own (directly, or through
+   WII_SetDefaultVideoMode or WII_SetWidescreen), or writes of the values
+   the registers held before are skipped. The menu calls it already. */
+extern void VIDEO_InvalidateEncoderState(void);
+extern void VIDEO_GetEncoderStats(VIEncoderStats* stats);
+extern void VIDEO_ResetEncoderStats(void);
+
+/* Queued updates, written by VIDEO_FlushEncoderUpdates. Queuing a register
+   again replaces its pending value; a direct write cancels it. */
+extern void VIDEO_QueueGamma(VIGamma gamma);
+extern void VIDEO_QueueTrapFilter(int enable);
+extern void VIDEO_QueueWSS(u16 value);
+extern void VIDEO_QueueRGBOverDrive(u8 value);
+
+/* Writes the queued registers, coalescing neighbouring ones into bursts */
+extern void VIDEO_FlushEncoderUpdates(void);
+
+/* Flushes the queued registers from the post-retrace callback (the previous
+   callback is chained). Disabling restores the previous callback, unless
+   another callback was set in the meantime. */
+extern void VIDEO_SetEncoderRetraceFlush(BOOL enable);
@@ -0,0 +1,96 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wiicolem]                                            //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#ifndef WII_FILTER_H
+#define WII_FILTER_H
+
+#include <gctypes.h>
+
+/** No filter (nearest neighbour scaling) */
+#define WII_FILTER_NONE 0
+/** Scale2x at a scale of 2, Scale3x at a scale of 3 */
+#define WII_FILTER_SCALENX 1
+/** Every last row of a scaled pixel is darkened */
+#define WII_FILTER_SCANLINES 2
+/** Every last row and column of a scaled pixel is darkened */
+#define WII_FILTER_LCD_GRID 3
+/** The count of filters */
+#define WII_FILTER_COUNT 4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Returns whether the filter supports the pixel size and scale
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   scale The scale
+ * @return  Whether the filter supports the pixel size and scale
+ */
+BOOL wii_filter_supported(int filter, int bpp, int scale);
+
+/**
+ * Returns the count of neighbouring source rows (above and below) that
+ * contribute to the filtered rows of a source row
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ * @return  The count of neighbouring source rows
+ */
+int wii_filter_reach(int filter);
+
+/**
+ * Filters a range of rows of an image while scaling it
+ *
+ * 16bpp pixels are RGB565. 8bpp pixels are palette indices that cannot be
+ * darkened, the effects use the black pixel for them instead.
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   black The black pixel (used by the effects for 8bpp pixels)
+ * @param   src The first row of the source image
+ * @param   srcPitch The distance between the source rows in bytes
+ * @param   dst The first row of the scaled image
+ * @param   dstPitch The distance between the scaled rows in bytes
+ * @param   width The width of the source image
+ * @param   height The height of the source image
+ * @param   scale The scale
+ * @param   top The first source row to filter
+ * @param   bottom The source row following the last row to filter
+ * @return  0 if successful, -1 if the filter does not support the pixel
+ *          size or scale
+ */
+int wii_filter_apply(int filter, int bpp, u32 black, const void* src,
+                     int srcPitch, void* dst, int dstPitch, int width,
+                     int height, int scale, int top, int bottom);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
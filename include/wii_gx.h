@@ -46,6 +46,7 @@ typedef struct gx_imagedata {
     u8* data;
     int width;
     int height;
+    u8 format;  // GX texture format of the data (GX_TF_*)
 } gx_imagedata;
 
 /**
@@ -108,7 +109,18 @@ void wii_gx_drawtext(int16_t x,
 uint16_t wii_gx_gettextwidth(FT_UInt pixelSize, char* text);
 
 /**
- * Draws the image at the specified position
+ * Starts caching the glyphs of the loaded translations (and the specified
+ * strings) in the background, so they are available before they are first
+ * drawn.
+ *
+ * @param   strings Additional strings to cache the glyphs for (may be NULL)
+ * @param   count The count of additional strings
+ */
+void wii_gx_prewarm_glyphs(const char** strings, int count);
+
+/**
+ * Draws the image at the specified position (the data must be GX_TF_RGBA8,
+ * as returned by the loaders that are not compact)
  *
  * @param   xpos The x position
  * @param   ypos The y position
@@ -131,7 +143,54 @@ void wii_gx_drawimage(int xpos,
                       u8 alpha);
 
 /**
- * Loads and returns the data for the image at the specified path
+ * Draws the loaded image at the specified position (in the texture format
+ * it was loaded with)
+ *
+ * @param   xpos The x position
+ * @param   ypos The y position
+ * @param   imgdata The data for the loaded image
+ * @param   degress The rotation degrees
+ * @param   scaleX How much to scale the X
+ * @param   scaleY How much to scale the Y
+ * @param   alpha The alpha amount
+ */
+void wii_gx_drawimagedata(int xpos,
+                          int ypos,
+                          const gx_imagedata* imgdata,
+                          f32 degrees,
+                          f32 scaleX,
+                          f32 scaleY,
+                          u8 alpha);
+
+/**
+ * Sets the directory the pre-swizzled image cache files are written to. The
+ * cache is disabled by default, images are only cached once a directory has
+ * been set. The directory is created if it does not exist.
+ *
+ * @param   dir The cache directory (NULL to disable the cache)
+ * @return  Whether the cache directory is available
+ */
+BOOL wii_gx_set_image_cache_dir(const char* dir);
+
+/**
+ * Returns the dimensions of the image at the specified path, as it would be
+ * loaded with the specified maximum dimension. Only the PNG header is read
+ * and the dimensions are cached in memory (for as long as the size and
+ * modification time of the image file don't change), so layouts can be sized
+ * without loading the images.
+ *
+ * @param   imgpath The path to the image
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @param   width The width of the image (out)
+ * @param   height The height of the image (out)
+ * @return  Whether the dimensions were determined
+ */
+BOOL wii_gx_getimagesize(char* imgpath, int maxdim, int* width, int* height);
+
+/**
+ * Loads and returns the data for the image at the specified path (as
+ * GX_TF_RGBA8)
  *
  * @param   imgpath The path to the image
  * @return  The data for the loaded image
@@ -139,13 +198,47 @@ void wii_gx_drawimage(int xpos,
 gx_imagedata* wii_gx_loadimage(char* imgpath);
 
 /**
- * Loads image data for the specified image buffer
+ * Loads and returns the data for the image at the specified path (as
+ * GX_TF_RGBA8). Images larger than the maximum dimension are box filtered
+ * down while decoding, so the texture only holds what is displayed.
+ *
+ * @param   imgpath The path to the image
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @return  The data for the loaded image
+ */
+gx_imagedata* wii_gx_loadimage_scaled(char* imgpath, int maxdim);
+
+/**
+ * Loads and returns the data for the image at the specified path in the
+ * smallest texture format that holds it (see PNGU_GetTextureFormat). The
+ * format is recorded in the image data, so the image must be drawn with
+ * wii_gx_drawimagedata.
+ *
+ * @param   imgpath The path to the image
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @return  The data for the loaded image
+ */
+gx_imagedata* wii_gx_loadimage_compact(char* imgpath, int maxdim);
+
+/**
+ * Loads image data for the specified image buffer (as GX_TF_RGBA8)
  *
  * @param   buff The image buffer
  * @return  The data for the loaded image
  */
 gx_imagedata* wii_gx_loadimagefrombuff(const u8* buff);
 
+/**
+ * Loads image data for the specified image buffer in the smallest texture
+ * format that holds it. The image must be drawn with wii_gx_drawimagedata.
+ *
+ * @param   buff The image buffer
+ * @return  The data for the loaded image
+ */
+gx_imagedata* wii_gx_loadimagefrombuff_compact(const u8* buff);
+
 /**
  * Frees the specified image data information
  *
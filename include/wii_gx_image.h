@@ -0,0 +1,156 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#ifndef WII_GX_IMAGE_H
+#define WII_GX_IMAGE_H
+
+#include <gctypes.h>
+
+#include "pngu.h"
+
+/*
+ * Decoding of PNG images into GX textures and the pre-swizzled cache files
+ * they are stored in. Shared by wii_gx and the host tool that bakes the cache
+ * files ahead of time (tools/gxt_bake), so both decode and name the images
+ * the same way.
+ */
+
+/** Extension of the pre-swizzled image cache files */
+#define WII_GX_IMAGE_CACHE_EXT ".gxt"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Returns the size of the texture data for the specified format and
+ * dimensions (rounded up to a multiple of 32 bytes)
+ *
+ * @param   format The texture format (GX_TF_*)
+ * @param   width The texture width
+ * @param   height The texture height
+ * @return  The size of the texture data
+ */
+int wii_gx_image_size(u8 format, int width, int height);
+
+/**
+ * Scales the image dimensions down to the maximum dimension, keeping the
+ * aspect ratio (the texture dimensions must be multiples of four)
+ *
+ * @param   width The width of the image (in/out)
+ * @param   height The height of the image (in/out)
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @return  Whether the image is scaled
+ */
+BOOL wii_gx_image_scaledsize(int* width, int* height, int maxdim);
+
+/**
+ * Decodes the image into a texture (box filtered down to the maximum
+ * dimension). The context is not released.
+ *
+ * @param   ctx The image context
+ * @param   maxdim The maximum width and height of the texture (0 for no
+ *          limit)
+ * @param   compact Whether to use the smallest texture format that holds the
+ *          image (otherwise GX_TF_RGBA8)
+ * @param   width The width of the texture (out)
+ * @param   height The height of the texture (out)
+ * @param   format The texture format (out)
+ * @return  The texture data (32 byte aligned, NULL if the decode failed)
+ */
+u8* wii_gx_image_decode(IMGCTX ctx, int maxdim, BOOL compact, int* width,
+                        int* height, u8* format);
+
+/**
+ * Returns the hash of the specified image path (FNV-1a)
+ *
+ * @param   imgpath The path to the image
+ * @return  The hash of the image path
+ */
+u32 wii_gx_image_pathhash(const char* imgpath);
+
+/**
+ * Returns the path of the pre-swizzled cache file for the specified image.
+ * The cache files are named after the hash of the image path, the maximum
+ * dimension and whether the image is compact (%08x_%d[c].gxt), the header of
+ * the file identifies the image it was written for.
+ *
+ * @param   dir The directory of the cache files
+ * @param   imgpath The path to the image (as the application loads it)
+ * @param   maxdim The maximum dimension the image is loaded with
+ * @param   compact Whether the image is loaded in the smallest format
+ * @param   cachepath The buffer to receive the path of the cache file
+ * @param   size The size of the buffer
+ */
+void wii_gx_image_cachepath(const char* dir, const char* imgpath, int maxdim,
+                            BOOL compact, char* cachepath, int size);
+
+/**
+ * Loads the texture from the pre-swizzled cache file of an image. The cache
+ * is only used if it was written for the same size and modification time of
+ * the image and the same maximum dimension.
+ *
+ * @param   cachepath The path of the cache file
+ * @param   imgpath The path to the image (as the application loads it)
+ * @param   srcSize The size of the image file
+ * @param   srcMtime The modification time of the image file
+ * @param   maxdim The maximum dimension the image is loaded with
+ * @param   compact Whether the image is loaded in the smallest format
+ * @param   width The width of the texture (out)
+ * @param   height The height of the texture (out)
+ * @param   format The texture format (out)
+ * @return  The texture data (32 byte aligned, NULL if the cache is not valid)
+ */
+u8* wii_gx_image_loadcache(const char* cachepath, const char* imgpath,
+                           u32 srcSize, u32 srcMtime, int maxdim, BOOL compact,
+                           int* width, int* height, u8* format);
+
+/**
+ * Writes the pre-swizzled cache file of an image. A partially written file
+ * is removed.
+ *
+ * @param   cachepath The path of the cache file
+ * @param   imgpath The path to the image (as the application loads it)
+ * @param   srcSize The size of the image file
+ * @param   srcMtime The modification time of the image file
+ * @param   maxdim The maximum dimension the image was loaded with
+ * @param   data The texture data
+ * @param   width The width of the texture
+ * @param   height The height of the texture
+ * @param   format The texture format
+ * @return  Whether the cache file was written
+ */
+BOOL wii_gx_image_savecache(const char* cachepath, const char* imgpath,
+                            u32 srcSize, u32 srcMtime, int maxdim,
+                            const u8* data, int width, int height, u8 format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
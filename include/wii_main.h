@@ -104,6 +104,8 @@ extern BOOL wii_usb_keepalive;
 extern BOOL wii_trap_filter;
 /** 16:9 correction */
 extern BOOL wii_16_9_correction;
+/** Whether to release the menu font glyphs when the menu is closed */
+extern BOOL wii_menu_trim_fonts;
 
 /** The display mode (from SDL) */
 extern GXRModeObj *vmode;
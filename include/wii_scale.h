@@ -0,0 +1,263 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wiicolem]                                            //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#ifndef WII_SCALE_H
+#define WII_SCALE_H
+
+#include <gctypes.h>
+#include <string.h>
+
+/*
+ * Integer scalers for the blit surface. Each row of the blit surface is
+ * scaled once into the back surface, the remaining rows of the scale are
+ * copies of it. The 8bpp and 16bpp scalers read a word of source pixels and
+ * store the scaled pixels a word at a time, the 32bpp scalers store each
+ * pixel directly.
+ */
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+/** Returns the pixel at the specified index of a word of 8bpp pixels */
+#define WORD_PIXEL8(w, i) (((w) >> (24 - ((i) << 3))) & 0xff)
+/** Packs four 8bpp pixels into a word */
+#define PACK_PIXELS8(a, b, c, d) (((a) << 24) | ((b) << 16) | ((c) << 8) | (d))
+#else
+#define WORD_PIXEL8(w, i) (((w) >> ((i) << 3)) & 0xff)
+#define PACK_PIXELS8(a, b, c, d) ((a) | ((b) << 8) | ((c) << 16) | ((d) << 24))
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+/** Returns the pixel at the specified index of a word of 16bpp pixels */
+#define WORD_PIXEL16(w, i) ((i) ? ((w) & 0xffff) : ((w) >> 16))
+/** Packs two 16bpp pixels into a word */
+#define PACK_PIXELS16(a, b) (((a) << 16) | (b))
+#else
+#define WORD_PIXEL16(w, i) ((i) ? ((w) >> 16) : ((w) & 0xffff))
+#define PACK_PIXELS16(a, b) ((a) | ((b) << 16))
+#endif
+
+/**
+ * Reads a word from a possibly unaligned address
+ *
+ * @param   p The address
+ * @return  The word
+ */
+static inline u32 load_word(const void* p) {
+    u32 w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/**
+ * Writes a word to a possibly unaligned address
+ *
+ * @param   p The address
+ * @param   w The word
+ */
+static inline void store_word(void* p, u32 w) {
+    memcpy(p, &w, sizeof(w));
+}
+
+/**
+ * Scales pixels horizontally, a pixel at a time
+ *
+ * @param   src The source pixels
+ * @param   dst The scaled pixels
+ * @param   width The count of source pixels
+ */
+template <int Scale, typename Pixel>
+static inline void scale_pixels(const Pixel* src, Pixel* dst, int width) {
+    for (; width > 0; width--, src++) {
+        for (int i = 0; i < Scale; i++) {
+            *dst++ = *src;
+        }
+    }
+}
+
+/**
+ * Scales a row of 8bpp pixels horizontally
+ */
+template <int Scale>
+struct ScaleRow8 {
+    static inline void scale(const u8* src, u8* dst, int width) {
+        scale_pixels<Scale>(src, dst, width);
+    }
+};
+
+template <>
+struct ScaleRow8<1> {
+    static inline void scale(const u8* src, u8* dst, int width) {
+        memcpy(dst, src, width);
+    }
+};
+
+template <>
+struct ScaleRow8<2> {
+    static inline void scale(const u8* src, u8* dst, int width) {
+        for (int x = width >> 2; x > 0; x--, src += 4, dst += 8) {
+            u32 w = load_word(src);
+            u32 p0 = WORD_PIXEL8(w, 0), p1 = WORD_PIXEL8(w, 1);
+            u32 p2 = WORD_PIXEL8(w, 2), p3 = WORD_PIXEL8(w, 3);
+            store_word(dst, PACK_PIXELS8(p0, p0, p1, p1));
+            store_word(dst + 4, PACK_PIXELS8(p2, p2, p3, p3));
+        }
+        scale_pixels<2>(src, dst, width & 3);
+    }
+};
+
+template <>
+struct ScaleRow8<3> {
+    static inline void scale(const u8* src, u8* dst, int width) {
+        for (int x = width >> 2; x > 0; x--, src += 4, dst += 12) {
+            u32 w = load_word(src);
+            u32 p0 = WORD_PIXEL8(w, 0), p1 = WORD_PIXEL8(w, 1);
+            u32 p2 = WORD_PIXEL8(w, 2), p3 = WORD_PIXEL8(w, 3);
+            store_word(dst, PACK_PIXELS8(p0, p0, p0, p1));
+            store_word(dst + 4, PACK_PIXELS8(p1, p1, p2, p2));
+            store_word(dst + 8, PACK_PIXELS8(p2, p3, p3, p3));
+        }
+        scale_pixels<3>(src, dst, width & 3);
+    }
+};
+
+/**
+ * Scales a row of 16bpp (RGB565) pixels horizontally
+ */
+template <int Scale>
+struct ScaleRow16 {
+    static inline void scale(const u16* src, u16* dst, int width) {
+        scale_pixels<Scale>(src, dst, width);
+    }
+};
+
+template <>
+struct ScaleRow16<1> {
+    static inline void scale(const u16* src, u16* dst, int width) {
+        memcpy(dst, src, width << 1);
+    }
+};
+
+template <>
+struct ScaleRow16<2> {
+    static inline void scale(const u16* src, u16* dst, int width) {
+        for (int x = width >> 1; x > 0; x--, src += 2, dst += 4) {
+            u32 w = load_word(src);
+            u32 p0 = WORD_PIXEL16(w, 0), p1 = WORD_PIXEL16(w, 1);
+            store_word(dst, PACK_PIXELS16(p0, p0));
+            store_word(dst + 2, PACK_PIXELS16(p1, p1));
+        }
+        scale_pixels<2>(src, dst, width & 1);
+    }
+};
+
+template <>
+struct ScaleRow16<3> {
+    static inline void scale(const u16* src, u16* dst, int width) {
+        for (int x = width >> 1; x > 0; x--, src += 2, dst += 6) {
+            u32 w = load_word(src);
+            u32 p0 = WORD_PIXEL16(w, 0), p1 = WORD_PIXEL16(w, 1);
+            store_word(dst, PACK_PIXELS16(p0, p0));
+            store_word(dst + 2, PACK_PIXELS16(p0, p1));
+            store_word(dst + 4, PACK_PIXELS16(p1, p1));
+        }
+        scale_pixels<3>(src, dst, width & 1);
+    }
+};
+
+/**
+ * Scales a row of 32bpp pixels horizontally
+ */
+template <int Scale>
+struct ScaleRow32 {
+    static inline void scale(const u32* src, u32* dst, int width) {
+        scale_pixels<Scale>(src, dst, width);
+    }
+};
+
+template <>
+struct ScaleRow32<1> {
+    static inline void scale(const u32* src, u32* dst, int width) {
+        memcpy(dst, src, width << 2);
+    }
+};
+
+/**
+ * Scales an image, copying each scaled row for the remaining rows of the
+ * scale
+ *
+ * @param   src The first source row
+ * @param   srcPitch The distance between the source rows in bytes
+ * @param   dst The first destination row
+ * @param   dstPitch The distance between the destination rows in bytes
+ * @param   width The width of the source image
+ * @param   height The height of the source image
+ */
+template <class Row, int Scale, typename Pixel>
+static void scale_image(const u8* src, int srcPitch, u8* dst, int dstPitch,
+                        int width, int height) {
+    int rowBytes = width * Scale * sizeof(Pixel);
+    for (int y = 0; y < height; y++, src += srcPitch) {
+        u8* scaled = dst;
+        Row::scale((const Pixel*)src, (Pixel*)scaled, width);
+        dst += dstPitch;
+        for (int i = 1; i < Scale; i++, dst += dstPitch) {
+            memcpy(dst, scaled, rowBytes);
+        }
+    }
+}
+
+/**
+ * Scales an image by an arbitrary scale
+ *
+ * @param   scale The scale
+ * @param   src The first source row
+ * @param   srcPitch The distance between the source rows in bytes
+ * @param   dst The first destination row
+ * @param   dstPitch The distance between the destination rows in bytes
+ * @param   width The width of the source image
+ * @param   height The height of the source image
+ */
+template <typename Pixel>
+static void scale_image_any(int scale, const u8* src, int srcPitch, u8* dst,
+                            int dstPitch, int width, int height) {
+    int rowBytes = width * scale * sizeof(Pixel);
+    for (int y = 0; y < height; y++, src += srcPitch) {
+        u8* scaled = dst;
+        const Pixel* in = (const Pixel*)src;
+        Pixel* out = (Pixel*)scaled;
+        for (int x = 0; x < width; x++) {
+            for (int j = 0; j < scale; j++) {
+                *out++ = in[x];
+            }
+        }
+        dst += dstPitch;
+        for (int i = 1; i < scale; i++, dst += dstPitch) {
+            memcpy(dst, scaled, rowBytes);
+        }
+    }
+}
+
+#endif
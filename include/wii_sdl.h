@@ -33,6 +33,8 @@
 
 #include <gctypes.h>
 
+#include "wii_filter.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -53,6 +55,18 @@ extern SDL_Color SDL_COLOR_WHITE;
 extern SDL_Color SDL_COLOR_BLACK;
 extern SDL_Color SDL_COLOR_RED;
 
+/** Statistics of the back surface uploads performed by wii_sdl_flip */
+typedef struct wii_sdl_upload_stats {
+    /** The count of flips */
+    u32 frames;
+    /** The count of flips skipped as nothing changed */
+    u32 skippedFrames;
+    /** The bytes uploaded by the last flip */
+    u32 lastBytes;
+    /** The bytes uploaded since the statistics were reset */
+    u64 totalBytes;
+} wii_sdl_upload_stats;
+
 /**
  * Initializes the SDL
  * 
@@ -71,10 +85,82 @@ int wii_sdl_init();
 uint wii_sdl_rgb(u8 R, u8 G, u8 B);
 
 /**
- * Renders the current back surface
+ * Renders the current back surface. If dirty tracking is enabled only the
+ * tile rows (groups of four rows) that changed since the last flip are
+ * uploaded, the flip is skipped if nothing changed. While triple buffering,
+ * the back surface is published for wii_sdl_present instead.
  */
 void wii_sdl_flip();
 
+/**
+ * Enables or disables triple buffering of the back surface. While enabled,
+ * back_surface is one of three offscreen surfaces of the format of the
+ * screen. wii_sdl_flip publishes it as the newest frame (without waiting)
+ * and back_surface is replaced by a free surface, which must be redrawn
+ * entirely. The render side displays the newest frame with
+ * wii_sdl_present. Must not be called while either side is rendering.
+ *
+ * @param   enabled Whether to triple buffer the back surface
+ * @return  Whether triple buffering is in the requested state
+ */
+BOOL wii_sdl_set_triple_buffering(BOOL enabled);
+
+/**
+ * Returns the surface that is displayed (the back surface unless triple
+ * buffering). Palette changes must be applied to this surface.
+ *
+ * @return  The surface that is displayed
+ */
+SDL_Surface* wii_sdl_get_screen_surface();
+
+/**
+ * Displays the newest frame published by wii_sdl_flip while triple buffering
+ * (called by the render side, it never waits for the producer). The screen
+ * is uploaded from the pixels of the newest frame, they are not copied.
+ *
+ * Triple buffering is not enabled by the common code. An emulator that runs
+ * its core on a thread of its own enables it with
+ * wii_sdl_set_triple_buffering before starting the thread, and disables it
+ * after the thread has stopped. The core thread draws into back_surface and
+ * calls wii_sdl_flip for each frame, the pre-render callback of the
+ * emulation (passed to wii_gx_push_callback) calls wii_sdl_present.
+ *
+ * @return  Whether a new frame was displayed
+ */
+BOOL wii_sdl_present();
+
+/**
+ * Enables or disables dirty tracking of the back and blit surfaces. While
+ * enabled, the application must mark the regions it renders to the surfaces
+ * directly (the wii_sdl rendering functions mark their own changes).
+ * Enabling the tracking marks both surfaces as entirely dirty.
+ *
+ * @param   enabled Whether to track the dirty regions
+ */
+void wii_sdl_set_dirty_tracking(BOOL enabled);
+
+/**
+ * Marks a region of the back or blit surface as changed. Changes to the blit
+ * surface are copied to the back surface by wii_sdl_put_image_normal,
+ * changes to the back surface are uploaded by wii_sdl_flip.
+ *
+ * @param   surface The surface (back_surface or blit_surface)
+ * @param   rect The changed region (NULL for the entire surface)
+ */
+void wii_sdl_mark_dirty(SDL_Surface* surface, const SDL_Rect* rect);
+
+/**
+ * Returns the statistics of the back surface uploads
+ *
+ * @param   stats The statistics (return value)
+ */
+void wii_sdl_get_upload_stats(wii_sdl_upload_stats* stats);
+
+/**
+ * Resets the statistics of the back surface uploads
+ */
+void wii_sdl_reset_upload_stats();
+
 /**
  * Renders black to both blit and back surfaces
  */
@@ -88,12 +174,55 @@ void wii_sdl_black_back_surface();
 /**
  * Renders the blit surface to the Wii surface.
  *
- * @param scale  The scale to render the surface (1 or 2)
+ * @param scale  The scale to render the surface (8, 16 and 32bpp surfaces
+ *               of the same format are scaled natively)
  */
 void wii_sdl_put_image_normal(int scale);
 
 /**
- * Renders text to the Wii surface
+ * Sets the filter applied when rendering the blit surface to the Wii surface.
+ * Scales or pixel formats that the filter does not support are rendered
+ * unfiltered.
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ */
+void wii_sdl_set_filter(int filter);
+
+/**
+ * Returns the filter applied when rendering the blit surface to the Wii
+ * surface
+ *
+ * @return  The filter (WII_FILTER_*)
+ */
+int wii_sdl_get_filter();
+
+/**
+ * Converts an 8bpp surface into a tiled GX texture in one pass. The colors
+ * of the palette are converted to texels once, and again only when the
+ * palette of the surface changes.
+ *
+ * The screen texture is uploaded by the SDL video driver of the port, not by
+ * this library, so the driver has to call this function to use it. On
+ * SDL_Flip or SDL_UpdateRect of an 8bpp screen, the driver passes the
+ * screen surface, the format and memory of its texture and the texture
+ * width. It flushes the texture memory (DCFlushRange) and invalidates the
+ * texture cache (GX_InvalidateTexAll) afterwards. The driver's own palette
+ * conversion is used until it does.
+ *
+ * @param   surface The 8bpp surface
+ * @param   format The texture format (GX_TF_RGB565 or GX_TF_RGBA8)
+ * @param   texture The texture (the size of the surface padded to multiples
+ *          of four)
+ * @param   textureWidth The width of the texture (a multiple of four)
+ * @return  0 if successful, -1 if the surface or format is not supported
+ */
+int wii_sdl_surface_to_texture(SDL_Surface* surface,
+                               u8 format,
+                               void* texture,
+                               u16 textureWidth);
+
+/**
+ * Renders text to the Wii surface. The rendered text is cached.
  *
  * @param   font The font to render with
  * @param   text The text to display
@@ -107,6 +236,38 @@ void wii_sdl_render_text(TTF_Font* font,
                          SDL_Color* colorFG,
                          SDL_Color* colorBG);
 
+/**
+ * Renders text containing changing numbers (such as a counter) to the Wii
+ * surface. Text that is not cached as a whole is composed, its numbers are
+ * drawn from cached glyphs of the font and color.
+ *
+ * @param   font The font to render with
+ * @param   text The text to display
+ * @param   destRect The location to render the text
+ * @param   colorFG The foreground color (optional)
+ * @param   colorBG The background color (optional)
+ */
+void wii_sdl_render_numeric_text(TTF_Font* font,
+                                 const char* text,
+                                 SDL_Rect* destRect,
+                                 SDL_Color* colorFG,
+                                 SDL_Color* colorBG);
+
+/**
+ * Flushes the rendered text caches. Must be called when the format of the
+ * back surface changes.
+ */
+void wii_sdl_flush_text_cache();
+
+/**
+ * Closes the specified font. Fonts used to render text must be closed
+ * through this function (rather than TTF_CloseFont), it frees the text
+ * cached for the font.
+ *
+ * @param   font The font to close
+ */
+void wii_sdl_close_font(TTF_Font* font);
+
 /**
  * Determines the size of the text displayed with the specified font
  *
@@ -0,0 +1,89 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wiicolem]                                            //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#ifndef WII_SPAN_H
+#define WII_SPAN_H
+
+#include <gctypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Clips a rectangle to the bounds of a pixel buffer
+ *
+ * @param   x The x location (updated)
+ * @param   y The y location (updated)
+ * @param   w The width (updated)
+ * @param   h The height (updated)
+ * @param   bufferW The width of the buffer
+ * @param   bufferH The height of the buffer
+ * @return  Whether any part of the rectangle lies within the buffer
+ */
+BOOL wii_span_clip(int* x, int* y, int* w, int* h, int bufferW, int bufferH);
+
+/**
+ * Fills a rectangle of a pixel buffer a horizontal span (row) at a time. The
+ * rectangle must lie within the buffer.
+ *
+ * @param   pixels The first pixel of the buffer
+ * @param   pitch The distance between the rows of the buffer in bytes
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   x The x location
+ * @param   y The y location
+ * @param   w The width
+ * @param   h The height
+ * @param   color The color
+ * @param   exor Whether to exclusive or the color with the pixels
+ */
+void wii_span_fill(void* pixels, int pitch, int bpp, int x, int y, int w,
+                   int h, u32 color, BOOL exor);
+
+/**
+ * Draws the outline of a rectangle of a pixel buffer. Each pixel of the
+ * outline is written once (corners are not exclusive or'd twice). The
+ * rectangle must lie within the buffer.
+ *
+ * @param   pixels The first pixel of the buffer
+ * @param   pitch The distance between the rows of the buffer in bytes
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   x The x location
+ * @param   y The y location
+ * @param   w The width
+ * @param   h The height
+ * @param   color The color
+ * @param   exor Whether to exclusive or the color with the pixels
+ */
+void wii_span_frame(void* pixels, int pitch, int bpp, int x, int y, int w,
+                    int h, u32 color, BOOL exor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,584 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wiicolem]                                            //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#ifndef WII_SWIZZLE_H
+#define WII_SWIZZLE_H
+
+#include <gctypes.h>
+
+/** Source rows hold R, G, B bytes (alpha is the default alpha) */
+#define WII_SWIZZLE_SRC_RGB8 0
+/** Source rows hold R, G, B, A bytes */
+#define WII_SWIZZLE_SRC_RGBA8 1
+/** Source rows hold 8-bit intensities (used for all components) */
+#define WII_SWIZZLE_SRC_I8 2
+/** Source rows hold 8-bit intensity and alpha pairs */
+#define WII_SWIZZLE_SRC_IA8 3
+
+/**
+ * The texels of the colors of a palette, precomputed for the conversion of
+ * indexed (8bpp) images
+ */
+typedef struct wii_swizzle_lut {
+    /** The texture format of the texels (GX_TF_RGB565 or GX_TF_RGBA8) */
+    u8 format;
+    /** Whether the texels have been computed */
+    BOOL valid;
+    /** The version of the palette the texels were computed for */
+    u32 version;
+    /** RGB565 texels, or RGBA8 texels as AR << 16 | GB */
+    u32 texels[256];
+} wii_swizzle_lut;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Computes the texels of a palette, unless they were computed for the same
+ * texture format and palette version already
+ *
+ * @param   lut The palette texels
+ * @param   format The texture format (GX_TF_RGB565 or GX_TF_RGBA8)
+ * @param   colors The colors of the palette, four bytes per color (R, G, B
+ *          and an unused byte, as SDL_Color)
+ * @param   count The count of colors (at most 256)
+ * @param   version The version of the palette (changes with its colors)
+ * @param   alpha The alpha of the colors (RGBA8)
+ * @return  0 if the texels are up to date, -1 if the format is not supported
+ */
+int wii_swizzle_lut_update(wii_swizzle_lut* lut, u8 format, const u8* colors,
+                           int count, u32 version, u8 alpha);
+
+/**
+ * Converts an indexed (8bpp) image into a tiled GX texture of the format of
+ * the palette texels, in one pass. Texels of the texture that lie outside of
+ * the image are cleared.
+ *
+ * @param   lut The palette texels
+ * @param   src The first row of the image
+ * @param   srcPitch The distance between the rows of the image in bytes
+ * @param   width The width of the image
+ * @param   height The height of the image
+ * @param   dst The texture (its height is a multiple of four)
+ * @param   dstWidth The width of the texture (a multiple of four)
+ * @return  0 if successful, -1 if the palette texels are not computed
+ */
+int wii_swizzle_indexed(const wii_swizzle_lut* lut, const u8* src,
+                        int srcPitch, u16 width, u16 height, void* dst,
+                        u16 dstWidth);
+
+/**
+ * Converts a rectangle of source rows into a region of a tiled GX texture.
+ * Texels of partially covered tiles that lie outside of the rectangle are
+ * cleared.
+ *
+ * @param   format The texture format (GX_TF_*)
+ * @param   srcLayout The layout of the source rows (WII_SWIZZLE_SRC_*)
+ * @param   rows The source rows (rows[0] is the first row of the rectangle)
+ * @param   srcX The first source column of the rectangle
+ * @param   width The width of the rectangle
+ * @param   height The height of the rectangle
+ * @param   defaultAlpha The alpha for sources without an alpha component
+ * @param   dst The texture
+ * @param   dstWidth The width of the texture (a multiple of the tile width)
+ * @param   dstX The tile aligned column the rectangle is written to
+ * @param   dstY The tile aligned row the rectangle is written to
+ * @return  0 if successful, -1 if the format or layout is not supported
+ */
+int wii_swizzle_rows(u8 format, int srcLayout, const u8* const* rows, u16 srcX,
+                     u16 width, u16 height, u8 defaultAlpha, void* dst,
+                     u16 dstWidth, u16 dstX, u16 dstY);
+
+/**
+ * Converts a band of tiles (four texel rows) of a tiled GX texture into RGB
+ * rows (R, G, B bytes). Alpha is dropped.
+ *
+ * @param   format The texture format (GX_TF_RGBA8 or GX_TF_RGB565)
+ * @param   src The texture
+ * @param   width The width of the image held by the texture (the texture is
+ *          padded to a multiple of the tile width)
+ * @param   bandY The first texel row of the band (a multiple of four)
+ * @param   height The count of rows to convert (at most four)
+ * @param   dst The first RGB row
+ * @param   dstPitch The distance between the RGB rows in bytes
+ * @return  0 if successful, -1 if the format is not supported
+ */
+int wii_deswizzle_rgb8(u8 format, const void* src, u16 width, u16 bandY,
+                       u16 height, u8* dst, int dstPitch);
+
+#ifdef __cplusplus
+}
+
+//
+// Texels are passed between the source and texture policies as packed
+// 32-bit RGBA values (R << 24 | G << 16 | B << 8 | A).
+//
+// On big-endian targets (the Wii) the texture policies combine the texels
+// of a tile row into 32-bit words (SWAR) and store a word at a time. On
+// little-endian hosts with SSE2 or NEON the 16-bit and RGBA8 policies pack a
+// tile row of four texels in one vector. Other targets (or builds defining
+// WII_SWIZZLE_SCALAR) fall back to storing the texels a byte at a time, in
+// the same (big-endian) order as the GPU reads them.
+//
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define WII_SWIZZLE_SWAR
+#elif !defined(WII_SWIZZLE_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#define WII_SWIZZLE_SSE2
+#define WII_SWIZZLE_SIMD
+#elif !defined(WII_SWIZZLE_SCALAR) && defined(__ARM_NEON) && \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define WII_SWIZZLE_NEON
+#define WII_SWIZZLE_SIMD
+#endif
+
+#if defined(WII_SWIZZLE_SSE2)
+typedef __m128i wii_swizzle_vec;
+#define WII_SWIZZLE_VEC_SRL(v, n) _mm_srli_epi32(v, n)
+#define WII_SWIZZLE_VEC_SLL(v, n) _mm_slli_epi32(v, n)
+
+static inline wii_swizzle_vec wii_swizzle_vec_load(const u32* t) {
+    return _mm_loadu_si128((const __m128i*)t);
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_and(wii_swizzle_vec v, u32 m) {
+    return _mm_and_si128(v, _mm_set1_epi32(m));
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_or(wii_swizzle_vec a,
+                                                 wii_swizzle_vec b) {
+    return _mm_or_si128(a, b);
+}
+
+/**
+ * Returns the lanes of a where the mask is set and the lanes of b elsewhere
+ */
+static inline wii_swizzle_vec wii_swizzle_vec_select(wii_swizzle_vec mask,
+                                                     wii_swizzle_vec a,
+                                                     wii_swizzle_vec b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * Returns a mask of the lanes equal to the specified value
+ */
+static inline wii_swizzle_vec wii_swizzle_vec_eq(wii_swizzle_vec v, u32 m) {
+    return _mm_cmpeq_epi32(v, _mm_set1_epi32(m));
+}
+
+/**
+ * Stores the low 16 bits of each lane (SSE2 has no unsigned 32 to 16-bit
+ * pack, so the lanes are sign extended to survive the signed one)
+ */
+static inline void wii_swizzle_vec_store16(u8* d, wii_swizzle_vec v) {
+    v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    _mm_storel_epi64((__m128i*)d, _mm_packs_epi32(v, v));
+}
+#elif defined(WII_SWIZZLE_NEON)
+typedef uint32x4_t wii_swizzle_vec;
+#define WII_SWIZZLE_VEC_SRL(v, n) vshrq_n_u32(v, n)
+#define WII_SWIZZLE_VEC_SLL(v, n) vshlq_n_u32(v, n)
+
+static inline wii_swizzle_vec wii_swizzle_vec_load(const u32* t) {
+    return vld1q_u32(t);
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_and(wii_swizzle_vec v, u32 m) {
+    return vandq_u32(v, vdupq_n_u32(m));
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_or(wii_swizzle_vec a,
+                                                 wii_swizzle_vec b) {
+    return vorrq_u32(a, b);
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_select(wii_swizzle_vec mask,
+                                                     wii_swizzle_vec a,
+                                                     wii_swizzle_vec b) {
+    return vbslq_u32(mask, a, b);
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_eq(wii_swizzle_vec v, u32 m) {
+    return vceqq_u32(v, vdupq_n_u32(m));
+}
+
+static inline void wii_swizzle_vec_store16(u8* d, wii_swizzle_vec v) {
+    vst1_u16((u16*)d, vmovn_u32(v));
+}
+#endif
+
+/**
+ * Source layout of rows separated by a fixed pitch
+ */
+struct SwizzlePitchRows {
+    const u8* base;
+    int pitch;
+
+    SwizzlePitchRows(const void* base, int pitch)
+        : base((const u8*)base), pitch(pitch) {}
+    inline const u8* row(int y) const { return base + y * pitch; }
+};
+
+/**
+ * Source layout of rows referenced by an array of row pointers
+ */
+struct SwizzlePointerRows {
+    const u8* const* rows;
+
+    SwizzlePointerRows(const u8* const* rows) : rows(rows) {}
+    inline const u8* row(int y) const { return rows[y]; }
+};
+
+/**
+ * Source pixels stored as native packed 32-bit RGBA values
+ */
+struct SwizzlePixelRGBA32 {
+    enum { BYTES = 4 };
+    inline u32 read(const u8* p) const { return *(const u32*)p; }
+};
+
+/**
+ * Source pixels stored as R, G, B, A bytes
+ */
+struct SwizzlePixelRGBA8 {
+    enum { BYTES = 4 };
+    inline u32 read(const u8* p) const {
+        return ((u32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    }
+};
+
+/**
+ * Source pixels stored as R, G, B bytes
+ */
+struct SwizzlePixelRGB8 {
+    enum { BYTES = 3 };
+    u32 alpha;
+
+    SwizzlePixelRGB8(u8 alpha) : alpha(alpha) {}
+    inline u32 read(const u8* p) const {
+        return ((u32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | alpha;
+    }
+};
+
+/**
+ * Source pixels stored as 8-bit intensities
+ */
+struct SwizzlePixelI8 {
+    enum { BYTES = 1 };
+    inline u32 read(const u8* p) const { return p[0] * 0x01010101u; }
+};
+
+/**
+ * Source pixels stored as 8-bit intensity and alpha pairs
+ */
+struct SwizzlePixelIA8 {
+    enum { BYTES = 2 };
+    inline u32 read(const u8* p) const { return (p[0] * 0x01010100u) | p[1]; }
+};
+
+/**
+ * I4 texture, 8x8 tiles (intensity from the alpha component)
+ */
+struct SwizzleI4 {
+    enum { TILE_W = 8, TILE_H = 8, TILE_BYTES = 32 };
+    static inline void writeRow(u8* tile, int row, const u32* t) {
+#ifdef WII_SWIZZLE_SWAR
+        *(u32*)(tile + (row << 2)) =
+            ((t[0] & 0xf0) << 24) | ((t[1] & 0xf0) << 20) |
+            ((t[2] & 0xf0) << 16) | ((t[3] & 0xf0) << 12) |
+            ((t[4] & 0xf0) << 8) | ((t[5] & 0xf0) << 4) | (t[6] & 0xf0) |
+            ((t[7] & 0xf0) >> 4);
+#else
+        u8* d = tile + (row << 2);
+        d[0] = (t[0] & 0xf0) | ((t[1] & 0xf0) >> 4);
+        d[1] = (t[2] & 0xf0) | ((t[3] & 0xf0) >> 4);
+        d[2] = (t[4] & 0xf0) | ((t[5] & 0xf0) >> 4);
+        d[3] = (t[6] & 0xf0) | ((t[7] & 0xf0) >> 4);
+#endif
+    }
+};
+
+/**
+ * 8-bit texture with 8x4 tiles, texels packed by the specified function
+ */
+template <u8 (*Pack)(u32)> struct SwizzleTexel8 {
+    enum { TILE_W = 8, TILE_H = 4, TILE_BYTES = 32 };
+    static inline void writeRow(u8* tile, int row, const u32* t) {
+#ifdef WII_SWIZZLE_SWAR
+        u32* d = (u32*)(tile + (row << 3));
+        d[0] = ((u32)Pack(t[0]) << 24) | (Pack(t[1]) << 16) |
+               (Pack(t[2]) << 8) | Pack(t[3]);
+        d[1] = ((u32)Pack(t[4]) << 24) | (Pack(t[5]) << 16) |
+               (Pack(t[6]) << 8) | Pack(t[7]);
+#else
+        u8* d = tile + (row << 3);
+        d[0] = Pack(t[0]);
+        d[1] = Pack(t[1]);
+        d[2] = Pack(t[2]);
+        d[3] = Pack(t[3]);
+        d[4] = Pack(t[4]);
+        d[5] = Pack(t[5]);
+        d[6] = Pack(t[6]);
+        d[7] = Pack(t[7]);
+#endif
+    }
+};
+
+/**
+ * 16-bit texture with 4x4 tiles, texels packed by the specified function
+ */
+template <u16 (*Pack)(u32)> struct SwizzleTexel16 {
+    enum { TILE_W = 4, TILE_H = 4, TILE_BYTES = 32 };
+    static inline void writeRow(u8* tile, int row, const u32* t) {
+#ifdef WII_SWIZZLE_SWAR
+        u32* d = (u32*)tile + (row << 1);
+        d[0] = ((u32)Pack(t[0]) << 16) | Pack(t[1]);
+        d[1] = ((u32)Pack(t[2]) << 16) | Pack(t[3]);
+#else
+        u8* d = tile + (row << 3);
+        for (int i = 0; i < 4; i++) {
+            u16 texel = Pack(t[i]);
+            d[i << 1] = texel >> 8;
+            d[(i << 1) + 1] = texel;
+        }
+#endif
+    }
+};
+
+/**
+ * RGBA8 texture, 4x4 tiles holding the AR values followed by the GB values
+ */
+struct SwizzleRGBA8 {
+    enum { TILE_W = 4, TILE_H = 4, TILE_BYTES = 64 };
+    static inline void writeRow(u8* tile, int row, const u32* t) {
+#ifdef WII_SWIZZLE_SWAR
+        u32* ar = (u32*)tile + (row << 1);
+        u32* gb = ar + 8;
+        ar[0] = ((t[0] & 0xff) << 24) | ((t[0] >> 8) & 0xff0000) |
+                ((t[1] & 0xff) << 8) | (t[1] >> 24);
+        ar[1] = ((t[2] & 0xff) << 24) | ((t[2] >> 8) & 0xff0000) |
+                ((t[3] & 0xff) << 8) | (t[3] >> 24);
+        gb[0] = ((t[0] << 8) & 0xffff0000) | ((t[1] >> 8) & 0xffff);
+        gb[1] = ((t[2] << 8) & 0xffff0000) | ((t[3] >> 8) & 0xffff);
+#elif defined(WII_SWIZZLE_SIMD)
+        // Little-endian 16-bit lanes holding A, R and G, B in memory order
+        u8* ar = tile + (row << 3);
+        wii_swizzle_vec v = wii_swizzle_vec_load(t);
+        wii_swizzle_vec_store16(
+            ar, wii_swizzle_vec_or(wii_swizzle_vec_and(v, 0xff),
+                                   wii_swizzle_vec_and(
+                                       WII_SWIZZLE_VEC_SRL(v, 16), 0xff00)));
+        wii_swizzle_vec_store16(
+            ar + 32, wii_swizzle_vec_or(
+                         wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(v, 16), 0xff),
+                         wii_swizzle_vec_and(v, 0xff00)));
+#else
+        u8* ar = tile + (row << 3);
+        u8* gb = ar + 32;
+        for (int i = 0; i < 4; i++, ar += 2, gb += 2) {
+            ar[0] = t[i];
+            ar[1] = t[i] >> 24;
+            gb[0] = t[i] >> 16;
+            gb[1] = t[i] >> 8;
+        }
+#endif
+    }
+};
+
+static inline u8 wii_swizzle_pack_i8(u32 t) {
+    return t;
+}
+
+/**
+ * IA4 and IA8 texels hold the alpha in their upper half and the intensity
+ * (taken from the blue component) in their lower half
+ */
+static inline u8 wii_swizzle_pack_ia4(u32 t) {
+    return (t & 0xf0) | ((t >> 12) & 0x0f);
+}
+
+static inline u16 wii_swizzle_pack_ia8(u32 t) {
+    return (t << 8) | ((t >> 8) & 0xff);
+}
+
+static inline u16 wii_swizzle_pack_rgb565(u32 t) {
+    return ((t >> 16) & 0xf800) | ((t >> 13) & 0x07e0) | ((t >> 11) & 0x001f);
+}
+
+static inline u16 wii_swizzle_pack_rgb5a3(u32 t) {
+    if ((t & 0xe0) == 0xe0) {
+        // Opaque, RGB555
+        return 0x8000 | ((t >> 17) & 0x7c00) | ((t >> 14) & 0x03e0) |
+               ((t >> 11) & 0x001f);
+    }
+    // Translucent, ARGB3444
+    return ((t & 0xe0) << 7) | ((t >> 20) & 0x0f00) | ((t >> 16) & 0x00f0) |
+           ((t >> 12) & 0x000f);
+}
+
+#ifdef WII_SWIZZLE_SIMD
+//
+// Vector forms of the 16-bit pack functions, each lane holds a texel
+//
+
+static inline wii_swizzle_vec wii_swizzle_vec_pack_ia8(wii_swizzle_vec t) {
+    return wii_swizzle_vec_or(
+        wii_swizzle_vec_and(WII_SWIZZLE_VEC_SLL(t, 8), 0xff00),
+        wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 8), 0x00ff));
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_pack_rgb565(wii_swizzle_vec t) {
+    return wii_swizzle_vec_or(
+        wii_swizzle_vec_or(
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 16), 0xf800),
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 13), 0x07e0)),
+        wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 11), 0x001f));
+}
+
+static inline wii_swizzle_vec wii_swizzle_vec_pack_rgb5a3(wii_swizzle_vec t) {
+    wii_swizzle_vec a = wii_swizzle_vec_and(t, 0xe0);
+    wii_swizzle_vec mask = wii_swizzle_vec_eq(a, 0xe0);
+    wii_swizzle_vec opaque = wii_swizzle_vec_or(
+        wii_swizzle_vec_or(
+            wii_swizzle_vec_and(mask, 0x8000),
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 17), 0x7c00)),
+        wii_swizzle_vec_or(
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 14), 0x03e0),
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 11), 0x001f)));
+    wii_swizzle_vec translucent = wii_swizzle_vec_or(
+        wii_swizzle_vec_or(
+            WII_SWIZZLE_VEC_SLL(a, 7),
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 20), 0x0f00)),
+        wii_swizzle_vec_or(
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 16), 0x00f0),
+            wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(t, 12), 0x000f)));
+    return wii_swizzle_vec_select(mask, opaque, translucent);
+}
+
+/**
+ * 16-bit texture with 4x4 tiles, a tile row packed by the specified vector
+ * function and byte swapped into the GPU (big-endian) order
+ */
+template <wii_swizzle_vec (*Pack)(wii_swizzle_vec)> struct SwizzleTexel16Vec {
+    enum { TILE_W = 4, TILE_H = 4, TILE_BYTES = 32 };
+    static inline void writeRow(u8* tile, int row, const u32* t) {
+        wii_swizzle_vec v = Pack(wii_swizzle_vec_load(t));
+        wii_swizzle_vec_store16(
+            tile + (row << 3),
+            wii_swizzle_vec_or(
+                wii_swizzle_vec_and(WII_SWIZZLE_VEC_SRL(v, 8), 0x00ff),
+                wii_swizzle_vec_and(WII_SWIZZLE_VEC_SLL(v, 8), 0xff00)));
+    }
+};
+#endif
+
+typedef SwizzleTexel8<wii_swizzle_pack_i8> SwizzleI8;
+typedef SwizzleTexel8<wii_swizzle_pack_ia4> SwizzleIA4;
+#ifdef WII_SWIZZLE_SIMD
+typedef SwizzleTexel16Vec<wii_swizzle_vec_pack_ia8> SwizzleIA8;
+typedef SwizzleTexel16Vec<wii_swizzle_vec_pack_rgb565> SwizzleRGB565;
+typedef SwizzleTexel16Vec<wii_swizzle_vec_pack_rgb5a3> SwizzleRGB5A3;
+#else
+typedef SwizzleTexel16<wii_swizzle_pack_ia8> SwizzleIA8;
+typedef SwizzleTexel16<wii_swizzle_pack_rgb565> SwizzleRGB565;
+typedef SwizzleTexel16<wii_swizzle_pack_rgb5a3> SwizzleRGB5A3;
+#endif
+
+/**
+ * Converts a rectangle of the source into a region of a tiled texture. The
+ * texture format, the source pixel format and the source row layout are
+ * template policies, so each combination compiles to its own loop with the
+ * tile row writes unrolled. Tiles that lie within the rectangle are converted
+ * a whole tile per iteration.
+ *
+ * @param   rows The source row layout (row 0 is the first row of the rect)
+ * @param   pixel The source pixel format
+ * @param   srcX The first source column of the rectangle
+ * @param   width The width of the rectangle
+ * @param   height The height of the rectangle
+ * @param   dst The texture
+ * @param   dstWidth The width of the texture (a multiple of the tile width)
+ * @param   dstX The tile aligned column the rectangle is written to
+ * @param   dstY The tile aligned row the rectangle is written to
+ */
+template <class Texture, class Pixel, class Rows>
+void wii_swizzle(const Rows& rows, const Pixel& pixel, u16 srcX, u16 width,
+                 u16 height, void* dst, u16 dstWidth, u16 dstX, u16 dstY) {
+    const int tw = Texture::TILE_W;
+    const int th = Texture::TILE_H;
+    const u32 tileRowBytes = (dstWidth / tw) * Texture::TILE_BYTES;
+    u8* tileRow = (u8*)dst + (dstY / th) * tileRowBytes +
+                  (dstX / tw) * Texture::TILE_BYTES;
+    u32 texels[tw * th];
+
+    for (int ty = 0; ty < height; ty += th, tileRow += tileRowBytes) {
+        u8* tile = tileRow;
+        const bool fullRows = (ty + th) <= height;
+        for (int tx = 0; tx < width; tx += tw, tile += Texture::TILE_BYTES) {
+            const int cols = (width - tx) < tw ? (width - tx) : tw;
+            if (fullRows && cols == tw) {
+                // The tile lies within the rectangle, load all of its texels
+                // without bounds checks and write it in one go
+                u32* t = texels;
+                for (int r = 0; r < th; r++) {
+                    const u8* p =
+                        rows.row(ty + r) + (srcX + tx) * Pixel::BYTES;
+                    for (int i = 0; i < tw; i++, p += Pixel::BYTES) {
+                        *t++ = pixel.read(p);
+                    }
+                }
+                for (int r = 0; r < th; r++) {
+                    Texture::writeRow(tile, r, texels + r * tw);
+                }
+                continue;
+            }
+
+            // Partially covered tile, clear the texels outside of the rect
+            for (int r = 0; r < th; r++) {
+                int i = 0;
+                if (ty + r < height) {
+                    const u8* p =
+                        rows.row(ty + r) + (srcX + tx) * Pixel::BYTES;
+                    for (; i < cols; i++, p += Pixel::BYTES) {
+                        texels[i] = pixel.read(p);
+                    }
+                }
+                for (; i < tw; i++) {
+                    texels[i] = 0;
+                }
+                Texture::writeRow(tile, r, texels);
+            }
+        }
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wiicolem]                                            //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#ifndef WII_TRIPLE_BUFFER_H
+#define WII_TRIPLE_BUFFER_H
+
+#include <gctypes.h>
+
+/**
+ * Lock-free exchange of three buffers between a producer and a consumer
+ * thread. The producer always has a buffer to draw into, the consumer always
+ * takes the newest completed buffer. Each side exchanges its buffer with the
+ * middle buffer through a single atomic swap, neither side ever blocks.
+ */
+typedef struct wii_triple_buffer {
+    /** The index of the buffer the producer draws into (producer only) */
+    u32 back;
+    /** The index of the buffer the consumer reads (consumer only) */
+    u32 front;
+    /** The index of the middle buffer and whether it holds a new frame */
+    volatile u32 middle;
+} wii_triple_buffer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initializes the exchange. The producer starts with buffer 0, the consumer
+ * with buffer 2.
+ *
+ * @param   tb The exchange
+ */
+void wii_triple_buffer_init(wii_triple_buffer* tb);
+
+/**
+ * Publishes the buffer drawn by the producer as the newest frame (called by
+ * the producer)
+ *
+ * @param   tb The exchange
+ * @return  The index of the buffer the producer draws into next
+ */
+u32 wii_triple_buffer_publish(wii_triple_buffer* tb);
+
+/**
+ * Takes the newest frame published by the producer, if any (called by the
+ * consumer). The index of the frame is available in the front member.
+ *
+ * @param   tb The exchange
+ * @return  Whether a new frame was taken
+ */
+BOOL wii_triple_buffer_acquire(wii_triple_buffer* tb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
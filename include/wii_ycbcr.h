@@ -0,0 +1,205 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#ifndef WII_YCBCR_H
+#define WII_YCBCR_H
+
+#include <gctypes.h>
+
+/*
+ * Conversions between RGB8 and the Y1CbY2Cr pairs of the external frame
+ * buffer. Coefficients are 16.16 fixed point, so each component is a few
+ * multiplies and a shift. Defining WII_YCBCR_LUT when building wii_ycbcr.cpp
+ * makes the row and image conversions use 256 entry per channel tables
+ * instead of the multiplies.
+ */
+
+/** Fixed point shift of the coefficients */
+#define WII_YCBCR_SHIFT 16
+/** Offset of the chroma components (128), plus rounding */
+#define WII_YCBCR_CHROMA_BIAS ((128 << WII_YCBCR_SHIFT) + 0x7fff)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Returns the luma of the specified color
+ *
+ * @param   r Red
+ * @param   g Green
+ * @param   b Blue
+ * @return  The luma (Y)
+ */
+static inline int wii_ycbcr_y(int r, int g, int b) {
+    return (19595 * r + 38470 * g + 7471 * b + 0x7fff) >> WII_YCBCR_SHIFT;
+}
+
+/**
+ * Returns the blue difference chroma of the specified color
+ *
+ * @param   r Red
+ * @param   g Green
+ * @param   b Blue
+ * @return  The blue difference chroma (Cb)
+ */
+static inline int wii_ycbcr_cb(int r, int g, int b) {
+    return (-11059 * r - 21709 * g + 32768 * b + WII_YCBCR_CHROMA_BIAS) >>
+           WII_YCBCR_SHIFT;
+}
+
+/**
+ * Returns the red difference chroma of the specified color
+ *
+ * @param   r Red
+ * @param   g Green
+ * @param   b Blue
+ * @return  The red difference chroma (Cr)
+ */
+static inline int wii_ycbcr_cr(int r, int g, int b) {
+    return (32768 * r - 27439 * g - 5329 * b + WII_YCBCR_CHROMA_BIAS) >>
+           WII_YCBCR_SHIFT;
+}
+
+/**
+ * Clamps the specified value to a color component
+ *
+ * @param   v The value
+ * @return  The value clamped to 0-255
+ */
+static inline u8 wii_ycbcr_clamp(int v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+/**
+ * Converts two RGB pixels to a Y1CbY2Cr pair (the chroma is the average of
+ * both pixels)
+ *
+ * @param   r1 Red of the first pixel
+ * @param   g1 Green of the first pixel
+ * @param   b1 Blue of the first pixel
+ * @param   r2 Red of the second pixel
+ * @param   g2 Green of the second pixel
+ * @param   b2 Blue of the second pixel
+ * @return  The pair in Y1CbY2Cr format
+ */
+static inline u32 wii_ycbcr_from_rgb(int r1, int g1, int b1,
+                                     int r2, int g2, int b2) {
+    int r = r1 + r2, g = g1 + g2, b = b1 + b2;
+    return (wii_ycbcr_y(r1, g1, b1) << 24) |
+           (((-11059 * r - 21709 * g + 32768 * b + (WII_YCBCR_CHROMA_BIAS << 1))
+             >> (WII_YCBCR_SHIFT + 1)) << 16) |
+           (wii_ycbcr_y(r2, g2, b2) << 8) |
+           ((32768 * r - 27439 * g - 5329 * b + (WII_YCBCR_CHROMA_BIAS << 1))
+            >> (WII_YCBCR_SHIFT + 1));
+}
+
+/**
+ * Converts a single RGB color to a Y1CbY2Cr pair (both pixels of the pair
+ * have the color)
+ *
+ * @param   r Red
+ * @param   g Green
+ * @param   b Blue
+ * @return  The color in Y1CbY2Cr format
+ */
+static inline u32 wii_ycbcr_from_color(int r, int g, int b) {
+    u32 y = wii_ycbcr_y(r, g, b);
+    return (y << 24) | (wii_ycbcr_cb(r, g, b) << 16) | (y << 8) |
+           wii_ycbcr_cr(r, g, b);
+}
+
+/**
+ * Converts a Y1CbY2Cr pair to two RGB pixels
+ *
+ * @param   ycbycr The pair in Y1CbY2Cr format
+ * @param   rgb The two pixels (R, G, B bytes)
+ */
+static inline void wii_ycbcr_to_rgb(u32 ycbycr, u8* rgb) {
+    int y1 = ycbycr >> 24, y2 = (ycbycr >> 8) & 0xff;
+    int cb = ((ycbycr >> 16) & 0xff) - 128, cr = (ycbycr & 0xff) - 128;
+    int r = (91881 * cr + 0x8000) >> WII_YCBCR_SHIFT;
+    int g = (-22554 * cb - 46802 * cr + 0x8000) >> WII_YCBCR_SHIFT;
+    int b = (116130 * cb + 0x8000) >> WII_YCBCR_SHIFT;
+
+    rgb[0] = wii_ycbcr_clamp(y1 + r);
+    rgb[1] = wii_ycbcr_clamp(y1 + g);
+    rgb[2] = wii_ycbcr_clamp(y1 + b);
+    rgb[3] = wii_ycbcr_clamp(y2 + r);
+    rgb[4] = wii_ycbcr_clamp(y2 + g);
+    rgb[5] = wii_ycbcr_clamp(y2 + b);
+}
+
+/**
+ * Converts a row of RGB pixels to Y1CbY2Cr pairs
+ *
+ * @param   src The pixels (R, G, B bytes)
+ * @param   dst The pairs
+ * @param   width The count of pixels (must be even)
+ */
+void wii_ycbcr_from_rgb8_row(const u8* src, u32* dst, int width);
+
+/**
+ * Converts a row of Y1CbY2Cr pairs to RGB pixels
+ *
+ * @param   src The pairs
+ * @param   dst The pixels (R, G, B bytes)
+ * @param   width The count of pixels (must be even)
+ */
+void wii_ycbcr_to_rgb8_row(const u32* src, u8* dst, int width);
+
+/**
+ * Converts an RGB image to Y1CbY2Cr pairs
+ *
+ * @param   src The image (R, G, B bytes)
+ * @param   srcPitch The distance between the image rows in bytes
+ * @param   dst The pairs
+ * @param   dstPitch The distance between the pair rows in pairs
+ * @param   width The width of the image (must be even)
+ * @param   height The height of the image
+ */
+void wii_ycbcr_from_rgb8(const u8* src, int srcPitch, u32* dst, int dstPitch,
+                         int width, int height);
+
+/**
+ * Converts Y1CbY2Cr pairs to an RGB image
+ *
+ * @param   src The pairs
+ * @param   srcPitch The distance between the pair rows in pairs
+ * @param   dst The image (R, G, B bytes)
+ * @param   dstPitch The distance between the image rows in bytes
+ * @param   width The width of the image (must be even)
+ * @param   height The height of the image
+ */
+void wii_ycbcr_to_rgb8(const u32* src, int srcPitch, u8* dst, int dstPitch,
+                       int width, int height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -124,6 +124,18 @@ void PNGU_ReleaseImageContext(IMGCTX ctx);
 // format, background and transparency colors.
 int PNGU_GetImageProperties(IMGCTX ctx, PNGUPROP* fileproperties);
 
+// Retrieves the image dimensions, bit depth and color type of a PNG file,
+// previosly loaded into a buffer, from its signature and IHDR chunk alone,
+// without an image context or libpng. Background and transparency colors are
+// not filled in.
+int PNGU_ProbeImageFromBuffer(const void* buffer, PNGUPROP* fileproperties);
+
+// Retrieves the image dimensions, bit depth and color type of a PNG file, from
+// any devoptab device, with a single read of its first 33 bytes (signature and
+// IHDR chunk), without an image context or libpng. Background and
+// transparency colors are not filled in.
+int PNGU_ProbeImageFromDevice(const char* filename, PNGUPROP* fileproperties);
+
 /****************************************************************************
  *							 Image conversion								*
  ****************************************************************************/
@@ -184,6 +196,25 @@ int PNGU_DecodeToRGBA8(IMGCTX ctx,
         ((void*)buffer) + (coordY) * (bufferWidth)*2 + (coordX)*2,            \
         (bufferWidth) - (imgWidth), default_alpha)
 
+// Picks the smallest GX texture format that holds the selected image without
+// loss of color or alpha: I8 for gray images, IA8 for gray images with alpha,
+// RGB565 for opaque color images (if allowed) and RGBA8 otherwise. Indexed
+// images are classified by the colors and transparency of their palette.
+int PNGU_GetTextureFormat(IMGCTX ctx, PNGU_u32 allowRGB565, PNGU_u8* format);
+
+// Expands selected image into a tiled buffer of the specified GX texture format
+// (GX_TF_I8, GX_TF_IA8, GX_TF_RGB565, GX_TF_RGB5A3 or GX_TF_RGBA8). Color images
+// are converted to gray for the intensity formats. You need to specify
+// context, image dimensions, destination address, texture format and default
+// alpha value, which is used if the source image doesn't have an alpha channel.
+// The width must be a multiple of eight for GX_TF_I8.
+int PNGU_DecodeTo4x4(IMGCTX ctx,
+                     PNGU_u32 width,
+                     PNGU_u32 height,
+                     void* buffer,
+                     PNGU_u8 format,
+                     PNGU_u8 default_alpha);
+
 // Expands selected image into a 4x4 tiled RGB565 buffer. You need to specify
 // context, image dimensions and destination address.
 int PNGU_DecodeTo4x4RGB565(IMGCTX ctx,
@@ -209,6 +240,51 @@ int PNGU_DecodeTo4x4RGBA8(IMGCTX ctx,
                           void* buffer,
                           PNGU_u8 default_alpha);
 
+// Expands selected image into a tiled buffer of the specified GX texture format
+// and destination size, box filtering it down while decoding. The destination
+// dimensions must be multiples of the format's tile size and no larger than the
+// image.
+int PNGU_DecodeTo4x4Scaled(IMGCTX ctx,
+                           PNGU_u32 width,
+                           PNGU_u32 height,
+                           void* buffer,
+                           PNGU_u32 dstWidth,
+                           PNGU_u32 dstHeight,
+                           PNGU_u8 format,
+                           PNGU_u8 default_alpha);
+
+// Expands selected image into a 4x4 tiled RGB565 buffer of the specified
+// destination size, box filtering it down while decoding. The destination
+// dimensions must be multiples of four and no larger than the image.
+int PNGU_DecodeTo4x4RGB565Scaled(IMGCTX ctx,
+                                 PNGU_u32 width,
+                                 PNGU_u32 height,
+                                 void* buffer,
+                                 PNGU_u32 dstWidth,
+                                 PNGU_u32 dstHeight);
+
+// Expands selected image into a 4x4 tiled RGB5A3 buffer of the specified
+// destination size, box filtering it down while decoding. The destination
+// dimensions must be multiples of four and no larger than the image.
+int PNGU_DecodeTo4x4RGB5A3Scaled(IMGCTX ctx,
+                                 PNGU_u32 width,
+                                 PNGU_u32 height,
+                                 void* buffer,
+                                 PNGU_u32 dstWidth,
+                                 PNGU_u32 dstHeight,
+                                 PNGU_u8 default_alpha);
+
+// Expands selected image into a 4x4 tiled RGBA8 buffer of the specified
+// destination size, box filtering it down while decoding. The destination
+// dimensions must be multiples of four and no larger than the image.
+int PNGU_DecodeTo4x4RGBA8Scaled(IMGCTX ctx,
+                                PNGU_u32 width,
+                                PNGU_u32 height,
+                                void* buffer,
+                                PNGU_u32 dstWidth,
+                                PNGU_u32 dstHeight,
+                                PNGU_u8 default_alpha);
+
 // Encodes an YCbYCr image in PNG format and stores it in the selected device or
 // memory buffer. You need to specify context, image dimensions, destination
 // address and stride in pixels (stride = buffer width - image width).
@@ -223,12 +299,73 @@ int PNGU_EncodeFromRGB(IMGCTX ctx,
                        PNGU_u32 height,
                        void* buffer,
                        PNGU_u32 stride);
+
+// Encodes a tiled RGBA8 GX texture in PNG format and stores it in the selected
+// device or memory buffer (alpha is dropped). The stride is ignored.
 int PNGU_EncodeFromGXTexture(IMGCTX ctx,
                              PNGU_u32 width,
                              PNGU_u32 height,
                              void* buffer,
                              PNGU_u32 stride);
 
+// Encodes a tiled GX texture of the specified format (GX_TF_RGBA8 or
+// GX_TF_RGB565) in PNG format and stores it in the selected device or memory
+// buffer. The image can have any width and height, the texture is padded to
+// whole tiles. Rows are converted a band of tiles at a time and streamed to
+// libpng, so no full frame copy is made.
+int PNGU_EncodeFromGXTextureFormat(IMGCTX ctx,
+                                   PNGU_u32 width,
+                                   PNGU_u32 height,
+                                   void* buffer,
+                                   PNGU_u8 format);
+
+// Source formats of asynchronous encodes
+#define PNGU_ENCODE_YCbYCr 0     // As PNGU_EncodeFromYCbYCr
+#define PNGU_ENCODE_RGB 1        // As PNGU_EncodeFromRGB
+#define PNGU_ENCODE_GXTEXTURE 2  // As PNGU_EncodeFromGXTexture
+
+// Called from the encode thread when an asynchronous encode has finished, with
+// the result of the encode (PNGU_OK on success), the file name and the user
+// data passed to PNGU_EncodeToDeviceAsync.
+typedef void (*PNGU_EncodeCallback)(int result,
+                                    const char* filename,
+                                    void* data);
+
+// Sets the compression options of all following encodes: the zlib level (0-9),
+// the zlib strategy (Z_*) and the PNG row filters (mask of PNG_FILTER_*).
+// Negative values (and 0 for the filters) select the libpng defaults. Until
+// this is called, synchronous encodes use the libpng defaults and asynchronous
+// encodes options tuned for speed (level 1, Z_RLE and PNG_FILTER_SUB).
+void PNGU_SetEncodeOptions(int level, int strategy, int filters);
+
+// Queues an image to be encoded in PNG format and written to the specified
+// file, from any devoptab device, by a background thread. The source image,
+// in one of the PNGU_ENCODE_* formats, is copied, so the buffer can be reused
+// as soon as this function returns (it only blocks while the queue is full).
+// The callback (if not NULL) is invoked when the encode has finished.
+int PNGU_EncodeToDeviceAsync(const char* filename,
+                             PNGU_u32 format,
+                             PNGU_u32 width,
+                             PNGU_u32 height,
+                             const void* buffer,
+                             PNGU_u32 stride,
+                             PNGU_EncodeCallback callback,
+                             void* data);
+
+// Waits until all queued asynchronous encodes have finished.
+void PNGU_WaitEncodes(void);
+
+// Waits until all queued asynchronous encodes have finished and frees the
+// buffers the source images are copied into, as well as the band buffers (see
+// PNGU_ReleaseBandBuffers). They are allocated again by the next
+// PNGU_EncodeToDeviceAsync.
+void PNGU_ReleaseEncodeBuffers(void);
+
+// Frees the band buffers that decodes and encodes share between image
+// contexts. They are allocated again by the next decode or encode (buffers in
+// use by a running decode or encode are returned to the pool afterwards).
+void PNGU_ReleaseBandBuffers(void);
+
 // Macro for encoding an image stored into an YCbYCr buffer at given
 // coordinates.
 #define PNGU_ENCODE_TO_COORDS_YCbYCr(ctx, coordX, coordY, imgWidth, imgHeight, \
@@ -12,23 +12,63 @@ Modified by Tantric, 2009
 #include <stdio.h>
 #include <malloc.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <gccore.h>
 #include "pngu.h"
 #include "png.h"
+#include "zlib.h"
+#include "wii_swizzle.h"
+#include "wii_ycbcr.h"
 
 
 // Constants
 #define PNGU_SOURCE_BUFFER			1
 #define PNGU_SOURCE_DEVICE			2
 
+// Size of the PNG signature and IHDR chunk at the start of every PNG file
+#define PNGU_PROBE_SIZE				33
+
+// Asynchronous encoding
+#define PNGU_ENCODE_QUEUE_SIZE		4
+#define PNGU_ENCODE_STACK_SIZE		(64 * 1024)
+#define PNGU_ENCODE_PRIORITY		40
+
+// Compression options of asynchronous encodes, tuned for speed: fast deflate
+// of run lengths on top of the cheap SUB filter
+#define PNGU_ENCODE_ASYNC_LEVEL		1
+#define PNGU_ENCODE_ASYNC_STRATEGY	Z_RLE
+#define PNGU_ENCODE_ASYNC_FILTERS	PNG_FILTER_SUB
+
+// States of the encode worker
+#define PNGU_ENCODE_STOPPED			0
+#define PNGU_ENCODE_STARTING		1
+#define PNGU_ENCODE_RUNNING			2
+
+// Band buffers kept for later decodes and encodes (one for the caller and one
+// for the encode worker)
+#define PNGU_BAND_POOL_SIZE			2
+
  
 // Prototypes of helper functions
 int pngu_info (IMGCTX ctx);
 int pngu_decode (IMGCTX ctx, PNGU_u32 width, PNGU_u32 height, PNGU_u32 stripAlpha);
+int pngu_decode_setup (IMGCTX ctx, PNGU_u32 width, PNGU_u32 height, PNGU_u32 stripAlpha);
+png_uint_32 pngu_rowbytes (IMGCTX ctx);
+int pngu_read_image (IMGCTX ctx);
+int pngu_decode_4x4 (IMGCTX ctx, PNGU_u32 width, PNGU_u32 height, void* buffer, PNGU_u8 format, PNGU_u8 default_alpha);
+int pngu_decode_4x4_scaled (IMGCTX ctx, PNGU_u32 width, PNGU_u32 height, void* buffer, PNGU_u32 dstWidth, PNGU_u32 dstHeight, PNGU_u8 format, PNGU_u8 default_alpha);
 void pngu_free_info (IMGCTX ctx);
 void pngu_read_data_from_buffer (png_structp png_ptr, png_bytep data, png_size_t length);
 void pngu_write_data_to_buffer (png_structp png_ptr, png_bytep data, png_size_t length);
 void pngu_flush_data_to_buffer (png_structp png_ptr);
-int pngu_clamp (int value, int min, int max);
+PNGU_u32 pngu_color_type (int color_type);
+int pngu_probe (const PNGU_u8* header, PNGUPROP* imgprop);
+void pngu_set_compression (IMGCTX ctx);
+int pngu_encode_start (void);
+void* pngu_encode_worker (void* arg);
+png_bytep pngu_band_acquire (PNGU_u32 size, PNGU_u32* capacity);
+void pngu_band_release (png_bytep band, PNGU_u32 capacity);
 
 // PNGU Image context struct
 struct _IMGCTX {
@@ -49,6 +89,62 @@ struct _IMGCTX {
     png_bytep img_data;
 };
 
+// State of a decode into the tiles of a GX texture
+typedef struct {
+    int layout;            // Layout of the rows passed to the swizzler
+    int bytes;             // Bytes per pixel of the rows passed to the swizzler
+    int interlaced;        // Non zero if the image was decoded in full
+    int indexed;           // Non zero if rows are expanded through the palette
+    PNGU_u32 rowbytes;     // Size of a row buffer
+    png_bytep row;         // Row of palette indices read from libpng
+    PNGU_u8 lut[256][4];   // Palette in the layout of the swizzled rows
+} pngu_tiled;
+
+// Prototypes of the tiled decode helpers
+int pngu_tiled_setup (IMGCTX ctx, PNGU_u32 width, PNGU_u32 height, PNGU_u8 format, PNGU_u8 default_alpha, pngu_tiled* t);
+png_bytep pngu_tiled_row (IMGCTX ctx, pngu_tiled* t, PNGU_u32 y, png_bytep buffer);
+void pngu_tiled_free (IMGCTX ctx, pngu_tiled* t);
+void pngu_build_lut (IMGCTX ctx, pngu_tiled* t, PNGU_u32 stripAlpha, PNGU_u8 default_alpha);
+
+// Queued asynchronous encode, the source image is copied into the slot's
+// buffer which is kept for later jobs
+typedef struct {
+    char* filename;
+    PNGU_u32 format;
+    PNGU_u32 width;
+    PNGU_u32 height;
+    PNGU_u32 stride;
+    void* buffer;
+    PNGU_u32 size;   // Size of the buffer
+    PNGU_EncodeCallback callback;
+    void* data;
+} pngu_encode_job;
+
+// Compression options set by PNGU_SetEncodeOptions (negative for the libpng
+// defaults), until then synchronous encodes use the libpng defaults and
+// asynchronous encodes the PNGU_ENCODE_ASYNC_* options
+static int pngu_encode_options_set = 0;
+static int pngu_encode_level = -1;
+static int pngu_encode_strategy = -1;
+static int pngu_encode_filters = 0;
+
+// Encode queue, guarded by the mutex and drained by the worker thread
+static pngu_encode_job pngu_encode_queue[PNGU_ENCODE_QUEUE_SIZE];
+static int pngu_encode_head = 0;
+static int pngu_encode_count = 0;
+static mutex_t pngu_encode_mutex = LWP_MUTEX_NULL;
+static cond_t pngu_encode_cond = LWP_COND_NULL;
+static lwp_t pngu_encode_thread = LWP_THREAD_NULL;
+static volatile int pngu_encode_state = PNGU_ENCODE_STOPPED;
+
+// Band buffers shared by all contexts, an entry is empty while its buffer is
+// in use
+typedef struct {
+    png_bytep buffer;
+    PNGU_u32 size;
+} pngu_band;
+static pngu_band pngu_band_pool[PNGU_BAND_POOL_SIZE];
+
 // PNGU Implementation //
 
 IMGCTX PNGU_SelectImageFromBuffer(const void* buffer) {
@@ -133,7 +229,7 @@ int PNGU_DecodeToYCbYCr(IMGCTX ctx,
                         void* buffer,
                         PNGU_u32 stride) {
     int result;
-    PNGU_u32 x, y, buffWidth;
+    PNGU_u32 y, buffWidth;
 
     // width needs to be divisible by two
     if (width % 2)
@@ -150,14 +246,8 @@ int PNGU_DecodeToYCbYCr(IMGCTX ctx,
     // Copy image to the output buffer
     buffWidth = (width + stride) / 2;
     for (y = 0; y < height; y++)
-        for (x = 0; x < (width / 2); x++)
-            ((PNGU_u32*)buffer)[y * buffWidth + x] =
-                PNGU_RGB8_TO_YCbYCr(*(ctx->row_pointers[y] + x * 6),
-                                    *(ctx->row_pointers[y] + x * 6 + 1),
-                                    *(ctx->row_pointers[y] + x * 6 + 2),
-                                    *(ctx->row_pointers[y] + x * 6 + 3),
-                                    *(ctx->row_pointers[y] + x * 6 + 4),
-                                    *(ctx->row_pointers[y] + x * 6 + 5));
+        wii_ycbcr_from_rgb8_row(ctx->row_pointers[y],
+                                (PNGU_u32*)buffer + y * buffWidth, width);
 
     // Free resources
     free(ctx->img_data);
@@ -238,549 +328,112 @@ int PNGU_DecodeToRGBA8(IMGCTX ctx,
     return PNGU_OK;
 }
 
-int PNGU_DecodeTo4x4RGB565(IMGCTX ctx,
-                           PNGU_u32 width,
-                           PNGU_u32 height,
-                           void* buffer) {
-    int result;
-    PNGU_u32 x, y, qwidth, qheight;
+int PNGU_ProbeImageFromBuffer(const void* buffer, PNGUPROP* imgprop) {
+    if (!buffer)
+        return PNGU_NO_FILE_SELECTED;
 
-    // width and height need to be divisible by four
-    if ((width % 4) || (height % 4))
-        return PNGU_INVALID_WIDTH_OR_HEIGHT;
+    return pngu_probe(buffer, imgprop);
+}
 
-    result = pngu_decode(ctx, width, height, 1);
-    if (result != PNGU_OK)
-        return result;
+int PNGU_ProbeImageFromDevice(const char* filename, PNGUPROP* imgprop) {
+    PNGU_u8 header[PNGU_PROBE_SIZE];
+    int fd, len;
 
-    // Copy image to the output buffer
-    qwidth = width / 4;
-    qheight = height / 4;
-
-    for (y = 0; y < qheight; y++)
-        for (x = 0; x < qwidth; x++) {
-            int blockbase = (y * qwidth + x) * 4;
-
-            PNGU_u64 field64 =
-                *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 12));
-            PNGU_u64 field32 =
-                (PNGU_u64) *
-                ((PNGU_u32*)(ctx->row_pointers[y * 4] + x * 12 + 8));
-            ((PNGU_u64*)buffer)[blockbase] =
-                (((field64 & 0xF800000000000000ULL) |
-                  ((field64 & 0xFC000000000000ULL) << 3) |
-                  ((field64 & 0xF80000000000ULL) << 5)) |
-                 (((field64 & 0xF800000000ULL) << 8) |
-                  ((field64 & 0xFC000000ULL) << 11) |
-                  ((field64 & 0xF80000ULL) << 13)) |
-                 (((field64 & 0xF800ULL) << 16) | ((field64 & 0xFCULL) << 19) |
-                  ((field32 & 0xF8000000ULL) >> 11)) |
-                 (((field32 & 0xF80000ULL) >> 8) |
-                  ((field32 & 0xFC00ULL) >> 5) | ((field32 & 0xF8ULL) >> 3)));
-
-            field64 = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 12));
-            field32 = (PNGU_u64) *
-                      ((PNGU_u32*)(ctx->row_pointers[y * 4 + 1] + x * 12 + 8));
-            ((PNGU_u64*)buffer)[blockbase + 1] =
-                (((field64 & 0xF800000000000000ULL) |
-                  ((field64 & 0xFC000000000000ULL) << 3) |
-                  ((field64 & 0xF80000000000ULL) << 5)) |
-                 (((field64 & 0xF800000000ULL) << 8) |
-                  ((field64 & 0xFC000000ULL) << 11) |
-                  ((field64 & 0xF80000ULL) << 13)) |
-                 (((field64 & 0xF800ULL) << 16) | ((field64 & 0xFCULL) << 19) |
-                  ((field32 & 0xF8000000ULL) >> 11)) |
-                 (((field32 & 0xF80000ULL) >> 8) |
-                  ((field32 & 0xFC00ULL) >> 5) | ((field32 & 0xF8ULL) >> 3)));
-
-            field64 = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 12));
-            field32 = (PNGU_u64) *
-                      ((PNGU_u32*)(ctx->row_pointers[y * 4 + 2] + x * 12 + 8));
-            ((PNGU_u64*)buffer)[blockbase + 2] =
-                (((field64 & 0xF800000000000000ULL) |
-                  ((field64 & 0xFC000000000000ULL) << 3) |
-                  ((field64 & 0xF80000000000ULL) << 5)) |
-                 (((field64 & 0xF800000000ULL) << 8) |
-                  ((field64 & 0xFC000000ULL) << 11) |
-                  ((field64 & 0xF80000ULL) << 13)) |
-                 (((field64 & 0xF800ULL) << 16) | ((field64 & 0xFCULL) << 19) |
-                  ((field32 & 0xF8000000ULL) >> 11)) |
-                 (((field32 & 0xF80000ULL) >> 8) |
-                  ((field32 & 0xFC00ULL) >> 5) | ((field32 & 0xF8ULL) >> 3)));
-
-            field64 = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 12));
-            field32 = (PNGU_u64) *
-                      ((PNGU_u32*)(ctx->row_pointers[y * 4 + 3] + x * 12 + 8));
-            ((PNGU_u64*)buffer)[blockbase + 3] =
-                (((field64 & 0xF800000000000000ULL) |
-                  ((field64 & 0xFC000000000000ULL) << 3) |
-                  ((field64 & 0xF80000000000ULL) << 5)) |
-                 (((field64 & 0xF800000000ULL) << 8) |
-                  ((field64 & 0xFC000000ULL) << 11) |
-                  ((field64 & 0xF80000ULL) << 13)) |
-                 (((field64 & 0xF800ULL) << 16) | ((field64 & 0xFCULL) << 19) |
-                  ((field32 & 0xF8000000ULL) >> 11)) |
-                 (((field32 & 0xF80000ULL) >> 8) |
-                  ((field32 & 0xFC00ULL) >> 5) | ((field32 & 0xF8ULL) >> 3)));
-        }
+    if (!filename)
+        return PNGU_NO_FILE_SELECTED;
 
-    // Free resources
-    free(ctx->img_data);
-    free(ctx->row_pointers);
+    // Read the signature and IHDR chunk with a single small read, avoiding
+    // the stdio buffer
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return PNGU_CANT_OPEN_FILE;
+    len = read(fd, header, PNGU_PROBE_SIZE);
+    close(fd);
 
-    // Success
-    return PNGU_OK;
+    if (len != PNGU_PROBE_SIZE)
+        return PNGU_CANT_READ_FILE;
+
+    return pngu_probe(header, imgprop);
 }
 
-int PNGU_DecodeTo4x4RGB5A3(IMGCTX ctx,
-                           PNGU_u32 width,
-                           PNGU_u32 height,
-                           void* buffer,
-                           PNGU_u8 default_alpha) {
-    int result;
-    PNGU_u32 x, y, qwidth, qheight;
-    PNGU_u64 alphaMask;
+int PNGU_GetTextureFormat(IMGCTX ctx, PNGU_u32 allowRGB565, PNGU_u8* format) {
+    png_colorp palette;
+    png_bytep trans;
+    png_color_16p trans_values;
+    int num_palette = 0, num_trans = 0, gray = 1, alpha = 0, i;
 
-    // width and height need to be divisible by four
-    if ((width % 4) || (height % 4))
-        return PNGU_INVALID_WIDTH_OR_HEIGHT;
+    // Read info if it hasn't been read before
+    if (!ctx->infoRead) {
+        i = pngu_info(ctx);
+        if (i != PNGU_OK)
+            return i;
+    }
 
-    result = pngu_decode(ctx, width, height, 0);
-    if (result != PNGU_OK)
-        return result;
+    switch (ctx->prop.imgColorType) {
+        case PNGU_COLOR_TYPE_GRAY:
+            *format = GX_TF_I8;
+            break;
+        case PNGU_COLOR_TYPE_GRAY_ALPHA:
+            *format = GX_TF_IA8;
+            break;
+        case PNGU_COLOR_TYPE_RGB:
+            *format = allowRGB565 ? GX_TF_RGB565 : GX_TF_RGBA8;
+            break;
+        case PNGU_COLOR_TYPE_RGB_ALPHA:
+            *format = GX_TF_RGBA8;
+            break;
+        case PNGU_COLOR_TYPE_PALETTE:
+            // Look for colors and translucent entries in the palette
+            if (!png_get_PLTE(ctx->png_ptr, ctx->info_ptr, &palette,
+                              &num_palette))
+                return PNGU_UNSUPPORTED_COLOR_TYPE;
+            for (i = 0; i < num_palette; i++)
+                if ((palette[i].red != palette[i].green) ||
+                    (palette[i].green != palette[i].blue))
+                    gray = 0;
+            if (png_get_tRNS(ctx->png_ptr, ctx->info_ptr, &trans, &num_trans,
+                             &trans_values))
+                for (i = 0; i < num_trans; i++)
+                    if (trans[i] != 0xFF)
+                        alpha = 1;
+
+            if (gray)
+                *format = alpha ? GX_TF_IA8 : GX_TF_I8;
+            else if (!alpha && allowRGB565)
+                *format = GX_TF_RGB565;
+            else
+                *format = GX_TF_RGBA8;
+            break;
+        default:
+            return PNGU_UNSUPPORTED_COLOR_TYPE;
+    }
 
-    // Init some vars
-    qwidth = width / 4;
-    qheight = height / 4;
+    return PNGU_OK;
+}
 
-    // Check is source image has an alpha channel
-    if ((ctx->prop.imgColorType == PNGU_COLOR_TYPE_GRAY_ALPHA) ||
-        (ctx->prop.imgColorType == PNGU_COLOR_TYPE_RGB_ALPHA)) {
-        // Alpha channel present, copy image to the output buffer
-        for (y = 0; y < qheight; y++)
-            for (x = 0; x < qwidth; x++) {
-                int blockbase = (y * qwidth + x) * 4;
-                PNGU_u64 tmp;
-
-                PNGU_u64 fieldA =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 16));
-                PNGU_u64 fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 16 + 8));
-                // If first pixel is opaque set MSB to 1 and encode colors in
-                // RGB555, else set MSB to 0 and encode colors in ARGB3444
-                if ((fieldA & 0xE000000000ULL) == 0xE000000000ULL)
-                    tmp = 0x8000000000000000ULL |
-                          ((fieldA & 0xF800000000000000ULL) >> 1) |
-                          ((fieldA & 0xF8000000000000ULL) << 2) |
-                          ((fieldA & 0xF80000000000ULL) << 5);
-                else
-                    tmp = ((fieldA & 0xE000000000ULL) << 23) |
-                          ((fieldA & 0xF000000000000000ULL) >> 4) |
-                          (fieldA & 0xF0000000000000ULL) |
-                          ((fieldA & 0xF00000000000ULL) << 4);
-
-                // If second pixel is opaque set MSB to 1 and encode colors in
-                // RGB555, else set MSB to 0 and encode colors in ARGB3444
-                if ((fieldA & 0xE0ULL) == 0xE0ULL)
-                    tmp = tmp | 0x800000000000ULL |
-                          ((fieldA & 0xF8000000ULL) << 15) |
-                          ((fieldA & 0xF80000ULL) << 18) |
-                          ((fieldA & 0xF800ULL) << 21);
-                else
-                    tmp = tmp | ((fieldA & 0xE0ULL) << 39) |
-                          ((fieldA & 0xF0000000ULL) << 12) |
-                          ((fieldA & 0xF00000ULL) << 16) |
-                          ((fieldA & 0xF000ULL) << 20);
-
-                // If third pixel is opaque set MSB to 1 and encode colors in
-                // RGB555, else set MSB to 0 and encode colors in ARGB3444
-                if ((fieldB & 0xE000000000ULL) == 0xE000000000ULL)
-                    tmp = tmp | 0x80000000ULL |
-                          ((fieldB & 0xF800000000000000ULL) >> 33) |
-                          ((fieldB & 0xF8000000000000ULL) >> 30) |
-                          ((fieldB & 0xF80000000000ULL) >> 27);
-                else
-                    tmp = tmp | ((fieldB & 0xE000000000ULL) >> 9) |
-                          ((fieldB & 0xF000000000000000ULL) >> 36) |
-                          ((fieldB & 0xF0000000000000ULL) >> 32) |
-                          ((fieldB & 0xF00000000000ULL) >> 28);
-
-                // If fourth pixel is opaque set MSB to 1 and encode colors in
-                // RGB555, else set MSB to 0 and encode colors in ARGB3444
-                if ((fieldB & 0xE0ULL) == 0xE0ULL)
-                    tmp = tmp | 0x8000ULL | ((fieldB & 0xF8000000ULL) >> 17) |
-                          ((fieldB & 0xF80000ULL) >> 14) |
-                          ((fieldB & 0xF800ULL) >> 11);
-                else
-                    tmp = tmp | ((fieldB & 0xE0ULL) << 7) |
-                          ((fieldB & 0xF0000000ULL) >> 20) |
-                          ((fieldB & 0xF00000ULL) >> 16) |
-                          ((fieldB & 0xF000ULL) >> 12);
-                ((PNGU_u64*)buffer)[blockbase] = tmp;
-
-                fieldA = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 16));
-                fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 16 + 8));
-                if ((fieldA & 0xE000000000ULL) == 0xE000000000ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = 0x8000000000000000ULL |
-                          ((fieldA & 0xF800000000000000ULL) >> 1) |
-                          ((fieldA & 0xF8000000000000ULL) << 2) |
-                          ((fieldA & 0xF80000000000ULL) << 5);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = ((fieldA & 0xE000000000ULL) << 23) |
-                          ((fieldA & 0xF000000000000000ULL) >> 4) |
-                          (fieldA & 0xF0000000000000ULL) |
-                          ((fieldA & 0xF00000000000ULL) << 4);
-
-                if ((fieldA & 0xE0ULL) == 0xE0ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x800000000000ULL |
-                          ((fieldA & 0xF8000000ULL) << 15) |
-                          ((fieldA & 0xF80000ULL) << 18) |
-                          ((fieldA & 0xF800ULL) << 21);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldA & 0xE0ULL) << 39) |
-                          ((fieldA & 0xF0000000ULL) << 12) |
-                          ((fieldA & 0xF00000ULL) << 16) |
-                          ((fieldA & 0xF000ULL) << 20);
-
-                if ((fieldB & 0xE000000000ULL) == 0xE000000000ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x80000000ULL |
-                          ((fieldB & 0xF800000000000000ULL) >> 33) |
-                          ((fieldB & 0xF8000000000000ULL) >> 30) |
-                          ((fieldB & 0xF80000000000ULL) >> 27);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldB & 0xE000000000ULL) >> 9) |
-                          ((fieldB & 0xF000000000000000ULL) >> 36) |
-                          ((fieldB & 0xF0000000000000ULL) >> 32) |
-                          ((fieldB & 0xF00000000000ULL) >> 28);
-
-                if ((fieldB & 0xE0ULL) == 0xE0ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x8000ULL | ((fieldB & 0xF8000000ULL) >> 17) |
-                          ((fieldB & 0xF80000ULL) >> 14) |
-                          ((fieldB & 0xF800ULL) >> 11);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldB & 0xE0ULL) << 7) |
-                          ((fieldB & 0xF0000000ULL) >> 20) |
-                          ((fieldB & 0xF00000ULL) >> 16) |
-                          ((fieldB & 0xF000ULL) >> 12);
-                ((PNGU_u64*)buffer)[blockbase + 1] = tmp;
-
-                fieldA = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 16));
-                fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 16 + 8));
-                if ((fieldA & 0xE000000000ULL) == 0xE000000000ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = 0x8000000000000000ULL |
-                          ((fieldA & 0xF800000000000000ULL) >> 1) |
-                          ((fieldA & 0xF8000000000000ULL) << 2) |
-                          ((fieldA & 0xF80000000000ULL) << 5);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = ((fieldA & 0xE000000000ULL) << 23) |
-                          ((fieldA & 0xF000000000000000ULL) >> 4) |
-                          (fieldA & 0xF0000000000000ULL) |
-                          ((fieldA & 0xF00000000000ULL) << 4);
-
-                if ((fieldA & 0xE0ULL) == 0xE0ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x800000000000ULL |
-                          ((fieldA & 0xF8000000ULL) << 15) |
-                          ((fieldA & 0xF80000ULL) << 18) |
-                          ((fieldA & 0xF800ULL) << 21);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldA & 0xE0ULL) << 39) |
-                          ((fieldA & 0xF0000000ULL) << 12) |
-                          ((fieldA & 0xF00000ULL) << 16) |
-                          ((fieldA & 0xF000ULL) << 20);
-
-                if ((fieldB & 0xE000000000ULL) == 0xE000000000ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x80000000ULL |
-                          ((fieldB & 0xF800000000000000ULL) >> 33) |
-                          ((fieldB & 0xF8000000000000ULL) >> 30) |
-                          ((fieldB & 0xF80000000000ULL) >> 27);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldB & 0xE000000000ULL) >> 9) |
-                          ((fieldB & 0xF000000000000000ULL) >> 36) |
-                          ((fieldB & 0xF0000000000000ULL) >> 32) |
-                          ((fieldB & 0xF00000000000ULL) >> 28);
-
-                if ((fieldB & 0xE0ULL) == 0xE0ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x8000ULL | ((fieldB & 0xF8000000ULL) >> 17) |
-                          ((fieldB & 0xF80000ULL) >> 14) |
-                          ((fieldB & 0xF800ULL) >> 11);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldB & 0xE0ULL) << 7) |
-                          ((fieldB & 0xF0000000ULL) >> 20) |
-                          ((fieldB & 0xF00000ULL) >> 16) |
-                          ((fieldB & 0xF000ULL) >> 12);
-                ((PNGU_u64*)buffer)[blockbase + 2] = tmp;
-
-                fieldA = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 16));
-                fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 16 + 8));
-                if ((fieldA & 0xE000000000ULL) == 0xE000000000ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = 0x8000000000000000ULL |
-                          ((fieldA & 0xF800000000000000ULL) >> 1) |
-                          ((fieldA & 0xF8000000000000ULL) << 2) |
-                          ((fieldA & 0xF80000000000ULL) << 5);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = ((fieldA & 0xE000000000ULL) << 23) |
-                          ((fieldA & 0xF000000000000000ULL) >> 4) |
-                          (fieldA & 0xF0000000000000ULL) |
-                          ((fieldA & 0xF00000000000ULL) << 4);
-
-                if ((fieldA & 0xE0ULL) == 0xE0ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x800000000000ULL |
-                          ((fieldA & 0xF8000000ULL) << 15) |
-                          ((fieldA & 0xF80000ULL) << 18) |
-                          ((fieldA & 0xF800ULL) << 21);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldA & 0xE0ULL) << 39) |
-                          ((fieldA & 0xF0000000ULL) << 12) |
-                          ((fieldA & 0xF00000ULL) << 16) |
-                          ((fieldA & 0xF000ULL) << 20);
-
-                if ((fieldB & 0xE000000000ULL) == 0xE000000000ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x80000000ULL |
-                          ((fieldB & 0xF800000000000000ULL) >> 33) |
-                          ((fieldB & 0xF8000000000000ULL) >> 30) |
-                          ((fieldB & 0xF80000000000ULL) >> 27);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldB & 0xE000000000ULL) >> 9) |
-                          ((fieldB & 0xF000000000000000ULL) >> 36) |
-                          ((fieldB & 0xF0000000000000ULL) >> 32) |
-                          ((fieldB & 0xF00000000000ULL) >> 28);
-
-                if ((fieldB & 0xE0ULL) == 0xE0ULL)
-                    // Opaque pixel, so set MSB to 1 and encode colors in RGB555
-                    tmp = tmp | 0x8000ULL | ((fieldB & 0xF8000000ULL) >> 17) |
-                          ((fieldB & 0xF80000ULL) >> 14) |
-                          ((fieldB & 0xF800ULL) >> 11);
-                else
-                    // Tranlucid pixel, so set MSB to 0 and encode colors in
-                    // ARGB3444
-                    tmp = tmp | ((fieldB & 0xE0ULL) << 7) |
-                          ((fieldB & 0xF0000000ULL) >> 20) |
-                          ((fieldB & 0xF00000ULL) >> 16) |
-                          ((fieldB & 0xF000ULL) >> 12);
-                ((PNGU_u64*)buffer)[blockbase + 3] = tmp;
-            }
-    } else {
-        // No alpha channel present, copy image to the output buffer
-        default_alpha = (default_alpha >> 5);
-        if (default_alpha == 7) {
-            // The user wants an opaque texture, so set MSB to 1 and encode
-            // colors in RGB555
-            alphaMask = 0x8000800080008000ULL;
-
-            for (y = 0; y < qheight; y++)
-                for (x = 0; x < qwidth; x++) {
-                    int blockbase = (y * qwidth + x) * 4;
-
-                    PNGU_u64 field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 12));
-                    PNGU_u64 field32 =
-                        (PNGU_u64) *
-                        ((PNGU_u32*)(ctx->row_pointers[y * 4] + x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase] =
-                        alphaMask | ((field64 & 0xF800000000000000ULL) >> 1) |
-                        ((field64 & 0xF8000000000000ULL) << 2) |
-                        ((field64 & 0xF80000000000ULL) << 5) |
-                        ((field64 & 0xF800000000ULL) << 7) |
-                        ((field64 & 0xF8000000ULL) << 10) |
-                        ((field64 & 0xF80000ULL) << 13) |
-                        ((field64 & 0xF800ULL) << 15) |
-                        ((field64 & 0xF8ULL) << 18) |
-                        ((field32 & 0xF8000000ULL) >> 11) |
-                        ((field32 & 0xF80000ULL) >> 9) |
-                        ((field32 & 0xF800ULL) >> 6) |
-                        ((field32 & 0xF8ULL) >> 3);
-
-                    field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 12));
-                    field32 =
-                        (PNGU_u64) * ((PNGU_u32*)(ctx->row_pointers[y * 4 + 1] +
-                                                  x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase + 1] =
-                        alphaMask | ((field64 & 0xF800000000000000ULL) >> 1) |
-                        ((field64 & 0xF8000000000000ULL) << 2) |
-                        ((field64 & 0xF80000000000ULL) << 5) |
-                        ((field64 & 0xF800000000ULL) << 7) |
-                        ((field64 & 0xF8000000ULL) << 10) |
-                        ((field64 & 0xF80000ULL) << 13) |
-                        ((field64 & 0xF800ULL) << 15) |
-                        ((field64 & 0xF8ULL) << 18) |
-                        ((field32 & 0xF8000000ULL) >> 11) |
-                        ((field32 & 0xF80000ULL) >> 9) |
-                        ((field32 & 0xF800ULL) >> 6) |
-                        ((field32 & 0xF8ULL) >> 3);
-
-                    field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 12));
-                    field32 =
-                        (PNGU_u64) * ((PNGU_u32*)(ctx->row_pointers[y * 4 + 2] +
-                                                  x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase + 2] =
-                        alphaMask | ((field64 & 0xF800000000000000ULL) >> 1) |
-                        ((field64 & 0xF8000000000000ULL) << 2) |
-                        ((field64 & 0xF80000000000ULL) << 5) |
-                        ((field64 & 0xF800000000ULL) << 7) |
-                        ((field64 & 0xF8000000ULL) << 10) |
-                        ((field64 & 0xF80000ULL) << 13) |
-                        ((field64 & 0xF800ULL) << 15) |
-                        ((field64 & 0xF8ULL) << 18) |
-                        ((field32 & 0xF8000000ULL) >> 11) |
-                        ((field32 & 0xF80000ULL) >> 9) |
-                        ((field32 & 0xF800ULL) >> 6) |
-                        ((field32 & 0xF8ULL) >> 3);
-
-                    field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 12));
-                    field32 =
-                        (PNGU_u64) * ((PNGU_u32*)(ctx->row_pointers[y * 4 + 3] +
-                                                  x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase + 3] =
-                        alphaMask | ((field64 & 0xF800000000000000ULL) >> 1) |
-                        ((field64 & 0xF8000000000000ULL) << 2) |
-                        ((field64 & 0xF80000000000ULL) << 5) |
-                        ((field64 & 0xF800000000ULL) << 7) |
-                        ((field64 & 0xF8000000ULL) << 10) |
-                        ((field64 & 0xF80000ULL) << 13) |
-                        ((field64 & 0xF800ULL) << 15) |
-                        ((field64 & 0xF8ULL) << 18) |
-                        ((field32 & 0xF8000000ULL) >> 11) |
-                        ((field32 & 0xF80000ULL) >> 9) |
-                        ((field32 & 0xF800ULL) >> 6) |
-                        ((field32 & 0xF8ULL) >> 3);
-                }
-        } else {
-            // The user wants a translucid texture, so set MSB to 0 and encode
-            // colors in ARGB3444
-            default_alpha = (default_alpha << 4);
-            alphaMask = (((PNGU_u64)default_alpha) << 56) |
-                        (((PNGU_u64)default_alpha) << 40) |
-                        (((PNGU_u64)default_alpha) << 24) |
-                        (((PNGU_u64)default_alpha) << 8);
-
-            for (y = 0; y < qheight; y++)
-                for (x = 0; x < qwidth; x++) {
-                    int blockbase = (y * qwidth + x) * 4;
-
-                    PNGU_u64 field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 12));
-                    PNGU_u64 field32 =
-                        (PNGU_u64) *
-                        ((PNGU_u32*)(ctx->row_pointers[y * 4] + x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase] =
-                        alphaMask | ((field64 & 0xF000000000000000ULL) >> 4) |
-                        (field64 & 0xF0000000000000ULL) |
-                        ((field64 & 0xF00000000000ULL) << 4) |
-                        ((field64 & 0xF000000000ULL) << 4) |
-                        ((field64 & 0xF0000000ULL) << 8) |
-                        ((field64 & 0xF00000ULL) << 12) |
-                        ((field64 & 0xF000ULL) << 12) |
-                        ((field64 & 0xF0ULL) << 16) |
-                        ((field32 & 0xF0000000ULL) >> 12) |
-                        ((field32 & 0xF00000ULL) >> 12) |
-                        ((field32 & 0xF000ULL) >> 8) |
-                        ((field32 & 0xF0ULL) >> 4);
-
-                    field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 12));
-                    field32 =
-                        (PNGU_u64) * ((PNGU_u32*)(ctx->row_pointers[y * 4 + 1] +
-                                                  x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase + 1] =
-                        alphaMask | ((field64 & 0xF000000000000000ULL) >> 4) |
-                        (field64 & 0xF0000000000000ULL) |
-                        ((field64 & 0xF00000000000ULL) << 4) |
-                        ((field64 & 0xF000000000ULL) << 4) |
-                        ((field64 & 0xF0000000ULL) << 8) |
-                        ((field64 & 0xF00000ULL) << 12) |
-                        ((field64 & 0xF000ULL) << 12) |
-                        ((field64 & 0xF0ULL) << 16) |
-                        ((field32 & 0xF0000000ULL) >> 12) |
-                        ((field32 & 0xF00000ULL) >> 12) |
-                        ((field32 & 0xF000ULL) >> 8) |
-                        ((field32 & 0xF0ULL) >> 4);
-
-                    field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 12));
-                    field32 =
-                        (PNGU_u64) * ((PNGU_u32*)(ctx->row_pointers[y * 4 + 2] +
-                                                  x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase + 2] =
-                        alphaMask | ((field64 & 0xF000000000000000ULL) >> 4) |
-                        (field64 & 0xF0000000000000ULL) |
-                        ((field64 & 0xF00000000000ULL) << 4) |
-                        ((field64 & 0xF000000000ULL) << 4) |
-                        ((field64 & 0xF0000000ULL) << 8) |
-                        ((field64 & 0xF00000ULL) << 12) |
-                        ((field64 & 0xF000ULL) << 12) |
-                        ((field64 & 0xF0ULL) << 16) |
-                        ((field32 & 0xF0000000ULL) >> 12) |
-                        ((field32 & 0xF00000ULL) >> 12) |
-                        ((field32 & 0xF000ULL) >> 8) |
-                        ((field32 & 0xF0ULL) >> 4);
-
-                    field64 =
-                        *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 12));
-                    field32 =
-                        (PNGU_u64) * ((PNGU_u32*)(ctx->row_pointers[y * 4 + 3] +
-                                                  x * 12 + 8));
-                    ((PNGU_u64*)buffer)[blockbase + 3] =
-                        alphaMask | ((field64 & 0xF000000000000000ULL) >> 4) |
-                        (field64 & 0xF0000000000000ULL) |
-                        ((field64 & 0xF00000000000ULL) << 4) |
-                        ((field64 & 0xF000000000ULL) << 4) |
-                        ((field64 & 0xF0000000ULL) << 8) |
-                        ((field64 & 0xF00000ULL) << 12) |
-                        ((field64 & 0xF000ULL) << 12) |
-                        ((field64 & 0xF0ULL) << 16) |
-                        ((field32 & 0xF0000000ULL) >> 12) |
-                        ((field32 & 0xF00000ULL) >> 12) |
-                        ((field32 & 0xF000ULL) >> 8) |
-                        ((field32 & 0xF0ULL) >> 4);
-                }
-        }
-    }
+int PNGU_DecodeTo4x4(IMGCTX ctx,
+                     PNGU_u32 width,
+                     PNGU_u32 height,
+                     void* buffer,
+                     PNGU_u8 format,
+                     PNGU_u8 default_alpha) {
+    return pngu_decode_4x4(ctx, width, height, buffer, format, default_alpha);
+}
 
-    // Free resources
-    free(ctx->img_data);
-    free(ctx->row_pointers);
+int PNGU_DecodeTo4x4RGB565(IMGCTX ctx,
+                           PNGU_u32 width,
+                           PNGU_u32 height,
+                           void* buffer) {
+    return pngu_decode_4x4(ctx, width, height, buffer, GX_TF_RGB565, 0xFF);
+}
 
-    // Success
-    return PNGU_OK;
+int PNGU_DecodeTo4x4RGB5A3(IMGCTX ctx,
+                           PNGU_u32 width,
+                           PNGU_u32 height,
+                           void* buffer,
+                           PNGU_u8 default_alpha) {
+    return pngu_decode_4x4(ctx, width, height, buffer, GX_TF_RGB5A3,
+                           default_alpha);
 }
 
 int PNGU_DecodeTo4x4RGBA8(IMGCTX ctx,
@@ -788,192 +441,62 @@ int PNGU_DecodeTo4x4RGBA8(IMGCTX ctx,
                           PNGU_u32 height,
                           void* buffer,
                           PNGU_u8 default_alpha) {
-    int result;
-    PNGU_u32 x, y, qwidth, qheight;
-    PNGU_u64 alphaMask;
-
-    // width and height need to be divisible by four
-    if ((width % 4) || (height % 4))
-        return PNGU_INVALID_WIDTH_OR_HEIGHT;
-
-    result = pngu_decode(ctx, width, height, 0);
-    if (result != PNGU_OK)
-        return result;
+    return pngu_decode_4x4(ctx, width, height, buffer, GX_TF_RGBA8,
+                           default_alpha);
+}
 
-    // Init some variables
-    qwidth = width / 4;
-    qheight = height / 4;
+int PNGU_DecodeTo4x4Scaled(IMGCTX ctx,
+                           PNGU_u32 width,
+                           PNGU_u32 height,
+                           void* buffer,
+                           PNGU_u32 dstWidth,
+                           PNGU_u32 dstHeight,
+                           PNGU_u8 format,
+                           PNGU_u8 default_alpha) {
+    return pngu_decode_4x4_scaled(ctx, width, height, buffer, dstWidth,
+                                  dstHeight, format, default_alpha);
+}
 
-    // Check is source image has an alpha channel
-    if ((ctx->prop.imgColorType == PNGU_COLOR_TYPE_GRAY_ALPHA) ||
-        (ctx->prop.imgColorType == PNGU_COLOR_TYPE_RGB_ALPHA)) {
-        // Alpha channel present, copy image to the output buffer
-        for (y = 0; y < qheight; y++)
-            for (x = 0; x < qwidth; x++) {
-                int blockbase = (y * qwidth + x) * 8;
-
-                PNGU_u64 fieldA =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 16));
-                PNGU_u64 fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 16 + 8));
-                ((PNGU_u64*)buffer)[blockbase] =
-                    ((fieldA & 0xFF00000000ULL) << 24) |
-                    ((fieldA & 0xFF00000000000000ULL) >> 8) |
-                    ((fieldA & 0xFFULL) << 40) |
-                    ((fieldA & 0xFF000000ULL) << 8) |
-                    ((fieldB & 0xFF00000000ULL) >> 8) |
-                    ((fieldB & 0xFF00000000000000ULL) >> 40) |
-                    ((fieldB & 0xFFULL) << 8) |
-                    ((fieldB & 0xFF000000ULL) >> 24);
-                ((PNGU_u64*)buffer)[blockbase + 4] =
-                    ((fieldA & 0xFFFF0000000000ULL) << 8) |
-                    ((fieldA & 0xFFFF00ULL) << 24) |
-                    ((fieldB & 0xFFFF0000000000ULL) >> 24) |
-                    ((fieldB & 0xFFFF00ULL) >> 8);
-
-                fieldA = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 16));
-                fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 16 + 8));
-                ((PNGU_u64*)buffer)[blockbase + 1] =
-                    ((fieldA & 0xFF00000000ULL) << 24) |
-                    ((fieldA & 0xFF00000000000000ULL) >> 8) |
-                    ((fieldA & 0xFFULL) << 40) |
-                    ((fieldA & 0xFF000000ULL) << 8) |
-                    ((fieldB & 0xFF00000000ULL) >> 8) |
-                    ((fieldB & 0xFF00000000000000ULL) >> 40) |
-                    ((fieldB & 0xFFULL) << 8) |
-                    ((fieldB & 0xFF000000ULL) >> 24);
-                ((PNGU_u64*)buffer)[blockbase + 5] =
-                    ((fieldA & 0xFFFF0000000000ULL) << 8) |
-                    ((fieldA & 0xFFFF00ULL) << 24) |
-                    ((fieldB & 0xFFFF0000000000ULL) >> 24) |
-                    ((fieldB & 0xFFFF00ULL) >> 8);
-
-                fieldA = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 16));
-                fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 16 + 8));
-                ((PNGU_u64*)buffer)[blockbase + 2] =
-                    ((fieldA & 0xFF00000000ULL) << 24) |
-                    ((fieldA & 0xFF00000000000000ULL) >> 8) |
-                    ((fieldA & 0xFFULL) << 40) |
-                    ((fieldA & 0xFF000000ULL) << 8) |
-                    ((fieldB & 0xFF00000000ULL) >> 8) |
-                    ((fieldB & 0xFF00000000000000ULL) >> 40) |
-                    ((fieldB & 0xFFULL) << 8) |
-                    ((fieldB & 0xFF000000ULL) >> 24);
-                ((PNGU_u64*)buffer)[blockbase + 6] =
-                    ((fieldA & 0xFFFF0000000000ULL) << 8) |
-                    ((fieldA & 0xFFFF00ULL) << 24) |
-                    ((fieldB & 0xFFFF0000000000ULL) >> 24) |
-                    ((fieldB & 0xFFFF00ULL) >> 8);
-
-                fieldA = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 16));
-                fieldB =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 16 + 8));
-                ((PNGU_u64*)buffer)[blockbase + 3] =
-                    ((fieldA & 0xFF00000000ULL) << 24) |
-                    ((fieldA & 0xFF00000000000000ULL) >> 8) |
-                    ((fieldA & 0xFFULL) << 40) |
-                    ((fieldA & 0xFF000000ULL) << 8) |
-                    ((fieldB & 0xFF00000000ULL) >> 8) |
-                    ((fieldB & 0xFF00000000000000ULL) >> 40) |
-                    ((fieldB & 0xFFULL) << 8) |
-                    ((fieldB & 0xFF000000ULL) >> 24);
-                ((PNGU_u64*)buffer)[blockbase + 7] =
-                    ((fieldA & 0xFFFF0000000000ULL) << 8) |
-                    ((fieldA & 0xFFFF00ULL) << 24) |
-                    ((fieldB & 0xFFFF0000000000ULL) >> 24) |
-                    ((fieldB & 0xFFFF00ULL) >> 8);
-            }
-    } else {
-        // No alpha channel present, copy image to the output buffer
-        alphaMask = (((PNGU_u64)default_alpha) << 56) |
-                    (((PNGU_u64)default_alpha) << 40) |
-                    (((PNGU_u64)default_alpha) << 24) |
-                    (((PNGU_u64)default_alpha) << 8);
-
-        for (y = 0; y < qheight; y++)
-            for (x = 0; x < qwidth; x++) {
-                int blockbase = (y * qwidth + x) * 8;
-
-                PNGU_u64 field64 =
-                    *((PNGU_u64*)(ctx->row_pointers[y * 4] + x * 12));
-                PNGU_u64 field32 =
-                    (PNGU_u64) *
-                    ((PNGU_u32*)(ctx->row_pointers[y * 4] + x * 12 + 8));
-                ((PNGU_u64*)buffer)[blockbase] =
-                    (((field64 & 0xFF00000000000000ULL) >> 8) |
-                     (field64 & 0xFF00000000ULL) |
-                     ((field64 & 0xFF00ULL) << 8) |
-                     ((field32 & 0xFF0000ULL) >> 16) | alphaMask);
-                ((PNGU_u64*)buffer)[blockbase + 4] =
-                    (((field64 & 0xFFFF0000000000ULL) << 8) |
-                     ((field64 & 0xFFFF0000ULL) << 16) |
-                     ((field64 & 0xFFULL) << 24) |
-                     ((field32 & 0xFF000000ULL) >> 8) | (field32 & 0xFFFFULL));
-
-                field64 = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 1] + x * 12));
-                field32 =
-                    (PNGU_u64) *
-                    ((PNGU_u32*)(ctx->row_pointers[y * 4 + 1] + x * 12 + 8));
-                ((PNGU_u64*)buffer)[blockbase + 1] =
-                    (((field64 & 0xFF00000000000000ULL) >> 8) |
-                     (field64 & 0xFF00000000ULL) |
-                     ((field64 & 0xFF00ULL) << 8) |
-                     ((field32 & 0xFF0000ULL) >> 16) | alphaMask);
-                ((PNGU_u64*)buffer)[blockbase + 5] =
-                    (((field64 & 0xFFFF0000000000ULL) << 8) |
-                     ((field64 & 0xFFFF0000ULL) << 16) |
-                     ((field64 & 0xFFULL) << 24) |
-                     ((field32 & 0xFF000000ULL) >> 8) | (field32 & 0xFFFFULL));
-
-                field64 = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 2] + x * 12));
-                field32 =
-                    (PNGU_u64) *
-                    ((PNGU_u32*)(ctx->row_pointers[y * 4 + 2] + x * 12 + 8));
-                ((PNGU_u64*)buffer)[blockbase + 2] =
-                    (((field64 & 0xFF00000000000000ULL) >> 8) |
-                     (field64 & 0xFF00000000ULL) |
-                     ((field64 & 0xFF00ULL) << 8) |
-                     ((field32 & 0xFF0000ULL) >> 16) | alphaMask);
-                ((PNGU_u64*)buffer)[blockbase + 6] =
-                    (((field64 & 0xFFFF0000000000ULL) << 8) |
-                     ((field64 & 0xFFFF0000ULL) << 16) |
-                     ((field64 & 0xFFULL) << 24) |
-                     ((field32 & 0xFF000000ULL) >> 8) | (field32 & 0xFFFFULL));
-
-                field64 = *((PNGU_u64*)(ctx->row_pointers[y * 4 + 3] + x * 12));
-                field32 =
-                    (PNGU_u64) *
-                    ((PNGU_u32*)(ctx->row_pointers[y * 4 + 3] + x * 12 + 8));
-                ((PNGU_u64*)buffer)[blockbase + 3] =
-                    (((field64 & 0xFF00000000000000ULL) >> 8) |
-                     (field64 & 0xFF00000000ULL) |
-                     ((field64 & 0xFF00ULL) << 8) |
-                     ((field32 & 0xFF0000ULL) >> 16) | alphaMask);
-                ((PNGU_u64*)buffer)[blockbase + 7] =
-                    (((field64 & 0xFFFF0000000000ULL) << 8) |
-                     ((field64 & 0xFFFF0000ULL) << 16) |
-                     ((field64 & 0xFFULL) << 24) |
-                     ((field32 & 0xFF000000ULL) >> 8) | (field32 & 0xFFFFULL));
-            }
-    }
+int PNGU_DecodeTo4x4RGB565Scaled(IMGCTX ctx,
+                                 PNGU_u32 width,
+                                 PNGU_u32 height,
+                                 void* buffer,
+                                 PNGU_u32 dstWidth,
+                                 PNGU_u32 dstHeight) {
+    return pngu_decode_4x4_scaled(ctx, width, height, buffer, dstWidth,
+                                  dstHeight, GX_TF_RGB565, 0xFF);
+}
 
-    // Free resources
-    free(ctx->img_data);
-    free(ctx->row_pointers);
+int PNGU_DecodeTo4x4RGB5A3Scaled(IMGCTX ctx,
+                                 PNGU_u32 width,
+                                 PNGU_u32 height,
+                                 void* buffer,
+                                 PNGU_u32 dstWidth,
+                                 PNGU_u32 dstHeight,
+                                 PNGU_u8 default_alpha) {
+    return pngu_decode_4x4_scaled(ctx, width, height, buffer, dstWidth,
+                                  dstHeight, GX_TF_RGB5A3, default_alpha);
+}
 
-    // Success
-    return PNGU_OK;
+int PNGU_DecodeTo4x4RGBA8Scaled(IMGCTX ctx,
+                                PNGU_u32 width,
+                                PNGU_u32 height,
+                                void* buffer,
+                                PNGU_u32 dstWidth,
+                                PNGU_u32 dstHeight,
+                                PNGU_u8 default_alpha) {
+    return pngu_decode_4x4_scaled(ctx, width, height, buffer, dstWidth,
+                                  dstHeight, GX_TF_RGBA8, default_alpha);
 }
 
+
 int PNGU_EncodeFromYCbYCr(IMGCTX ctx,
                           PNGU_u32 width,
                           PNGU_u32 height,
                           void* buffer,
                           PNGU_u32 stride) {
     png_uint_32 rowbytes;
-    PNGU_u32 x, y, buffWidth;
+    PNGU_u32 y, buffWidth;
 
     // Erase from the context any readed info
     pngu_free_info(ctx);
@@ -1019,6 +542,7 @@ int PNGU_EncodeFromYCbYCr(IMGCTX ctx,
         // FILE*
         png_init_io(ctx->png_ptr, ctx->fd);
     }
+    pngu_set_compression(ctx);
 
     // Setup output file properties
     png_set_IHDR(ctx->png_ptr, ctx->info_ptr, width, height, 8,
@@ -1052,15 +576,8 @@ int PNGU_EncodeFromYCbYCr(IMGCTX ctx,
     buffWidth = (width + stride) / 2;
     for (y = 0; y < height; y++) {
         ctx->row_pointers[y] = ctx->img_data + (y * rowbytes);
-
-        for (x = 0; x < (width / 2); x++)
-            PNGU_YCbYCr_TO_RGB8(((PNGU_u32*)buffer)[y * buffWidth + x],
-                                ((PNGU_u8*)ctx->row_pointers[y] + x * 6),
-                                ((PNGU_u8*)ctx->row_pointers[y] + x * 6 + 1),
-                                ((PNGU_u8*)ctx->row_pointers[y] + x * 6 + 2),
-                                ((PNGU_u8*)ctx->row_pointers[y] + x * 6 + 3),
-                                ((PNGU_u8*)ctx->row_pointers[y] + x * 6 + 4),
-                                ((PNGU_u8*)ctx->row_pointers[y] + x * 6 + 5));
+        wii_ycbcr_to_rgb8_row((PNGU_u32*)buffer + y * buffWidth,
+                              ctx->row_pointers[y], width);
     }
 
     // Tell libpng where is our image data
@@ -1135,6 +652,7 @@ int PNGU_EncodeFromRGB(IMGCTX ctx,
         // FILE*
         png_init_io(ctx->png_ptr, ctx->fd);
     }
+    pngu_set_compression(ctx);
 
     // Setup output file properties
     png_set_IHDR(ctx->png_ptr, ctx->info_ptr, width, height, 8,
@@ -1197,49 +715,244 @@ int PNGU_EncodeFromGXTexture(IMGCTX ctx,
                              PNGU_u32 height,
                              void* buffer,
                              PNGU_u32 stride) {
-    int x, y, res;
-    unsigned char* ptr = (unsigned char*)buffer;
-    unsigned char* tmpbuffer = (unsigned char*)malloc(width * height * 3);
-    memset(tmpbuffer, 0, width * height * 3);
-    png_uint_32 offset;
+    return PNGU_EncodeFromGXTextureFormat(ctx, width, height, buffer,
+                                          GX_TF_RGBA8);
+}
 
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++) {
-            offset = (((y >> 2) << 4) * width) + ((x >> 2) << 6) +
-                     (((y % 4 << 2) + x % 4) << 1);
+int PNGU_EncodeFromGXTextureFormat(IMGCTX ctx,
+                                   PNGU_u32 width,
+                                   PNGU_u32 height,
+                                   void* buffer,
+                                   PNGU_u8 format) {
+    png_uint_32 rowbytes;
+    png_bytep band;
+    PNGU_u32 y, rows, i, bandSize;
+
+    // Check if the texture format is supported
+    if ((format != GX_TF_RGBA8) && (format != GX_TF_RGB565))
+        return PNGU_UNSUPPORTED_COLOR_TYPE;
+
+    // Erase from the context any readed info
+    pngu_free_info(ctx);
+    ctx->propRead = 0;
+
+    // Check if the user has selected a file to write the image
+    if (ctx->source == PNGU_SOURCE_BUFFER)
+        ;
+
+    else if (ctx->source == PNGU_SOURCE_DEVICE) {
+        // Open file
+        if (!(ctx->fd = fopen(ctx->filename, "wb")))
+            return PNGU_CANT_OPEN_FILE;
+    }
+
+    else
+        return PNGU_NO_FILE_SELECTED;
+
+    // Rows are converted a band of tiles at a time into a pooled band buffer
+    rowbytes = width * 3;
+    band = pngu_band_acquire(rowbytes * 4, &bandSize);
+    if (!band) {
+        if (ctx->source == PNGU_SOURCE_DEVICE)
+            fclose(ctx->fd);
+        return PNGU_LIB_ERROR;
+    }
+
+    // Allocation of libpng structs
+    ctx->png_ptr =
+        png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!(ctx->png_ptr)) {
+        pngu_band_release(band, bandSize);
+        if (ctx->source == PNGU_SOURCE_DEVICE)
+            fclose(ctx->fd);
+        return PNGU_LIB_ERROR;
+    }
+
+    ctx->info_ptr = png_create_info_struct(ctx->png_ptr);
+    if (!(ctx->info_ptr)) {
+        png_destroy_write_struct(&(ctx->png_ptr), (png_infopp)NULL);
+        pngu_band_release(band, bandSize);
+        if (ctx->source == PNGU_SOURCE_DEVICE)
+            fclose(ctx->fd);
+        return PNGU_LIB_ERROR;
+    }
+
+    if (ctx->source == PNGU_SOURCE_BUFFER) {
+        // Installation of our custom data writer function
+        ctx->cursor = 0;
+        png_set_write_fn(ctx->png_ptr, ctx, pngu_write_data_to_buffer,
+                         pngu_flush_data_to_buffer);
+    } else if (ctx->source == PNGU_SOURCE_DEVICE) {
+        // Default data writer uses function fwrite, so it needs to use our
+        // FILE*
+        png_init_io(ctx->png_ptr, ctx->fd);
+    }
+    pngu_set_compression(ctx);
+
+    // Setup output file properties
+    png_set_IHDR(ctx->png_ptr, ctx->info_ptr, width, height, 8,
+                 PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+    // Write file header
+    png_write_info(ctx->png_ptr, ctx->info_ptr);
+
+    // Convert the texture a band of tiles at a time and stream the rows
+    for (y = 0; y < height; y += 4) {
+        rows = height - y < 4 ? height - y : 4;
+        wii_deswizzle_rgb8(format, buffer, width, y, rows, band, rowbytes);
+        for (i = 0; i < rows; i++)
+            png_write_row(ctx->png_ptr, band + i * rowbytes);
+    }
+
+    // Tell libpng we have no more data to write
+    png_write_end(ctx->png_ptr, (png_infop)NULL);
+
+    // Free resources
+    pngu_band_release(band, bandSize);
+    png_destroy_write_struct(&(ctx->png_ptr), &(ctx->info_ptr));
+    if (ctx->source == PNGU_SOURCE_DEVICE)
+        fclose(ctx->fd);
+
+    // Success
+    return ctx->cursor;
+}
+
+void PNGU_SetEncodeOptions(int level, int strategy, int filters) {
+    pngu_encode_options_set = 1;
+    pngu_encode_level = level;
+    pngu_encode_strategy = strategy;
+    pngu_encode_filters = filters;
+}
+
+int PNGU_EncodeToDeviceAsync(const char* filename,
+                             PNGU_u32 format,
+                             PNGU_u32 width,
+                             PNGU_u32 height,
+                             const void* buffer,
+                             PNGU_u32 stride,
+                             PNGU_EncodeCallback callback,
+                             void* data) {
+    pngu_encode_job* job;
+    PNGU_u32 len, rowbytes;
+
+    if (!filename || !buffer)
+        return PNGU_NO_FILE_SELECTED;
+
+    // Size of the source image, as read by the synchronous encoders
+    switch (format) {
+        case PNGU_ENCODE_YCbYCr:
+            len = (width + stride) * 2 * height;
+            break;
+        case PNGU_ENCODE_RGB:
+            rowbytes = width * 3;
+            if (rowbytes % 4)
+                rowbytes = ((rowbytes / 4) + 1) * 4;
+            len = rowbytes * height;
+            break;
+        case PNGU_ENCODE_GXTEXTURE:
+            // Tiles are 4x4 texels
+            len = ((width + 3) & ~3) * ((height + 3) & ~3) * 4;
+            break;
+        default:
+            return PNGU_UNSUPPORTED_COLOR_TYPE;
+    }
+
+    if (pngu_encode_start() != PNGU_OK)
+        return PNGU_LIB_ERROR;
 
-            tmpbuffer[y * 640 * 3 + x * 3] = ptr[offset + 1];       // R
-            tmpbuffer[y * 640 * 3 + x * 3 + 1] = ptr[offset + 32];  // G
-            tmpbuffer[y * 640 * 3 + x * 3 + 2] = ptr[offset + 33];  // B
+    LWP_MutexLock(pngu_encode_mutex);
+
+    // Wait for a free slot if the queue is full
+    while (pngu_encode_count == PNGU_ENCODE_QUEUE_SIZE)
+        LWP_CondWait(pngu_encode_cond, pngu_encode_mutex);
+
+    job = &pngu_encode_queue[(pngu_encode_head + pngu_encode_count) %
+                             PNGU_ENCODE_QUEUE_SIZE];
+
+    // The copy buffer of the slot is kept between jobs and only grown
+    if (job->size < len) {
+        free(job->buffer);
+        job->buffer = memalign(32, len);
+        job->size = job->buffer ? len : 0;
+    }
+    job->filename = strdup(filename);
+    if (!job->buffer || !job->filename) {
+        free(job->filename);
+        job->filename = NULL;
+        LWP_MutexUnlock(pngu_encode_mutex);
+        return PNGU_LIB_ERROR;
+    }
+
+    memcpy(job->buffer, buffer, len);
+    job->format = format;
+    job->width = width;
+    job->height = height;
+    job->stride = stride;
+    job->callback = callback;
+    job->data = data;
+
+    pngu_encode_count++;
+    LWP_CondBroadcast(pngu_encode_cond);
+    LWP_MutexUnlock(pngu_encode_mutex);
+
+    return PNGU_OK;
+}
+
+void PNGU_WaitEncodes(void) {
+    if (pngu_encode_state != PNGU_ENCODE_RUNNING)
+        return;
+
+    LWP_MutexLock(pngu_encode_mutex);
+    while (pngu_encode_count > 0)
+        LWP_CondWait(pngu_encode_cond, pngu_encode_mutex);
+    LWP_MutexUnlock(pngu_encode_mutex);
+}
+
+void PNGU_ReleaseEncodeBuffers(void) {
+    int i;
+
+    // The queue only exists once the worker has been started, the band pool
+    // is shared with the decodes
+    if (pngu_encode_state == PNGU_ENCODE_RUNNING) {
+        LWP_MutexLock(pngu_encode_mutex);
+        while (pngu_encode_count > 0)
+            LWP_CondWait(pngu_encode_cond, pngu_encode_mutex);
+        for (i = 0; i < PNGU_ENCODE_QUEUE_SIZE; i++) {
+            free(pngu_encode_queue[i].buffer);
+            pngu_encode_queue[i].buffer = NULL;
+            pngu_encode_queue[i].size = 0;
         }
+        LWP_MutexUnlock(pngu_encode_mutex);
     }
 
-    res = PNGU_EncodeFromRGB(ctx, width, height, tmpbuffer, stride);
-    free(tmpbuffer);
-    return res;
+    PNGU_ReleaseBandBuffers();
+}
+
+void PNGU_ReleaseBandBuffers(void) {
+    png_bytep buffers[PNGU_BAND_POOL_SIZE];
+    u32 level;
+    int i;
+
+    _CPU_ISR_Disable(level);
+    for (i = 0; i < PNGU_BAND_POOL_SIZE; i++) {
+        buffers[i] = pngu_band_pool[i].buffer;
+        pngu_band_pool[i].buffer = NULL;
+        pngu_band_pool[i].size = 0;
+    }
+    _CPU_ISR_Restore(level);
+
+    for (i = 0; i < PNGU_BAND_POOL_SIZE; i++)
+        free(buffers[i]);
 }
 
-// This function is taken from a libogc example
 PNGU_u32 PNGU_RGB8_TO_YCbYCr(PNGU_u8 r1,
                              PNGU_u8 g1,
                              PNGU_u8 b1,
                              PNGU_u8 r2,
                              PNGU_u8 g2,
                              PNGU_u8 b2) {
-    int y1, cb1, cr1, y2, cb2, cr2, cb, cr;
-
-    y1 = (299 * r1 + 587 * g1 + 114 * b1) / 1000;
-    cb1 = (-16874 * r1 - 33126 * g1 + 50000 * b1 + 12800000) / 100000;
-    cr1 = (50000 * r1 - 41869 * g1 - 8131 * b1 + 12800000) / 100000;
-
-    y2 = (299 * r2 + 587 * g2 + 114 * b2) / 1000;
-    cb2 = (-16874 * r2 - 33126 * g2 + 50000 * b2 + 12800000) / 100000;
-    cr2 = (50000 * r2 - 41869 * g2 - 8131 * b2 + 12800000) / 100000;
-
-    cb = (cb1 + cb2) >> 1;
-    cr = (cr1 + cr2) >> 1;
-
-    return (PNGU_u32)((y1 << 24) | (cb << 16) | (y2 << 8) | cr);
+    return wii_ycbcr_from_rgb(r1, g1, b1, r2, g2, b2);
 }
 
 void PNGU_YCbYCr_TO_RGB8(PNGU_u32 ycbycr,
@@ -1249,20 +962,61 @@ void PNGU_YCbYCr_TO_RGB8(PNGU_u32 ycbycr,
                          PNGU_u8* r2,
                          PNGU_u8* g2,
                          PNGU_u8* b2) {
-    PNGU_u8* val = (PNGU_u8*)&ycbycr;
-    int r, g, b;
+    PNGU_u8 rgb[6];
 
-    r = 1.371f * (val[3] - 128);
-    g = -0.698f * (val[3] - 128) - 0.336f * (val[1] - 128);
-    b = 1.732f * (val[1] - 128);
+    wii_ycbcr_to_rgb(ycbycr, rgb);
 
-    *r1 = pngu_clamp(val[0] + r, 0, 255);
-    *g1 = pngu_clamp(val[0] + g, 0, 255);
-    *b1 = pngu_clamp(val[0] + b, 0, 255);
+    *r1 = rgb[0];
+    *g1 = rgb[1];
+    *b1 = rgb[2];
+    *r2 = rgb[3];
+    *g2 = rgb[4];
+    *b2 = rgb[5];
+}
 
-    *r2 = pngu_clamp(val[2] + r, 0, 255);
-    *g2 = pngu_clamp(val[2] + g, 0, 255);
-    *b2 = pngu_clamp(val[2] + b, 0, 255);
+// Maps a libpng color type to a PNGU color type
+PNGU_u32 pngu_color_type(int color_type) {
+    switch (color_type) {
+        case PNG_COLOR_TYPE_GRAY:
+            return PNGU_COLOR_TYPE_GRAY;
+        case PNG_COLOR_TYPE_GRAY_ALPHA:
+            return PNGU_COLOR_TYPE_GRAY_ALPHA;
+        case PNG_COLOR_TYPE_PALETTE:
+            return PNGU_COLOR_TYPE_PALETTE;
+        case PNG_COLOR_TYPE_RGB:
+            return PNGU_COLOR_TYPE_RGB;
+        case PNG_COLOR_TYPE_RGB_ALPHA:
+            return PNGU_COLOR_TYPE_RGB_ALPHA;
+        default:
+            return PNGU_COLOR_TYPE_UNKNOWN;
+    }
+}
+
+// Reads the image properties from the signature and IHDR chunk at the start
+// of a PNG file (the IHDR chunk must directly follow the signature). Only the
+// dimensions, bit depth and color type are filled in.
+int pngu_probe(const PNGU_u8* header, PNGUPROP* imgprop) {
+    static const PNGU_u8 signature[8] = {0x89, 'P',  'N',  'G',
+                                         '\r', '\n', 0x1A, '\n'};
+    static const PNGU_u8 ihdr[8] = {0, 0, 0, 13, 'I', 'H', 'D', 'R'};
+
+    if (memcmp(header, signature, 8) != 0)
+        return PNGU_FILE_IS_NOT_PNG;
+    if (memcmp(header + 8, ihdr, 8) != 0)
+        return PNGU_FILE_IS_NOT_PNG;
+
+    memset(imgprop, 0, sizeof(PNGUPROP));
+    imgprop->imgWidth = (header[16] << 24) | (header[17] << 16) |
+                        (header[18] << 8) | header[19];
+    imgprop->imgHeight = (header[20] << 24) | (header[21] << 16) |
+                         (header[22] << 8) | header[23];
+    imgprop->imgBitDepth = header[24];
+    imgprop->imgColorType = pngu_color_type(header[25]);
+
+    if (!imgprop->imgWidth || !imgprop->imgHeight)
+        return PNGU_INVALID_WIDTH_OR_HEIGHT;
+
+    return PNGU_OK;
 }
 
 int pngu_info(IMGCTX ctx) {
@@ -1342,26 +1096,7 @@ int pngu_info(IMGCTX ctx) {
 
         ctx->prop.imgWidth = width;
         ctx->prop.imgHeight = height;
-        switch (ctx->prop.imgColorType) {
-            case PNG_COLOR_TYPE_GRAY:
-                ctx->prop.imgColorType = PNGU_COLOR_TYPE_GRAY;
-                break;
-            case PNG_COLOR_TYPE_GRAY_ALPHA:
-                ctx->prop.imgColorType = PNGU_COLOR_TYPE_GRAY_ALPHA;
-                break;
-            case PNG_COLOR_TYPE_PALETTE:
-                ctx->prop.imgColorType = PNGU_COLOR_TYPE_PALETTE;
-                break;
-            case PNG_COLOR_TYPE_RGB:
-                ctx->prop.imgColorType = PNGU_COLOR_TYPE_RGB;
-                break;
-            case PNG_COLOR_TYPE_RGB_ALPHA:
-                ctx->prop.imgColorType = PNGU_COLOR_TYPE_RGB_ALPHA;
-                break;
-            default:
-                ctx->prop.imgColorType = PNGU_COLOR_TYPE_UNKNOWN;
-                break;
-        }
+        ctx->prop.imgColorType = pngu_color_type(ctx->prop.imgColorType);
 
         // Constant used to scale 16 bit values to 8 bit values
         scale = 1;
@@ -1429,11 +1164,10 @@ int pngu_info(IMGCTX ctx) {
     return PNGU_OK;
 }
 
-int pngu_decode(IMGCTX ctx,
-                PNGU_u32 width,
-                PNGU_u32 height,
-                PNGU_u32 stripAlpha) {
-    png_uint_32 rowbytes;
+int pngu_decode_setup(IMGCTX ctx,
+                      PNGU_u32 width,
+                      PNGU_u32 height,
+                      PNGU_u32 stripAlpha) {
     int i;
 
     // Read info if it hasn't been read before
@@ -1473,12 +1207,24 @@ int pngu_decode(IMGCTX ctx,
     // Flush transformations
     png_read_update_info(ctx->png_ptr, ctx->info_ptr);
 
-    // Allocate memory to store the image
-    rowbytes = png_get_rowbytes(ctx->png_ptr, ctx->info_ptr);
+    return PNGU_OK;
+}
+
+png_uint_32 pngu_rowbytes(IMGCTX ctx) {
+    png_uint_32 rowbytes = png_get_rowbytes(ctx->png_ptr, ctx->info_ptr);
     if (rowbytes % 4)
         rowbytes =
             ((rowbytes / 4) + 1) *
             4;  // Add extra padding so each row starts in a 4 byte boundary
+    return rowbytes;
+}
+
+int pngu_read_image(IMGCTX ctx) {
+    png_uint_32 rowbytes;
+    int i;
+
+    // Allocate memory to store the image
+    rowbytes = pngu_rowbytes(ctx);
 
     ctx->img_data = malloc(rowbytes * ctx->prop.imgHeight);
     if (!ctx->img_data) {
@@ -1506,6 +1252,378 @@ int pngu_decode(IMGCTX ctx,
     return PNGU_OK;
 }
 
+int pngu_decode(IMGCTX ctx,
+                PNGU_u32 width,
+                PNGU_u32 height,
+                PNGU_u32 stripAlpha) {
+    int result = pngu_decode_setup(ctx, width, height, stripAlpha);
+    if (result != PNGU_OK)
+        return result;
+
+    return pngu_read_image(ctx);
+}
+
+// Builds the palette lookup table of an indexed image. Entries are stored in
+// the layout of the rows passed to the swizzler: intensity (the luma of the
+// palette color, with the same weights used to convert color rows to gray)
+// for I8, intensity and alpha for IA8 and RGBA otherwise.
+void pngu_build_lut(IMGCTX ctx,
+                    pngu_tiled* t,
+                    PNGU_u32 stripAlpha,
+                    PNGU_u8 default_alpha) {
+    png_colorp palette = NULL;
+    png_bytep trans = NULL;
+    png_color_16p trans_values;
+    int num_palette = 0, num_trans = 0, i;
+
+    png_get_PLTE(ctx->png_ptr, ctx->info_ptr, &palette, &num_palette);
+    if (!stripAlpha)
+        png_get_tRNS(ctx->png_ptr, ctx->info_ptr, &trans, &num_trans,
+                     &trans_values);
+
+    memset(t->lut, 0, sizeof(t->lut));
+    for (i = 0; i < num_palette && i < 256; i++) {
+        PNGU_u8 r = palette[i].red, g = palette[i].green, b = palette[i].blue;
+        PNGU_u8 a = i < num_trans ? trans[i] : default_alpha;
+        if (t->layout == WII_SWIZZLE_SRC_RGBA8) {
+            t->lut[i][0] = r;
+            t->lut[i][1] = g;
+            t->lut[i][2] = b;
+            t->lut[i][3] = a;
+        } else {
+            t->lut[i][0] = (r * 77 + g * 150 + b * 29) >> 8;
+            t->lut[i][1] = a;
+        }
+    }
+}
+
+// Prepares the tiled decode of the image into the specified texture format.
+// Gray images are kept gray for the intensity formats (color images are
+// converted to gray), indexed images are expanded through a palette lookup
+// table and interlaced images are decoded in full.
+int pngu_tiled_setup(IMGCTX ctx,
+                     PNGU_u32 width,
+                     PNGU_u32 height,
+                     PNGU_u8 format,
+                     PNGU_u8 default_alpha,
+                     pngu_tiled* t) {
+    png_uint_32 rowbytes;
+    int gray, alpha, stripAlpha, i;
+
+    memset(t, 0, sizeof(pngu_tiled));
+
+    // Check if the texture format is supported
+    if ((format != GX_TF_I8) && (format != GX_TF_IA8) &&
+        (format != GX_TF_RGB565) && (format != GX_TF_RGB5A3) &&
+        (format != GX_TF_RGBA8))
+        return PNGU_UNSUPPORTED_COLOR_TYPE;
+
+    // Read info if it hasn't been read before
+    if (!ctx->infoRead) {
+        i = pngu_info(ctx);
+        if (i != PNGU_OK)
+            return i;
+    }
+
+    // Check if the user has specified the real width and height of the image
+    if ((ctx->prop.imgWidth != width) || (ctx->prop.imgHeight != height))
+        return PNGU_INVALID_WIDTH_OR_HEIGHT;
+
+    // Check if color type is supported by PNGU
+    if (ctx->prop.imgColorType == PNGU_COLOR_TYPE_UNKNOWN)
+        return PNGU_UNSUPPORTED_COLOR_TYPE;
+
+    // Formats without alpha drop the alpha channel, intensity formats are
+    // decoded from gray rows
+    stripAlpha = (format == GX_TF_RGB565) || (format == GX_TF_I8);
+    gray = (format == GX_TF_I8) || (format == GX_TF_IA8);
+
+    // Scale 16 bit samples to 8 bit
+    if (ctx->prop.imgBitDepth == 16)
+        png_set_strip_16(ctx->png_ptr);
+
+    if (ctx->prop.imgColorType == PNGU_COLOR_TYPE_PALETTE) {
+        // Expand 1, 2 and 4 bit indices to a byte each
+        if (ctx->prop.imgBitDepth < 8)
+            png_set_packing(ctx->png_ptr);
+
+        t->indexed = 1;
+        t->layout = gray ? (format == GX_TF_IA8 ? WII_SWIZZLE_SRC_IA8
+                                                : WII_SWIZZLE_SRC_I8)
+                         : WII_SWIZZLE_SRC_RGBA8;
+        pngu_build_lut(ctx, t, stripAlpha, default_alpha);
+    } else {
+        alpha = (ctx->prop.imgColorType == PNGU_COLOR_TYPE_GRAY_ALPHA) ||
+                (ctx->prop.imgColorType == PNGU_COLOR_TYPE_RGB_ALPHA);
+
+        // Expand 1, 2 and 4 bit gray samples to 8 bit
+        if (ctx->prop.imgBitDepth < 8)
+            png_set_expand_gray_1_2_4_to_8(ctx->png_ptr);
+
+        // Convert between gray and color as required by the format
+        if (gray && ((ctx->prop.imgColorType == PNGU_COLOR_TYPE_RGB) ||
+                     (ctx->prop.imgColorType == PNGU_COLOR_TYPE_RGB_ALPHA)))
+            png_set_rgb_to_gray_fixed(ctx->png_ptr, 1, 29900, 58700);
+        else if (!gray &&
+                 ((ctx->prop.imgColorType == PNGU_COLOR_TYPE_GRAY) ||
+                  (ctx->prop.imgColorType == PNGU_COLOR_TYPE_GRAY_ALPHA)))
+            png_set_gray_to_rgb(ctx->png_ptr);
+
+        // Remove the alpha channel if we don't need it, intensity and alpha
+        // rows get the default alpha
+        if (alpha && stripAlpha) {
+            png_set_strip_alpha(ctx->png_ptr);
+            alpha = 0;
+        } else if (!alpha && (format == GX_TF_IA8)) {
+            png_set_add_alpha(ctx->png_ptr, default_alpha, PNG_FILLER_AFTER);
+            alpha = 1;
+        }
+
+        if (gray)
+            t->layout = alpha ? WII_SWIZZLE_SRC_IA8 : WII_SWIZZLE_SRC_I8;
+        else
+            t->layout = alpha ? WII_SWIZZLE_SRC_RGBA8 : WII_SWIZZLE_SRC_RGB8;
+    }
+
+    switch (t->layout) {
+        case WII_SWIZZLE_SRC_I8:
+            t->bytes = 1;
+            break;
+        case WII_SWIZZLE_SRC_IA8:
+            t->bytes = 2;
+            break;
+        case WII_SWIZZLE_SRC_RGB8:
+            t->bytes = 3;
+            break;
+        default:
+            t->bytes = 4;
+            break;
+    }
+
+    // Interlaced images are only complete after the last pass, so they
+    // have to be decoded in full
+    t->interlaced = png_set_interlace_handling(ctx->png_ptr) > 1;
+
+    // Flush transformations
+    png_read_update_info(ctx->png_ptr, ctx->info_ptr);
+
+    // Rows need room for both the decoded and the expanded pixels
+    rowbytes = pngu_rowbytes(ctx);
+    t->rowbytes = width * t->bytes;
+    if (t->rowbytes < rowbytes)
+        t->rowbytes = rowbytes;
+
+    if (t->interlaced)
+        return pngu_read_image(ctx);
+
+    if (t->indexed) {
+        t->row = malloc(rowbytes);
+        if (!t->row) {
+            pngu_free_info(ctx);
+            return PNGU_LIB_ERROR;
+        }
+    }
+
+    return PNGU_OK;
+}
+
+// Returns the next row of a tiled decode in the layout passed to the
+// swizzler. Rows read from libpng or expanded through the palette are stored
+// in the specified buffer (of the tiled decode's row size).
+png_bytep pngu_tiled_row(IMGCTX ctx,
+                         pngu_tiled* t,
+                         PNGU_u32 y,
+                         png_bytep buffer) {
+    png_bytep src;
+    PNGU_u32 x;
+
+    if (t->interlaced)
+        src = ctx->row_pointers[y];
+    else {
+        src = t->indexed ? t->row : buffer;
+        png_read_row(ctx->png_ptr, src, NULL);
+    }
+
+    if (!t->indexed)
+        return src;
+
+    // Expand the indices through the palette
+    switch (t->bytes) {
+        case 1:
+            for (x = 0; x < ctx->prop.imgWidth; x++)
+                buffer[x] = t->lut[src[x]][0];
+            break;
+        case 2:
+            for (x = 0; x < ctx->prop.imgWidth; x++) {
+                buffer[(x << 1)] = t->lut[src[x]][0];
+                buffer[(x << 1) + 1] = t->lut[src[x]][1];
+            }
+            break;
+        default:
+            for (x = 0; x < ctx->prop.imgWidth; x++)
+                memcpy(buffer + (x << 2), t->lut[src[x]], 4);
+            break;
+    }
+
+    return buffer;
+}
+
+// Releases the resources of a tiled decode
+void pngu_tiled_free(IMGCTX ctx, pngu_tiled* t) {
+    free(t->row);
+    t->row = NULL;
+
+    if (t->interlaced) {
+        free(ctx->img_data);
+        free(ctx->row_pointers);
+    } else {
+        pngu_free_info(ctx);
+    }
+}
+
+// Decodes the image and swizzles it into the tiles of a GX texture. Rows are
+// read a band of four at a time and swizzled directly into the output, so
+// only four decoded rows are held in memory.
+int pngu_decode_4x4(IMGCTX ctx,
+                    PNGU_u32 width,
+                    PNGU_u32 height,
+                    void* buffer,
+                    PNGU_u8 format,
+                    PNGU_u8 default_alpha) {
+    pngu_tiled t;
+    png_bytep band;
+    png_bytep band_rows[4];
+    int result;
+    PNGU_u32 y, bandSize;
+
+    // width needs to be divisible by the tile width (eight for I8) and height
+    // by four
+    if ((width % (format == GX_TF_I8 ? 8 : 4)) || (height % 4))
+        return PNGU_INVALID_WIDTH_OR_HEIGHT;
+
+    result = pngu_tiled_setup(ctx, width, height, format, default_alpha, &t);
+    if (result != PNGU_OK)
+        return result;
+
+    band = pngu_band_acquire(t.rowbytes * 4, &bandSize);
+    if (!band) {
+        pngu_tiled_free(ctx, &t);
+        return PNGU_LIB_ERROR;
+    }
+
+    // Copy image to the output buffer, a band of tiles at a time
+    for (y = 0; y < height; y++) {
+        band_rows[y % 4] =
+            pngu_tiled_row(ctx, &t, y, band + ((y % 4) * t.rowbytes));
+        if ((y % 4) == 3)
+            wii_swizzle_rows(format, t.layout, (const u8* const*)band_rows, 0,
+                             width, 4, default_alpha, buffer, width, 0, y - 3);
+    }
+
+    // Free resources
+    pngu_band_release(band, bandSize);
+    pngu_tiled_free(ctx, &t);
+
+    // Success
+    return PNGU_OK;
+}
+
+// Decodes the image, box filtering it down to the destination size, and
+// swizzles it into the tiles of a GX texture. Each destination row is the
+// average of the source rows it covers, which are read one at a time, so only
+// a single source row and four destination rows are held in memory.
+int pngu_decode_4x4_scaled(IMGCTX ctx,
+                           PNGU_u32 width,
+                           PNGU_u32 height,
+                           void* buffer,
+                           PNGU_u32 dstWidth,
+                           PNGU_u32 dstHeight,
+                           PNGU_u8 format,
+                           PNGU_u8 default_alpha) {
+    pngu_tiled t;
+    png_bytep row = NULL;
+    png_bytep band = NULL;
+    png_bytep band_rows[4];
+    PNGU_u32* sums = NULL;
+    PNGU_u32* xstart = NULL;
+    PNGU_u32 x, y, sy, yend, count, c, channels, bandSize = 0;
+    int result, i;
+
+    // The destination size needs to be divisible by the tile size and the
+    // image can only be scaled down
+    if (!dstWidth || !dstHeight || (dstWidth % (format == GX_TF_I8 ? 8 : 4)) ||
+        (dstHeight % 4) || (dstWidth > width) || (dstHeight > height))
+        return PNGU_INVALID_WIDTH_OR_HEIGHT;
+
+    result = pngu_tiled_setup(ctx, width, height, format, default_alpha, &t);
+    if (result != PNGU_OK)
+        return result;
+    channels = t.bytes;
+
+    row = malloc(t.rowbytes);
+    band = pngu_band_acquire(dstWidth * channels * 4, &bandSize);
+    sums = malloc(dstWidth * channels * sizeof(PNGU_u32));
+    xstart = malloc((dstWidth + 1) * sizeof(PNGU_u32));
+    if (!row || !band || !sums || !xstart) {
+        result = PNGU_LIB_ERROR;
+        goto done;
+    }
+
+    // First source column of each destination column
+    for (x = 0; x <= dstWidth; x++)
+        xstart[x] = x * width / dstWidth;
+    for (i = 0; i < 4; i++)
+        band_rows[i] = band + (i * dstWidth * channels);
+
+    for (y = 0, sy = 0; y < dstHeight; y++) {
+        png_bytep out = band_rows[y % 4];
+        PNGU_u32* sum;
+
+        // Sum the boxes of the source rows covered by this destination row
+        yend = (y + 1) * height / dstHeight;
+        count = yend - sy;
+        memset(sums, 0, dstWidth * channels * sizeof(PNGU_u32));
+        for (; sy < yend; sy++) {
+            png_bytep src = pngu_tiled_row(ctx, &t, sy, row);
+
+            sum = sums;
+            for (x = 0; x < dstWidth; x++, sum += channels) {
+                png_bytep p = src + xstart[x] * channels;
+                png_bytep end = src + xstart[x + 1] * channels;
+                for (; p < end; p += channels)
+                    for (c = 0; c < channels; c++)
+                        sum[c] += p[c];
+            }
+        }
+
+        // Average the boxes (rounded)
+        sum = sums;
+        for (x = 0; x < dstWidth; x++, sum += channels) {
+            PNGU_u32 n = count * (xstart[x + 1] - xstart[x]);
+            for (c = 0; c < channels; c++)
+                *out++ = (sum[c] + (n >> 1)) / n;
+        }
+
+        // Copy each completed band of tiles to the output buffer
+        if ((y % 4) == 3)
+            wii_swizzle_rows(format, t.layout, (const u8* const*)band_rows, 0,
+                             dstWidth, 4, default_alpha, buffer, dstWidth, 0,
+                             y - 3);
+    }
+
+    result = PNGU_OK;
+
+done:
+    // Free resources
+    free(row);
+    pngu_band_release(band, bandSize);
+    free(sums);
+    free(xstart);
+    pngu_tiled_free(ctx, &t);
+
+    return result;
+}
+
 void pngu_free_info(IMGCTX ctx) {
     if (ctx->infoRead) {
         if (ctx->source == PNGU_SOURCE_DEVICE)
@@ -1541,12 +1659,178 @@ void pngu_flush_data_to_buffer(png_structp png_ptr) {
     // Nothing to do here
 }
 
-// Function used in YCbYCr to RGB decoding
-int pngu_clamp(int value, int min, int max) {
-    if (value < min)
-        value = min;
-    else if (value > max)
-        value = max;
+// Applies the compression options to the PNG being written
+void pngu_set_compression(IMGCTX ctx) {
+    int level = pngu_encode_level;
+    int strategy = pngu_encode_strategy;
+    int filters = pngu_encode_filters;
+
+    if (!pngu_encode_options_set && pngu_encode_state == PNGU_ENCODE_RUNNING &&
+        LWP_GetSelf() == pngu_encode_thread) {
+        level = PNGU_ENCODE_ASYNC_LEVEL;
+        strategy = PNGU_ENCODE_ASYNC_STRATEGY;
+        filters = PNGU_ENCODE_ASYNC_FILTERS;
+    }
+
+    if (level >= 0)
+        png_set_compression_level(ctx->png_ptr, level);
+    if (strategy >= 0)
+        png_set_compression_strategy(ctx->png_ptr, strategy);
+    if (filters > 0)
+        png_set_filter(ctx->png_ptr, PNG_FILTER_TYPE_BASE, filters);
+}
+
+// Takes a band buffer of at least the specified size from the pool, the
+// largest one if none is large enough (it is grown), or allocates a new one
+// if the pool is empty. Returns the buffer and its size (capacity).
+png_bytep pngu_band_acquire(PNGU_u32 size, PNGU_u32* capacity) {
+    png_bytep band = NULL;
+    PNGU_u32 bandSize = 0;
+    u32 level;
+    int i, best = -1;
+
+    _CPU_ISR_Disable(level);
+    for (i = 0; i < PNGU_BAND_POOL_SIZE; i++) {
+        if (pngu_band_pool[i].buffer &&
+            (best < 0 || pngu_band_pool[i].size > pngu_band_pool[best].size))
+            best = i;
+    }
+    if (best >= 0) {
+        band = pngu_band_pool[best].buffer;
+        bandSize = pngu_band_pool[best].size;
+        pngu_band_pool[best].buffer = NULL;
+        pngu_band_pool[best].size = 0;
+    }
+    _CPU_ISR_Restore(level);
+
+    if (bandSize < size) {
+        free(band);
+        band = malloc(size);
+        bandSize = band ? size : 0;
+    }
+
+    *capacity = bandSize;
+    return band;
+}
+
+// Returns a band buffer to the pool, or frees it if the pool is full
+void pngu_band_release(png_bytep band, PNGU_u32 capacity) {
+    u32 level;
+    int i;
+
+    if (!band)
+        return;
+
+    _CPU_ISR_Disable(level);
+    for (i = 0; i < PNGU_BAND_POOL_SIZE; i++) {
+        if (!pngu_band_pool[i].buffer) {
+            pngu_band_pool[i].buffer = band;
+            pngu_band_pool[i].size = capacity;
+            band = NULL;
+            break;
+        }
+    }
+    _CPU_ISR_Restore(level);
+
+    free(band);
+}
+
+// Starts the encode worker, if it isn't running yet. The first caller starts
+// it, concurrent callers wait until it is running (or failed to start).
+int pngu_encode_start(void) {
+    u32 level;
+    int state;
+
+    _CPU_ISR_Disable(level);
+    state = pngu_encode_state;
+    if (state == PNGU_ENCODE_STOPPED)
+        pngu_encode_state = PNGU_ENCODE_STARTING;
+    _CPU_ISR_Restore(level);
+
+    if (state == PNGU_ENCODE_STARTING) {
+        // Sleep rather than yield, the starting thread may have a lower
+        // priority
+        while (pngu_encode_state == PNGU_ENCODE_STARTING)
+            usleep(1000);
+        state = pngu_encode_state;
+    }
+    if (state == PNGU_ENCODE_RUNNING)
+        return PNGU_OK;
+    if (state != PNGU_ENCODE_STOPPED)
+        return PNGU_LIB_ERROR;
+
+    if (LWP_MutexInit(&pngu_encode_mutex, false) != 0) {
+        pngu_encode_state = PNGU_ENCODE_STOPPED;
+        return PNGU_LIB_ERROR;
+    }
+    if (LWP_CondInit(&pngu_encode_cond) != 0) {
+        LWP_MutexDestroy(pngu_encode_mutex);
+        pngu_encode_state = PNGU_ENCODE_STOPPED;
+        return PNGU_LIB_ERROR;
+    }
+
+    // Lower priority than the emulation, so encoding only takes idle time
+    if (LWP_CreateThread(&pngu_encode_thread, pngu_encode_worker, NULL, NULL,
+                         PNGU_ENCODE_STACK_SIZE, PNGU_ENCODE_PRIORITY) != 0) {
+        pngu_encode_thread = LWP_THREAD_NULL;
+        LWP_CondDestroy(pngu_encode_cond);
+        LWP_MutexDestroy(pngu_encode_mutex);
+        pngu_encode_state = PNGU_ENCODE_STOPPED;
+        return PNGU_LIB_ERROR;
+    }
+
+    pngu_encode_state = PNGU_ENCODE_RUNNING;
+    return PNGU_OK;
+}
+
+// Encodes the queued images, one at a time in the order they were queued
+void* pngu_encode_worker(void* arg) {
+    pngu_encode_job* job;
+    IMGCTX ctx;
+    int result;
+
+    while (1) {
+        LWP_MutexLock(pngu_encode_mutex);
+        while (pngu_encode_count == 0)
+            LWP_CondWait(pngu_encode_cond, pngu_encode_mutex);
+        job = &pngu_encode_queue[pngu_encode_head];
+        LWP_MutexUnlock(pngu_encode_mutex);
+
+        // The slot isn't reused until it is released below
+        ctx = PNGU_SelectImageFromDevice(job->filename);
+        if (!ctx)
+            result = PNGU_LIB_ERROR;
+        else {
+            switch (job->format) {
+                case PNGU_ENCODE_YCbYCr:
+                    result = PNGU_EncodeFromYCbYCr(ctx, job->width, job->height,
+                                                   job->buffer, job->stride);
+                    break;
+                case PNGU_ENCODE_RGB:
+                    result = PNGU_EncodeFromRGB(ctx, job->width, job->height,
+                                                job->buffer, job->stride);
+                    break;
+                default:
+                    result = PNGU_EncodeFromGXTexture(ctx, job->width,
+                                                      job->height, job->buffer,
+                                                      job->stride);
+                    break;
+            }
+            PNGU_ReleaseImageContext(ctx);
+        }
+
+        if (job->callback)
+            job->callback(result, job->filename, job->data);
+
+        free(job->filename);
+        job->filename = NULL;
+
+        LWP_MutexLock(pngu_encode_mutex);
+        pngu_encode_head = (pngu_encode_head + 1) % PNGU_ENCODE_QUEUE_SIZE;
+        pngu_encode_count--;
+        LWP_CondBroadcast(pngu_encode_cond);
+        LWP_MutexUnlock(pngu_encode_mutex);
+    }
 
-    return value;
+    return NULL;
 }
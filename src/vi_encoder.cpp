@@ -54,6 +54,16 @@
 
 extern "C" void udelay(int us);
 
+#ifdef VI_ENCODER_I2C_STUB
+
+// Host tests provide the I2C transaction (which records the writes) and the
+// VI registers
+extern "C" u32 __VISendI2CData(u8 addr, void* val, u32 len);
+extern vu16 __viStubRegs[];
+static vu16* const _viReg = __viStubRegs;
+
+#else
+
 static u32 i2cIdentFirst = 0;
 static u32 i2cIdentFlag = 1;
 static vu16* const _viReg = (u16*)0xCC002000;
@@ -192,12 +202,109 @@ static u32 __VISendI2CData(u8 addr, void* val, u32 len) {
     return 1;
 }
 
+#endif
+
+/****************************************************************************
+ *  Shadow registers
+ *
+ *  The values last written to each encoder register. A write that doesn't
+ *  change any of the registers it covers is skipped, saving its bit-banged
+ *  I2C transaction.
+ ****************************************************************************/
+
+static u8 __viShadowRegs[0x100];
+static u8 __viShadowKnown[0x100];
+static u32 __viI2CIssued = 0;
+static u32 __viI2CSkipped = 0;
+
+/****************************************************************************
+ *  Queued registers
+ *
+ *  Register values waiting for VIDEO_FlushEncoderUpdates. Queuing the same
+ *  register again replaces its pending value.
+ ****************************************************************************/
+
+static u8 __viPendingRegs[0x100];
+static u8 __viPending[0x100];
+static u32 __viPendingFirst = 0x100;
+static u32 __viPendingLast = 0;
+static VIRetraceCallback __viPrevPostCallback = NULL;
+static BOOL __viRetraceFlush = FALSE;
+
+// Known registers between two pending runs are resent rather than starting
+// a new transaction (slave address, register and stop cost about 2 bytes)
+#define VI_BURST_MAX_GAP 2
+
+static void __VIWriteI2CShadowed(u8* buf, u32 len, BOOL direct) {
+    u8 reg = buf[0];
+    u32 i, level;
+
+    // Keeps the shadow in step with a flush from the retrace interrupt
+    _CPU_ISR_Disable(level);
+
+    // A direct write supersedes queued values of the same registers
+    if (direct) {
+        for (i = 1; i < len; i++, reg++) {
+            __viPending[reg] = 0;
+        }
+        reg = buf[0];
+    }
+
+    for (i = 1; i < len; i++, reg++) {
+        if (!__viShadowKnown[reg] || __viShadowRegs[reg] != buf[i])
+            break;
+    }
+    if (i == len) {
+        __viI2CSkipped++;
+        _CPU_ISR_Restore(level);
+        return;
+    }
+
+    __viI2CIssued++;
+    u32 ret = __VISendI2CData(0xe0, buf, len);
+
+    // The registers are unknown after a failed write
+    reg = buf[0];
+    for (i = 1; i < len; i++, reg++) {
+        __viShadowRegs[reg] = buf[i];
+        __viShadowKnown[reg] = ret;
+    }
+
+    _CPU_ISR_Restore(level);
+    udelay(2);
+}
+
+static void __VIQueueI2CRegisterBuf(u8 reg, u32 size, const u8* data) {
+    u32 i, level;
+
+    _CPU_ISR_Disable(level);
+    if (reg < __viPendingFirst)
+        __viPendingFirst = reg;
+    if (reg + size - 1 > __viPendingLast)
+        __viPendingLast = reg + size - 1;
+    for (i = 0; i < size; i++) {
+        __viPendingRegs[reg + i] = data[i];
+        __viPending[reg + i] = 1;
+    }
+    _CPU_ISR_Restore(level);
+}
+
+static void __VIQueueI2CRegister8(u8 reg, u8 data) {
+    __VIQueueI2CRegisterBuf(reg, 1, &data);
+}
+
+static void __VIQueueI2CRegister16(u8 reg, u16 data) {
+    u8 buf[2];
+    buf[0] = data >> 8;
+    buf[1] = data & 0xFF;
+    __VIQueueI2CRegisterBuf(reg, 2, buf);
+}
+
 static void __VIWriteI2CRegister8(u8 reg, u8 data) {
     u8 buf[2];
     buf[0] = reg;
     buf[1] = data;
-    __VISendI2CData(0xe0, buf, 2);
-    udelay(2);
+    __VIWriteI2CShadowed(buf, 2, TRUE);
 }
 
 static void __VIWriteI2CRegister16(u8 reg, u16 data) {
@@ -205,8 +312,7 @@ static void __VIWriteI2CRegister16(u8 reg, u16 data) {
     buf[0] = reg;
     buf[1] = data >> 8;
     buf[2] = data & 0xFF;
-    __VISendI2CData(0xe0, buf, 3);
-    udelay(2);
+    __VIWriteI2CShadowed(buf, 3, TRUE);
 }
 
 static void __VIWriteI2CRegister32(u8 reg, u32 data) {
@@ -216,16 +322,14 @@ static void __VIWriteI2CRegister32(u8 reg, u32 data) {
     buf[2] = (data >> 16) & 0xFF;
     buf[3] = (data >> 8) & 0xFF;
     buf[4] = data & 0xFF;
-    __VISendI2CData(0xe0, buf, 5);
-    udelay(2);
+    __VIWriteI2CShadowed(buf, 5, TRUE);
 }
 
 static void __VIWriteI2CRegisterBuf(u8 reg, int size, u8* data) {
     u8 buf[0x100];
     buf[0] = reg;
     memcpy(&buf[1], data, size);
-    __VISendI2CData(0xe0, buf, size + 1);
-    udelay(2);
+    __VIWriteI2CShadowed(buf, size + 1, TRUE);
 }
 
 /****************************************************************************
@@ -429,12 +533,13 @@ void __VISetWSS(u16 value) {
     __VIWriteI2CRegister16(0x08, value);
 }
 
-void __VISetRGBOverDrive(u8 value) {
+static u8 __VIGetRGBOverDrive(u8 value) {
     u32 currTvMode = _SHIFTR(_viReg[1], 8, 2);
-    if (currTvMode == VI_DEBUG)
-        __VIWriteI2CRegister8(0x0A, (value << 1) | 1);
-    else
-        __VIWriteI2CRegister8(0x0A, 0);
+    return currTvMode == VI_DEBUG ? (value << 1) | 1 : 0;
+}
+
+void __VISetRGBOverDrive(u8 value) {
+    __VIWriteI2CRegister8(0x0A, __VIGetRGBOverDrive(value));
 }
 
 void __VISetOverSampling(void) {
@@ -469,16 +574,127 @@ void VIDEO_SetGamma(VIGamma gamma) {
 }
 
 void VIDEO_SetTrapFilter(int enable) {
-    static int curvalue = -1;
+    if (enable)
+        __VISetTrapFilter(0);
+    else
+        __VISetTrapFilter(1);
+}
+
+void VIDEO_InvalidateEncoderState(void) {
+    memset(__viShadowKnown, 0, sizeof(__viShadowKnown));
+}
+
+/* Queued updates */
+
+void VIDEO_QueueGamma(VIGamma gamma) {
+    __VIQueueI2CRegisterBuf(0x10, 0x21, &gamma_coeffs[gamma][0]);
+}
+
+void VIDEO_QueueTrapFilter(int enable) {
+    __VIQueueI2CRegister8(0x03, enable ? 1 : 0);
+}
+
+void VIDEO_QueueWSS(u16 value) {
+    __VIQueueI2CRegister16(0x08, value);
+}
+
+void VIDEO_QueueRGBOverDrive(u8 value) {
+    __VIQueueI2CRegister8(0x0A, __VIGetRGBOverDrive(value));
+}
 
-    if (curvalue == enable) {
+// Clears the pending flag of a register, returns whether it was pending with
+// a value the encoder doesn't hold (called with interrupts disabled)
+static BOOL __VITakePending(u32 reg) {
+    if (!__viPending[reg])
+        return FALSE;
+    __viPending[reg] = 0;
+    return !__viShadowKnown[reg] ||
+           __viShadowRegs[reg] != __viPendingRegs[reg];
+}
+
+void VIDEO_FlushEncoderUpdates(void) {
+    u32 level;
+
+    // Each run is taken and sent with interrupts disabled, so a direct write
+    // or a flush from the retrace interrupt can't come between them (and be
+    // overwritten by a stale value). Interrupts are served between the runs.
+    for (;;) {
+        _CPU_ISR_Disable(level);
+
+        // Skips the pending registers the encoder holds already
+        u32 reg = __viPendingFirst;
+        u32 last = __viPendingLast;
+        for (; reg <= last; reg++) {
+            if (__VITakePending(reg))
+                break;
+        }
+        if (reg > last) {
+            __viPendingFirst = 0x100;
+            __viPendingLast = 0;
+            _CPU_ISR_Restore(level);
+            return;
+        }
+
+        // Extends the burst over later pending registers, bridging short
+        // gaps of registers whose values are known
+        u8 buf[0x101];
+        u32 start = reg, end = reg, gap = 0;
+        buf[1] = __viPendingRegs[reg];
+        for (reg++; reg <= last; reg++) {
+            if (__VITakePending(reg)) {
+                buf[reg - start + 1] = __viPendingRegs[reg];
+                end = reg;
+                gap = 0;
+                continue;
+            }
+            if (!__viShadowKnown[reg] || ++gap > VI_BURST_MAX_GAP)
+                break;
+            buf[reg - start + 1] = __viShadowRegs[reg];
+        }
+        __viPendingFirst = end + 1;
+
+        // Sent as one transaction, register address first
+        buf[0] = start;
+        __VIWriteI2CShadowed(buf, end - start + 2, FALSE);
+
+        _CPU_ISR_Restore(level);
+    }
+}
+
+static void __VIEncoderRetraceCallback(u32 retraceCnt) {
+    VIDEO_FlushEncoderUpdates();
+    if (__viPrevPostCallback)
+        __viPrevPostCallback(retraceCnt);
+}
+
+void VIDEO_SetEncoderRetraceFlush(BOOL enable) {
+    if (enable == __viRetraceFlush)
         return;
+
+    __viRetraceFlush = enable;
+    if (enable) {
+        __viPrevPostCallback =
+            VIDEO_SetPostRetraceCallback(__VIEncoderRetraceCallback);
+    } else {
+        // The previous callback is restored only if ours is still installed,
+        // a callback set after ours is kept
+        u32 level;
+        _CPU_ISR_Disable(level);
+        VIRetraceCallback current =
+            VIDEO_SetPostRetraceCallback(__viPrevPostCallback);
+        if (current != __VIEncoderRetraceCallback)
+            VIDEO_SetPostRetraceCallback(current);
+        __viPrevPostCallback = NULL;
+        _CPU_ISR_Restore(level);
     }
+}
 
-    curvalue = enable;
+void VIDEO_GetEncoderStats(VIEncoderStats* stats) {
+    stats->issued = __viI2CIssued;
+    stats->skipped = __viI2CSkipped;
+}
 
-    if (enable)
-        __VISetTrapFilter(0);
-    else
-        __VISetTrapFilter(1);
+void VIDEO_ResetEncoderStats(void) {
+    __viI2CIssued = 0;
+    __viI2CSkipped = 0;
 }
@@ -0,0 +1,332 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#include <string.h>
+
+#include "wii_filter.h"
+
+//
+// The filters are templated by the pixel type and by how pixels are
+// darkened. Each source row is filtered into its first destination row, the
+// remaining destination rows are copies of it (or darkened copies).
+//
+
+/**
+ * Darkens 8bpp pixels to black (palette indices cannot be darkened)
+ */
+struct FilterDark8 {
+    u8 black;
+
+    FilterDark8(u32 black) : black((u8)black) {}
+    inline u8 operator()(u8) const { return black; }
+};
+
+/**
+ * Darkens RGB565 pixels by half
+ */
+struct FilterDark16 {
+    FilterDark16(u32) {}
+    inline u16 operator()(u16 p) const { return (p >> 1) & 0x7bef; }
+};
+
+/**
+ * Darkens 32bpp pixels by half
+ */
+struct FilterDark32 {
+    FilterDark32(u32) {}
+    inline u32 operator()(u32 p) const { return (p >> 1) & 0x7f7f7f7f; }
+};
+
+/**
+ * Returns the specified row of an image
+ *
+ * @param   base The first row
+ * @param   pitch The distance between the rows in bytes
+ * @param   y The row
+ * @return  The row
+ */
+template <typename Pixel>
+static inline Pixel* filter_row(const void* base, int pitch, int y) {
+    return (Pixel*)((u8*)base + (y * pitch));
+}
+
+/**
+ * Scale2x (AdvMAME2x). A source pixel is split into four, each takes the
+ * color of the adjacent neighbours when they match and the pixel lies on an
+ * edge.
+ */
+template <typename Pixel, class Dark>
+struct FilterScale2x {
+    static void row(const Pixel* b, const Pixel* e, const Pixel* h, u8* dst,
+                    int dstPitch, int width, int, const Dark&) {
+        Pixel* d0 = (Pixel*)dst;
+        Pixel* d1 = (Pixel*)(dst + dstPitch);
+        int last = width - 1;
+        for (int x = 0; x < width; x++, d0 += 2, d1 += 2) {
+            Pixel B = b[x], E = e[x], H = h[x];
+            Pixel D = e[x > 0 ? x - 1 : 0];
+            Pixel F = e[x < last ? x + 1 : last];
+            if (B != H && D != F) {
+                d0[0] = D == B ? D : E;
+                d0[1] = B == F ? F : E;
+                d1[0] = D == H ? D : E;
+                d1[1] = H == F ? F : E;
+            } else {
+                d0[0] = d0[1] = d1[0] = d1[1] = E;
+            }
+        }
+    }
+};
+
+/**
+ * Scale3x (AdvMAME3x). A source pixel is split into nine, edges take the
+ * color of the matching neighbours.
+ */
+template <typename Pixel, class Dark>
+struct FilterScale3x {
+    static void row(const Pixel* b, const Pixel* e, const Pixel* h, u8* dst,
+                    int dstPitch, int width, int, const Dark&) {
+        Pixel* d0 = (Pixel*)dst;
+        Pixel* d1 = (Pixel*)(dst + dstPitch);
+        Pixel* d2 = (Pixel*)(dst + (dstPitch << 1));
+        int last = width - 1;
+        for (int x = 0; x < width; x++, d0 += 3, d1 += 3, d2 += 3) {
+            int l = x > 0 ? x - 1 : 0;
+            int r = x < last ? x + 1 : last;
+            Pixel B = b[x], D = e[l], E = e[x], F = e[r], H = h[x];
+            if (B != H && D != F) {
+                Pixel A = b[l], C = b[r], G = h[l], I = h[r];
+                d0[0] = D == B ? D : E;
+                d0[1] = (D == B && E != C) || (B == F && E != A) ? B : E;
+                d0[2] = B == F ? F : E;
+                d1[0] = (D == B && E != G) || (D == H && E != A) ? D : E;
+                d1[1] = E;
+                d1[2] = (B == F && E != I) || (H == F && E != C) ? F : E;
+                d2[0] = D == H ? D : E;
+                d2[1] = (D == H && E != I) || (H == F && E != G) ? H : E;
+                d2[2] = H == F ? F : E;
+            } else {
+                d0[0] = d0[1] = d0[2] = E;
+                d1[0] = d1[1] = d1[2] = E;
+                d2[0] = d2[1] = d2[2] = E;
+            }
+        }
+    }
+};
+
+/**
+ * Scanlines. The pixels are scaled by duplication and the last row of each
+ * scaled pixel is darkened.
+ */
+template <typename Pixel, class Dark>
+struct FilterScanlines {
+    static void row(const Pixel*, const Pixel* e, const Pixel*, u8* dst,
+                    int dstPitch, int width, int scale, const Dark& dark) {
+        Pixel* d = (Pixel*)dst;
+        for (int x = 0; x < width; x++) {
+            Pixel p = e[x];
+            for (int j = 0; j < scale; j++) {
+                *d++ = p;
+            }
+        }
+        int rowBytes = width * scale * sizeof(Pixel);
+        u8* out = dst + dstPitch;
+        for (int i = 2; i < scale; i++, out += dstPitch) {
+            memcpy(out, dst, rowBytes);
+        }
+        const Pixel* s = (const Pixel*)dst;
+        d = (Pixel*)out;
+        for (int x = width * scale; x > 0; x--) {
+            *d++ = dark(*s++);
+        }
+    }
+};
+
+/**
+ * LCD grid. The pixels are scaled by duplication and the last row and
+ * column of each scaled pixel are darkened.
+ */
+template <typename Pixel, class Dark>
+struct FilterLcdGrid {
+    static void row(const Pixel*, const Pixel* e, const Pixel*, u8* dst,
+                    int dstPitch, int width, int scale, const Dark& dark) {
+        Pixel* d = (Pixel*)dst;
+        for (int x = 0; x < width; x++) {
+            Pixel p = e[x];
+            for (int j = 1; j < scale; j++) {
+                *d++ = p;
+            }
+            *d++ = dark(p);
+        }
+        int rowBytes = width * scale * sizeof(Pixel);
+        u8* out = dst + dstPitch;
+        for (int i = 2; i < scale; i++, out += dstPitch) {
+            memcpy(out, dst, rowBytes);
+        }
+        // The last row is darkened from the source, so the corner is not
+        // darkened twice
+        d = (Pixel*)out;
+        for (int x = 0; x < width; x++) {
+            Pixel p = dark(e[x]);
+            for (int j = 0; j < scale; j++) {
+                *d++ = p;
+            }
+        }
+    }
+};
+
+/**
+ * Filters a range of source rows
+ */
+template <template <typename, class> class Filter, typename Pixel,
+          class Dark>
+static void filter_rows(u32 black, const void* src, int srcPitch, void* dst,
+                        int dstPitch, int width, int height, int scale,
+                        int top, int bottom) {
+    Dark dark(black);
+    for (int y = top; y < bottom; y++) {
+        Filter<Pixel, Dark>::row(
+            filter_row<Pixel>(src, srcPitch, y > 0 ? y - 1 : 0),
+            filter_row<Pixel>(src, srcPitch, y),
+            filter_row<Pixel>(src, srcPitch,
+                              y < height - 1 ? y + 1 : height - 1),
+            filter_row<u8>(dst, dstPitch, y * scale), dstPitch, width, scale,
+            dark);
+    }
+}
+
+/**
+ * Filters a range of source rows of the specified pixel type
+ */
+template <typename Pixel, class Dark>
+static int filter_pixels(int filter, u32 black, const void* src,
+                         int srcPitch, void* dst, int dstPitch, int width,
+                         int height, int scale, int top, int bottom) {
+    switch (filter) {
+        case WII_FILTER_SCALENX:
+            if (scale == 2) {
+                filter_rows<FilterScale2x, Pixel, Dark>(
+                    black, src, srcPitch, dst, dstPitch, width, height, scale,
+                    top, bottom);
+            } else {
+                filter_rows<FilterScale3x, Pixel, Dark>(
+                    black, src, srcPitch, dst, dstPitch, width, height, scale,
+                    top, bottom);
+            }
+            break;
+        case WII_FILTER_SCANLINES:
+            filter_rows<FilterScanlines, Pixel, Dark>(
+                black, src, srcPitch, dst, dstPitch, width, height, scale, top,
+                bottom);
+            break;
+        case WII_FILTER_LCD_GRID:
+            filter_rows<FilterLcdGrid, Pixel, Dark>(
+                black, src, srcPitch, dst, dstPitch, width, height, scale, top,
+                bottom);
+            break;
+    }
+    return 0;
+}
+
+/**
+ * Returns whether the filter supports the pixel size and scale
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   scale The scale
+ * @return  Whether the filter supports the pixel size and scale
+ */
+BOOL wii_filter_supported(int filter, int bpp, int scale) {
+    if (bpp != 1 && bpp != 2 && bpp != 4) {
+        return FALSE;
+    }
+    switch (filter) {
+        case WII_FILTER_SCALENX:
+            return scale == 2 || scale == 3;
+        case WII_FILTER_SCANLINES:
+        case WII_FILTER_LCD_GRID:
+            return scale >= 2;
+    }
+    return FALSE;
+}
+
+/**
+ * Returns the count of neighbouring source rows (above and below) that
+ * contribute to the filtered rows of a source row
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ * @return  The count of neighbouring source rows
+ */
+int wii_filter_reach(int filter) {
+    return filter == WII_FILTER_SCALENX ? 1 : 0;
+}
+
+/**
+ * Filters a range of rows of an image while scaling it
+ *
+ * 16bpp pixels are RGB565. 8bpp pixels are palette indices that cannot be
+ * darkened, the effects use the black pixel for them instead.
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   black The black pixel (used by the effects for 8bpp pixels)
+ * @param   src The first row of the source image
+ * @param   srcPitch The distance between the source rows in bytes
+ * @param   dst The first row of the scaled image
+ * @param   dstPitch The distance between the scaled rows in bytes
+ * @param   width The width of the source image
+ * @param   height The height of the source image
+ * @param   scale The scale
+ * @param   top The first source row to filter
+ * @param   bottom The source row following the last row to filter
+ * @return  0 if successful, -1 if the filter does not support the pixel
+ *          size or scale
+ */
+int wii_filter_apply(int filter, int bpp, u32 black, const void* src,
+                     int srcPitch, void* dst, int dstPitch, int width,
+                     int height, int scale, int top, int bottom) {
+    if (!wii_filter_supported(filter, bpp, scale)) {
+        return -1;
+    }
+    if (width <= 0 || top >= bottom) {
+        return 0;
+    }
+    switch (bpp) {
+        case 1:
+            return filter_pixels<u8, FilterDark8>(
+                filter, black, src, srcPitch, dst, dstPitch, width, height,
+                scale, top, bottom);
+        case 2:
+            return filter_pixels<u16, FilterDark16>(
+                filter, black, src, srcPitch, dst, dstPitch, width, height,
+                scale, top, bottom);
+        default:
+            return filter_pixels<u32, FilterDark32>(
+                filter, black, src, srcPitch, dst, dstPitch, width, height,
+                scale, top, bottom);
+    }
+}
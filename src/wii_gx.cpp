@@ -25,12 +25,17 @@
 //  02110-1301, USA.                                                         //
 //---------------------------------------------------------------------------//
 
+#include <stdio.h>
+#include <sys/stat.h>
+
 #include "FreeTypeGX.h"
 
+#include "gettext.h"
 #include "pngu.h"
 
 #include "wii_app.h"
 #include "wii_gx.h"
+#include "wii_gx_image.h"
 #include "wii_sdl.h"
 
 extern Mtx gx_view;
@@ -40,7 +45,30 @@ void WII_SetPreRenderCallback( void (*cb)(void) );
 void WII_SetRenderScreen( BOOL render );
 }
 
-static gx_imagedata* getimagedata( IMGCTX ctx );
+static gx_imagedata* getimagedata( IMGCTX ctx, int maxdim, bool compact );
+static void drawtexture( int xpos, int ypos, u16 width, u16 height, u8 data[],
+    u8 format, f32 degrees, f32 scaleX, f32 scaleY, u8 alpha );
+
+/** The number of images whose dimensions are cached in memory */
+#define IMAGE_INFO_CACHE_SIZE 32
+
+/** Dimensions of a probed image, valid for the size and modification time */
+typedef struct image_info {
+    char* path;      // Path of the image (NULL if the entry is unused)
+    u32 pathHash;    // Hash of the path of the image
+    u32 srcSize;     // Size of the image file
+    u32 srcMtime;    // Modification time of the image file
+    int width;
+    int height;
+    u32 lastUsed;    // Lookup counter value when the entry was last used
+} image_info;
+
+// The image dimensions cache
+static image_info imageinfo_cache[IMAGE_INFO_CACHE_SIZE];
+// Counter incremented for each lookup of the image dimensions cache
+static u32 imageinfo_counter = 0;
+// Directory of the pre-swizzled image cache files (NULL if disabled)
+static char* imagecache_dir = NULL;
 
 /** Render callback state information */
 typedef struct callbackstate {
@@ -167,7 +195,32 @@ uint16_t wii_gx_gettextwidth(FT_UInt pixelSize, char* text) {
 }
 
 /**
- * Draws the image at the specified position
+ * Starts caching the glyphs of the loaded translations (and the specified
+ * strings) in the background, so they are available before they are first
+ * drawn.
+ *
+ * @param   strings Additional strings to cache the glyphs for (may be NULL)
+ * @param   count The count of additional strings
+ */
+void wii_gx_prewarm_glyphs(const char** strings, int count) {
+    char ascii[0x80 - 0x20];
+    for (int i = 0x20; i < 0x7f; i++) {
+        ascii[i - 0x20] = i;
+    }
+    ascii[0x7f - 0x20] = '\0';
+    FT_PrewarmText(ascii);
+
+    gettextforeach(&FT_PrewarmText);
+    for (int i = 0; i < count; i++) {
+        FT_PrewarmText(strings[i]);
+    }
+
+    FT_StartPrewarm(NULL, 0);
+}
+
+/**
+ * Draws the image at the specified position (the data must be GX_TF_RGBA8,
+ * as returned by the loaders that are not compact)
  *
  * @param   xpos The x position
  * @param   ypos The y position
@@ -188,12 +241,66 @@ void wii_gx_drawimage(int xpos,
                       f32 scaleX,
                       f32 scaleY,
                       u8 alpha) {
+    drawtexture(xpos, ypos, width, height, data, GX_TF_RGBA8, degrees, scaleX,
+                scaleY, alpha);
+}
+
+/**
+ * Draws the loaded image at the specified position (in the texture format
+ * it was loaded with)
+ *
+ * @param   xpos The x position
+ * @param   ypos The y position
+ * @param   imgdata The data for the loaded image
+ * @param   degress The rotation degrees
+ * @param   scaleX How much to scale the X
+ * @param   scaleY How much to scale the Y
+ * @param   alpha Alpha channel
+ */
+void wii_gx_drawimagedata(int xpos,
+                          int ypos,
+                          const gx_imagedata* imgdata,
+                          f32 degrees,
+                          f32 scaleX,
+                          f32 scaleY,
+                          u8 alpha) {
+    if (imgdata == NULL)
+        return;
+
+    drawtexture(xpos, ypos, imgdata->width, imgdata->height, imgdata->data,
+                imgdata->format, degrees, scaleX, scaleY, alpha);
+}
+
+/**
+ * Draws the texture at the specified position
+ *
+ * @param   xpos The x position
+ * @param   ypos The y position
+ * @param   width The texture width
+ * @param   height The texture height
+ * @param   data The texture data
+ * @param   format The texture format (GX_TF_*)
+ * @param   degress The rotation degrees
+ * @param   scaleX How much to scale the X
+ * @param   scaleY How much to scale the Y
+ * @param   alpha Alpha channel
+ */
+static void drawtexture(int xpos,
+                        int ypos,
+                        u16 width,
+                        u16 height,
+                        u8 data[],
+                        u8 format,
+                        f32 degrees,
+                        f32 scaleX,
+                        f32 scaleY,
+                        u8 alpha) {
     if (data == NULL)
         return;
 
     GXTexObj texObj;
 
-    GX_InitTexObj(&texObj, data, width, height, GX_TF_RGBA8, GX_CLAMP, GX_CLAMP,
+    GX_InitTexObj(&texObj, data, width, height, format, GX_CLAMP, GX_CLAMP,
                   GX_FALSE);
     // GX_InitTexObjLOD(&texObj,GX_NEAR,GX_NEAR_MIP_NEAR,0.0,10.0,0.0,GX_FALSE,GX_FALSE,GX_ANISO_1);
     GX_LoadTexObj(&texObj, GX_TEXMAP0);
@@ -239,23 +346,248 @@ void wii_gx_drawimage(int xpos,
     GX_SetVtxDesc(GX_VA_TEX0, GX_NONE);
 }
 
+/**
+ * Returns the path of the pre-swizzled cache file for the specified image
+ * (see wii_gx_image_cachepath)
+ *
+ * @param   imgpath The path to the image
+ * @param   maxdim The maximum dimension the image is loaded with
+ * @param   compact Whether the image is loaded in the smallest format
+ * @param   cachepath The buffer to receive the path of the cache file
+ */
+static void getimagecachepath(const char* imgpath,
+                              int maxdim,
+                              bool compact,
+                              char* cachepath) {
+    wii_gx_image_cachepath(imagecache_dir, imgpath, maxdim, compact,
+                           cachepath, WII_MAX_PATH);
+}
+
+/**
+ * Loads the image from its pre-swizzled cache file. The cache is only used
+ * if it was written for the current size and modification time of the image
+ * and the same maximum dimension.
+ *
+ * @param   imgpath The path to the image
+ * @param   st The status of the image file
+ * @param   maxdim The maximum dimension the image is loaded with
+ * @param   compact Whether the image is loaded in the smallest format
+ * @return  The data for the loaded image (NULL if the cache is not valid)
+ */
+static gx_imagedata* loadimagecache(const char* imgpath,
+                                    const struct stat* st,
+                                    int maxdim,
+                                    bool compact) {
+    char cachepath[WII_MAX_PATH];
+    getimagecachepath(imgpath, maxdim, compact, cachepath);
+
+    gx_imagedata imgdata;
+    imgdata.data = wii_gx_image_loadcache(
+        cachepath, imgpath, st->st_size, st->st_mtime, maxdim, compact,
+        &imgdata.width, &imgdata.height, &imgdata.format);
+    if (!imgdata.data) {
+        return NULL;
+    }
+
+    gx_imagedata* ret = (gx_imagedata*)malloc(sizeof(gx_imagedata));
+    if (ret) {
+        *ret = imgdata;
+    } else {
+        free(imgdata.data);
+    }
+    return ret;
+}
+
+/**
+ * Writes the pre-swizzled cache file for the loaded image. Failures are
+ * ignored, the image is simply decoded again the next time.
+ *
+ * @param   imgpath The path to the image
+ * @param   st The status of the image file
+ * @param   maxdim The maximum dimension the image was loaded with
+ * @param   compact Whether the image was loaded in the smallest format
+ * @param   imgdata The data for the loaded image
+ */
+static void saveimagecache(const char* imgpath,
+                           const struct stat* st,
+                           int maxdim,
+                           bool compact,
+                           const gx_imagedata* imgdata) {
+    char cachepath[WII_MAX_PATH];
+    getimagecachepath(imgpath, maxdim, compact, cachepath);
+
+    wii_gx_image_savecache(cachepath, imgpath, st->st_size, st->st_mtime,
+                           maxdim, imgdata->data, imgdata->width,
+                           imgdata->height, imgdata->format);
+}
+
+/**
+ * Sets the directory the pre-swizzled image cache files are written to. The
+ * cache is disabled by default, images are only cached once a directory has
+ * been set. The directory is created if it does not exist.
+ *
+ * @param   dir The cache directory (NULL to disable the cache)
+ * @return  Whether the cache directory is available
+ */
+BOOL wii_gx_set_image_cache_dir(const char* dir) {
+    free(imagecache_dir);
+    imagecache_dir = NULL;
+
+    if (!dir) {
+        return TRUE;
+    }
+
+    struct stat st;
+    if (stat(dir, &st) ? mkdir(dir, 0777) : !S_ISDIR(st.st_mode)) {
+        return FALSE;
+    }
+
+    imagecache_dir = strdup(dir);
+    return imagecache_dir != NULL;
+}
+
+/**
+ * Returns the dimensions of the image at the specified path, as it would be
+ * loaded with the specified maximum dimension. Only the PNG header is read
+ * and the dimensions are cached in memory (for as long as the size and
+ * modification time of the image file don't change), so layouts can be sized
+ * without loading the images.
+ *
+ * @param   imgpath The path to the image
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @param   width The width of the image (out)
+ * @param   height The height of the image (out)
+ * @return  Whether the dimensions were determined
+ */
+BOOL wii_gx_getimagesize(char* imgpath, int maxdim, int* width, int* height) {
+    struct stat st;
+    if (!imgpath || stat(imgpath, &st)) {
+        return FALSE;
+    }
+
+    u32 hash = wii_gx_image_pathhash(imgpath);
+    image_info* entry = NULL;
+    image_info* oldest = &imageinfo_cache[0];
+    for (int i = 0; i < IMAGE_INFO_CACHE_SIZE; i++) {
+        image_info* info = &imageinfo_cache[i];
+        if (info->path && info->pathHash == hash &&
+            !strcmp(info->path, imgpath)) {
+            entry = info;
+            break;
+        }
+        if (!info->path ||
+            (oldest->path && info->lastUsed < oldest->lastUsed)) {
+            oldest = info;
+        }
+    }
+
+    if (!entry || entry->srcSize != (u32)st.st_size ||
+        entry->srcMtime != (u32)st.st_mtime) {
+        PNGUPROP imgProp;
+        if (PNGU_ProbeImageFromDevice(imgpath, &imgProp) != PNGU_OK) {
+            return FALSE;
+        }
+
+        // Reuse the entry of the image or replace the least recently used
+        if (!entry) {
+            entry = oldest;
+            free(entry->path);
+            entry->path = strdup(imgpath);
+            if (!entry->path) {
+                return FALSE;
+            }
+            entry->pathHash = hash;
+        }
+        entry->srcSize = st.st_size;
+        entry->srcMtime = st.st_mtime;
+        entry->width = imgProp.imgWidth;
+        entry->height = imgProp.imgHeight;
+    }
+    entry->lastUsed = ++imageinfo_counter;
+
+    *width = entry->width;
+    *height = entry->height;
+    wii_gx_image_scaledsize(width, height, maxdim);
+
+    return TRUE;
+}
+
 /**
  * Loads and returns the data for the image at the specified path
  *
  * @param   imgpath The path to the image
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @param   compact Whether to load the image in the smallest texture format
+ *          that holds it (otherwise GX_TF_RGBA8)
  * @return  The data for the loaded image
  */
-gx_imagedata* wii_gx_loadimage(char* imgpath) {
+static gx_imagedata* loadimage(char* imgpath, int maxdim, bool compact) {
     if (imgpath) {
+        struct stat st;
+        bool cacheable = imagecache_dir && !stat(imgpath, &st);
+        if (cacheable) {
+            gx_imagedata* cached =
+                loadimagecache(imgpath, &st, maxdim, compact);
+            if (cached) {
+                return cached;
+            }
+        }
+
         IMGCTX ctx = PNGU_SelectImageFromDevice(imgpath);
-        return getimagedata(ctx);
+        gx_imagedata* imgdata = getimagedata(ctx, maxdim, compact);
+        if (imgdata && cacheable) {
+            saveimagecache(imgpath, &st, maxdim, compact, imgdata);
+        }
+        return imgdata;
     }
 
     return NULL;
 }
 
 /**
- * Loads image data for the specified image buffer
+ * Loads and returns the data for the image at the specified path (as
+ * GX_TF_RGBA8)
+ *
+ * @param   imgpath The path to the image
+ * @return  The data for the loaded image
+ */
+gx_imagedata* wii_gx_loadimage(char* imgpath) {
+    return loadimage(imgpath, 0, false);
+}
+
+/**
+ * Loads and returns the data for the image at the specified path (as
+ * GX_TF_RGBA8). Images larger than the maximum dimension are box filtered
+ * down while decoding, so the texture only holds what is displayed.
+ *
+ * @param   imgpath The path to the image
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @return  The data for the loaded image
+ */
+gx_imagedata* wii_gx_loadimage_scaled(char* imgpath, int maxdim) {
+    return loadimage(imgpath, maxdim, false);
+}
+
+/**
+ * Loads and returns the data for the image at the specified path in the
+ * smallest texture format that holds it (see PNGU_GetTextureFormat). The
+ * format is recorded in the image data, so the image must be drawn with
+ * wii_gx_drawimagedata.
+ *
+ * @param   imgpath The path to the image
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
+ * @return  The data for the loaded image
+ */
+gx_imagedata* wii_gx_loadimage_compact(char* imgpath, int maxdim) {
+    return loadimage(imgpath, maxdim, true);
+}
+
+/**
+ * Loads image data for the specified image buffer (as GX_TF_RGBA8)
  *
  * @param   buff The image buffer
  * @return  The data for the loaded image
@@ -263,7 +595,23 @@ gx_imagedata* wii_gx_loadimage(char* imgpath) {
 gx_imagedata* wii_gx_loadimagefrombuff(const u8* buff) {
     if (buff) {
         IMGCTX ctx = PNGU_SelectImageFromBuffer(buff);
-        return getimagedata(ctx);
+        return getimagedata(ctx, 0, false);
+    }
+
+    return NULL;
+}
+
+/**
+ * Loads image data for the specified image buffer in the smallest texture
+ * format that holds it. The image must be drawn with wii_gx_drawimagedata.
+ *
+ * @param   buff The image buffer
+ * @return  The data for the loaded image
+ */
+gx_imagedata* wii_gx_loadimagefrombuff_compact(const u8* buff) {
+    if (buff) {
+        IMGCTX ctx = PNGU_SelectImageFromBuffer(buff);
+        return getimagedata(ctx, 0, true);
     }
 
     return NULL;
@@ -273,37 +621,17 @@ gx_imagedata* wii_gx_loadimagefrombuff(const u8* buff) {
  * Loads image data for the specified image context
  *
  * @param   ctx The image context
+ * @param   maxdim The maximum width and height of the loaded image (0 for no
+ *          limit)
  * @return  The image data for the specified context
  */
-static gx_imagedata* getimagedata(IMGCTX ctx) {
+static gx_imagedata* getimagedata(IMGCTX ctx, int maxdim, bool compact) {
     if (!ctx)
         return NULL;
 
     gx_imagedata imgdata;
-    memset(&imgdata, 0, sizeof(gx_imagedata));
-    PNGUPROP imgProp;
-
-    int res = PNGU_GetImageProperties(ctx, &imgProp);
-    if (res == PNGU_OK) {
-        int len = imgProp.imgWidth * imgProp.imgHeight * 4;
-        if (len % 32)
-            len += (32 - len % 32);
-        imgdata.data = (u8*)memalign(32, len);
-        if (imgdata.data) {
-            res = PNGU_DecodeTo4x4RGBA8(ctx, imgProp.imgWidth,
-                                        imgProp.imgHeight, imgdata.data, 255);
-
-            if (res == PNGU_OK) {
-                imgdata.width = imgProp.imgWidth;
-                imgdata.height = imgProp.imgHeight;
-                DCFlushRange(imgdata.data, len);
-            } else {
-                free(imgdata.data);
-                imgdata.data = NULL;
-            }
-        }
-    }
-
+    imgdata.data = wii_gx_image_decode(ctx, maxdim, compact, &imgdata.width,
+                                       &imgdata.height, &imgdata.format);
     PNGU_ReleaseImageContext(ctx);
 
     gx_imagedata* ret = NULL;
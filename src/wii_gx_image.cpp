@@ -0,0 +1,284 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#include <stdio.h>
+#include <string.h>
+
+#include <gccore.h>
+
+#include "wii_gx_image.h"
+
+/** Magic ("GXTC") of the pre-swizzled image cache files */
+#define IMAGE_CACHE_MAGIC 0x47585443
+/** Version of the pre-swizzled image cache files */
+#define IMAGE_CACHE_VERSION 3
+
+/**
+ * Header of a pre-swizzled image cache file, stored big-endian (the native
+ * order of the Wii). It is padded to 64 bytes and followed by the tiled
+ * texels, so that they start 32 byte aligned within the file.
+ */
+typedef struct image_cache_header {
+    u32 magic;
+    u32 version;
+    u32 srcSize;   // Size of the source image file
+    u32 srcMtime;  // Modification time of the source image file
+    u32 srcHash;   // Hash of the source image path
+    u32 maxdim;    // Maximum dimension the image was loaded with
+    u16 width;
+    u16 height;
+    u8 format;     // GX texture format of the texels
+    u8 padding[35];
+} image_cache_header;
+
+/**
+ * Converts the header between the file and the native byte order (in place)
+ *
+ * @param   header The header
+ */
+static void swapheader(image_cache_header* header) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    header->magic = __builtin_bswap32(header->magic);
+    header->version = __builtin_bswap32(header->version);
+    header->srcSize = __builtin_bswap32(header->srcSize);
+    header->srcMtime = __builtin_bswap32(header->srcMtime);
+    header->srcHash = __builtin_bswap32(header->srcHash);
+    header->maxdim = __builtin_bswap32(header->maxdim);
+    header->width = __builtin_bswap16(header->width);
+    header->height = __builtin_bswap16(header->height);
+#endif
+}
+
+/**
+ * Fills in the cache header for the specified image
+ *
+ * @param   header The header to fill in
+ * @param   imgpath The path to the image
+ * @param   srcSize The size of the image file
+ * @param   srcMtime The modification time of the image file
+ * @param   maxdim The maximum dimension the image is loaded with
+ */
+static void initheader(image_cache_header* header,
+                       const char* imgpath,
+                       u32 srcSize,
+                       u32 srcMtime,
+                       int maxdim) {
+    memset(header, 0, sizeof(image_cache_header));
+    header->magic = IMAGE_CACHE_MAGIC;
+    header->version = IMAGE_CACHE_VERSION;
+    header->srcSize = srcSize;
+    header->srcMtime = srcMtime;
+    header->srcHash = wii_gx_image_pathhash(imgpath);
+    header->maxdim = maxdim > 0 ? maxdim : 0;
+}
+
+int wii_gx_image_size(u8 format, int width, int height) {
+    int len = width * height;
+    switch (format) {
+        case GX_TF_I8:
+            break;
+        case GX_TF_IA8:
+        case GX_TF_RGB565:
+        case GX_TF_RGB5A3:
+            len *= 2;
+            break;
+        default:
+            len *= 4;
+            break;
+    }
+    if (len % 32)
+        len += (32 - len % 32);
+    return len;
+}
+
+BOOL wii_gx_image_scaledsize(int* width, int* height, int maxdim) {
+    int largest = *width > *height ? *width : *height;
+    if (maxdim <= 0 || largest <= maxdim) {
+        return FALSE;
+    }
+
+    *width = (*width * maxdim / largest) & ~3;
+    *height = (*height * maxdim / largest) & ~3;
+    if (*width < 4)
+        *width = 4;
+    if (*height < 4)
+        *height = 4;
+    return TRUE;
+}
+
+u8* wii_gx_image_decode(IMGCTX ctx,
+                        int maxdim,
+                        BOOL compact,
+                        int* width,
+                        int* height,
+                        u8* format) {
+    PNGUPROP imgProp;
+    if (!ctx || PNGU_GetImageProperties(ctx, &imgProp) != PNGU_OK) {
+        return NULL;
+    }
+
+    int w = imgProp.imgWidth;
+    int h = imgProp.imgHeight;
+    BOOL scaled = wii_gx_image_scaledsize(&w, &h, maxdim);
+
+    // Use the smallest format that holds the image if requested (I8 tiles
+    // are eight texels wide, so narrower multiples of four use IA8)
+    u8 fmt = GX_TF_RGBA8;
+    if (compact && PNGU_GetTextureFormat(ctx, 1, &fmt) != PNGU_OK)
+        fmt = GX_TF_RGBA8;
+    if (fmt == GX_TF_I8 && (w % 8))
+        fmt = GX_TF_IA8;
+
+    int len = wii_gx_image_size(fmt, w, h);
+    u8* data = (u8*)memalign(32, len);
+    if (!data) {
+        return NULL;
+    }
+
+    int res;
+    if (scaled) {
+        res = PNGU_DecodeTo4x4Scaled(ctx, imgProp.imgWidth, imgProp.imgHeight,
+                                     data, w, h, fmt, 255);
+    } else {
+        res = PNGU_DecodeTo4x4(ctx, imgProp.imgWidth, imgProp.imgHeight, data,
+                               fmt, 255);
+    }
+    if (res != PNGU_OK) {
+        free(data);
+        return NULL;
+    }
+
+    DCFlushRange(data, len);
+    *width = w;
+    *height = h;
+    *format = fmt;
+    return data;
+}
+
+u32 wii_gx_image_pathhash(const char* imgpath) {
+    u32 hash = 2166136261u;
+    for (const char* c = imgpath; *c; c++) {
+        hash = (hash ^ (u8)*c) * 16777619u;
+    }
+    return hash;
+}
+
+void wii_gx_image_cachepath(const char* dir,
+                            const char* imgpath,
+                            int maxdim,
+                            BOOL compact,
+                            char* cachepath,
+                            int size) {
+    snprintf(cachepath, size, "%s/%08x_%d%s%s", dir,
+             wii_gx_image_pathhash(imgpath), maxdim > 0 ? maxdim : 0,
+             compact ? "c" : "", WII_GX_IMAGE_CACHE_EXT);
+}
+
+u8* wii_gx_image_loadcache(const char* cachepath,
+                           const char* imgpath,
+                           u32 srcSize,
+                           u32 srcMtime,
+                           int maxdim,
+                           BOOL compact,
+                           int* width,
+                           int* height,
+                           u8* format) {
+    FILE* fp = fopen(cachepath, "rb");
+    if (!fp) {
+        return NULL;
+    }
+
+    image_cache_header expected, header;
+    initheader(&expected, imgpath, srcSize, srcMtime, maxdim);
+
+    u8* ret = NULL;
+    if (fread(&header, sizeof(header), 1, fp) == 1) {
+        swapheader(&header);
+    } else {
+        header.magic = 0;
+    }
+    if (header.magic == expected.magic &&
+        header.version == expected.version &&
+        header.srcSize == expected.srcSize &&
+        header.srcMtime == expected.srcMtime &&
+        header.srcHash == expected.srcHash &&
+        header.maxdim == expected.maxdim &&
+        (header.format == GX_TF_RGBA8 ||
+         (compact && (header.format == GX_TF_I8 || header.format == GX_TF_IA8 ||
+                      header.format == GX_TF_RGB565))) &&
+        header.width > 0 && header.height > 0) {
+        int len = wii_gx_image_size(header.format, header.width, header.height);
+        u8* data = (u8*)memalign(32, len);
+        if (data) {
+            // Read the texels straight into the texture
+            if (fread(data, len, 1, fp) == 1) {
+                DCFlushRange(data, len);
+                *width = header.width;
+                *height = header.height;
+                *format = header.format;
+                ret = data;
+            } else {
+                free(data);
+            }
+        }
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+BOOL wii_gx_image_savecache(const char* cachepath,
+                            const char* imgpath,
+                            u32 srcSize,
+                            u32 srcMtime,
+                            int maxdim,
+                            const u8* data,
+                            int width,
+                            int height,
+                            u8 format) {
+    image_cache_header header;
+    initheader(&header, imgpath, srcSize, srcMtime, maxdim);
+    header.width = width;
+    header.height = height;
+    header.format = format;
+    swapheader(&header);
+
+    FILE* fp = fopen(cachepath, "wb");
+    if (!fp) {
+        return FALSE;
+    }
+
+    int len = wii_gx_image_size(format, width, height);
+    bool success = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                   fwrite(data, len, 1, fp) == 1;
+    fclose(fp);
+
+    if (!success) {
+        remove(cachepath);
+    }
+    return success;
+}
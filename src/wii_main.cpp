@@ -62,6 +62,9 @@ extern void dump_unique_msgids();
 #define MENU_LINESIZE 20
 #define MENU_PAGESIZE 11
 
+/** The prebaked font glyphs (relative to the application directory) */
+#define FONT_CACHE_FILE "fontcache.bin"
+
 extern "C" {
 Mtx gx_view;
 void WII_VideoStop();
@@ -108,11 +111,15 @@ BOOL wii_usb_keepalive = FALSE;
 BOOL wii_trap_filter = FALSE;
 /** 16:9 correction */
 BOOL wii_16_9_correction = WS_AUTO;
+/** Whether to release the menu font glyphs when the menu is closed */
+BOOL wii_menu_trim_fonts = FALSE;
 
 /** The about image data */
 static gx_imagedata* about_idata = NULL;
 /** The first item to display in the menu (paging, etc.) */
 static s16 menu_start_idx = 0;
+/** Whether the menu font glyphs were released when the menu was last closed */
+static BOOL menu_fonts_trimmed = FALSE;
 
 /** The main arg count */
 static int main_argc;
@@ -394,9 +401,8 @@ static void wii_menu_render(TREENODE* menu) {
     int fontSize = 18;
 
     // Render the about image
-    wii_gx_drawimage(-(about_idata->width >> 1), GX_Y(ABOUT_Y),
-                     about_idata->width, about_idata->height, about_idata->data,
-                     0, 1.0, 1.0, 0xff);
+    wii_gx_drawimagedata(-(about_idata->width >> 1), GX_Y(ABOUT_Y), about_idata,
+                         0, 1.0, 1.0, 0xff);
 
     // Draw the menu items (text)
     if (menu) {
@@ -621,13 +627,22 @@ static void precallback() {
     BOOL newws =
         (wii_full_widescreen == WS_AUTO ? is_widescreen : wii_full_widescreen);
 
+    // The encoder registers are written by libogc when a video mode is
+    // configured, the shadowed values are no longer known
     if (lastws != newws) {
         lastws = newws;
         WII_SetWidescreen(lastws);
+        VIDEO_InvalidateEncoderState();
     }
 
     VIDEO_SetTrapFilter(1);
+
+    static GXRModeObj lastmode;
     WII_SetDefaultVideoMode();
+    if (memcmp(&lastmode, vmode, sizeof(lastmode))) {
+        lastmode = *vmode;
+        VIDEO_InvalidateEncoderState();
+    }
 }
 
 /**
@@ -637,6 +652,13 @@ void wii_menu_show() {
     // Push our callback
     wii_gx_push_callback(&menu_render_callback, FALSE, &precallback);
 
+    // Cache the menu glyphs again if they were released when the menu was
+    // last closed
+    if (menu_fonts_trimmed) {
+        wii_gx_prewarm_glyphs(NULL, 0);
+        menu_fonts_trimmed = FALSE;
+    }
+
     // Allows for incremental speed when scrolling the menu
     // (Scrolls faster the longer the directional pad is held)
     s16 delay_frames = -1;
@@ -761,6 +783,15 @@ void wii_menu_show() {
     // Pop our callback
     wii_gx_pop_callback();
 
+    // Release the rendered menu glyphs so the memory is available to the
+    // application (once the last menu frame has been drawn). Applications
+    // may also call FT_TrimFontCache directly when they need the memory.
+    if (wii_menu_trim_fonts) {
+        VIDEO_WaitVSync();
+        FT_TrimFontCache(0);
+        menu_fonts_trimmed = TRUE;
+    }
+
     // Invoke post loop handler
     wii_menu_handle_post_loop();
 }
@@ -818,10 +849,19 @@ void wii_get_list_footer(TREENODE* menu,
  */
 static void init_app() {
     // Load the about image
-    about_idata = wii_gx_loadimagefrombuff(about_png);
+    about_idata = wii_gx_loadimagefrombuff_compact(about_png);
 
     // Initialize the application
     wii_handle_init();
+
+    // Load the prebaked glyphs of the font passed to InitFreeType (baked and
+    // written here if missing, or ahead of time with tools/ftgx_bake)
+    char fontcache[WII_MAX_PATH];
+    wii_get_app_relative(FONT_CACHE_FILE, fontcache);
+    FT_InitFontCache(fontcache, NULL, 0);
+
+    // Cache the glyphs of the (translated) menu text in the background
+    wii_gx_prewarm_glyphs(NULL, 0);
 }
 
 /**
@@ -26,9 +26,16 @@
 //---------------------------------------------------------------------------//
 
 #include <gctypes.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "wii_app.h"
+#include "wii_filter.h"
+#include "wii_scale.h"
 #include "wii_sdl.h"
+#include "wii_span.h"
+#include "wii_swizzle.h"
+#include "wii_triple_buffer.h"
 
 #ifdef WII_NETTRACE
 #include <network.h>
@@ -44,6 +51,82 @@ static SDL_mutex* render_mutex = NULL;
 /** mutext lock count */
 static int mutex_lock_count = 0;
 
+/** A range of changed rows of a surface (empty if top >= bottom) */
+struct dirty_rows {
+    int top;
+    int bottom;
+};
+
+/** Whether the dirty regions of the surfaces are tracked */
+static BOOL dirty_tracking = FALSE;
+/** The changed rows of the back surface */
+static dirty_rows back_dirty = {0, 0};
+/** The changed rows of the blit surface */
+static dirty_rows blit_dirty = {0, 0};
+/** The scale of the last wii_sdl_put_image_normal (0 if none) */
+static int put_image_last_scale = 0;
+/** The filter applied by wii_sdl_put_image_normal (WII_FILTER_*) */
+static int put_image_filter = WII_FILTER_NONE;
+/** The back surface upload statistics */
+static wii_sdl_upload_stats upload_stats;
+
+/** The palette texels used to convert 8bpp surfaces to textures */
+static wii_swizzle_lut texture_lut;
+/** The palette the texels were computed for */
+static SDL_Color texture_lut_colors[256];
+/** The count of colors of the palette the texels were computed for */
+static int texture_lut_count = 0;
+/** The version of the palette the texels were computed for */
+static u32 texture_lut_version = 0;
+
+/** The surface displayed while triple buffering (NULL if not) */
+static SDL_Surface* screen_surface = NULL;
+/** The surfaces exchanged while triple buffering */
+static SDL_Surface* triple_surfaces[3] = {NULL, NULL, NULL};
+/** The exchange of the triple buffered surfaces */
+static wii_triple_buffer triple_buffer;
+
+/** The number of rendered text surfaces cached */
+#define TEXT_CACHE_SIZE 32
+/** The maximum memory used by the cached text surfaces (bytes) */
+#define TEXT_CACHE_BYTES (256 * 1024)
+/** The number of fonts and colors whose numeric glyphs are cached */
+#define TEXT_GLYPH_SETS 4
+/** The characters of numbers, composed from cached glyphs */
+#define TEXT_GLYPH_CHARS "0123456789.,:-+%/ "
+/** The count of characters of numbers */
+#define TEXT_GLYPH_COUNT (sizeof(TEXT_GLYPH_CHARS) - 1)
+
+/** A rendered text surface */
+typedef struct text_surface {
+    char* text;            // The text (NULL if the entry is unused)
+    u32 textHash;          // Hash of the text
+    TTF_Font* font;        // The font the text was rendered with
+    u32 fg;                // The foreground color (R << 16 | G << 8 | B)
+    BOOL shaded;           // Whether the text was rendered shaded
+    SDL_Surface* surface;  // The text in the display format
+    u32 bytes;             // Memory used by the surface
+    u32 lastUsed;          // Lookup counter value when the entry was last used
+} text_surface;
+
+/** The rendered glyphs of numbers of a font and color */
+typedef struct text_glyphs {
+    TTF_Font* font;  // The font (NULL if the set is unused)
+    u32 fg;          // The foreground color (R << 16 | G << 8 | B)
+    BOOL shaded;     // Whether the glyphs were rendered shaded
+    SDL_Surface* glyphs[TEXT_GLYPH_COUNT];  // Rendered lazily
+    u32 lastUsed;    // Lookup counter value when the set was last used
+} text_glyphs;
+
+// The rendered text cache
+static text_surface text_cache[TEXT_CACHE_SIZE];
+// The memory used by the surfaces of the rendered text cache
+static u32 text_cache_bytes = 0;
+// The number glyph cache
+static text_glyphs text_glyph_cache[TEXT_GLYPH_SETS];
+// Counter incremented for each lookup of the text caches
+static u32 text_cache_counter = 0;
+
 // Fonts
 TTF_Font* sdl_font_18 = NULL;
 TTF_Font* sdl_font_14 = NULL;
@@ -90,7 +173,235 @@ void UNLOCK_RENDER_MUTEX() {
  * @return  The index of the specified color
  */
 uint wii_sdl_rgb(u8 R, u8 G, u8 B) {
-    return SDL_MapRGB(back_surface->format, R, G, B);
+    return SDL_MapRGB(wii_sdl_get_screen_surface()->format, R, G, B);
+}
+
+/**
+ * Returns the changed rows of the specified surface
+ *
+ * @param   surface The surface
+ * @return  The changed rows (NULL if the surface is not tracked)
+ */
+static dirty_rows* wii_sdl_dirty_rows(SDL_Surface* surface) {
+    if (surface == NULL) {
+        return NULL;
+    } else if (surface == back_surface) {
+        return &back_dirty;
+    } else if (surface == blit_surface) {
+        return &blit_dirty;
+    }
+    return NULL;
+}
+
+/**
+ * Adds rows to the changed rows of the specified surface
+ *
+ * @param   surface The surface
+ * @param   top The first changed row
+ * @param   bottom The row following the last changed row
+ */
+static void wii_sdl_add_dirty_rows(SDL_Surface* surface, int top,
+                                   int bottom) {
+    dirty_rows* dirty = wii_sdl_dirty_rows(surface);
+    if (dirty == NULL) {
+        return;
+    }
+    if (top < 0) {
+        top = 0;
+    }
+    if (bottom > surface->h) {
+        bottom = surface->h;
+    }
+    if (top >= bottom) {
+        return;
+    }
+    if (dirty->top >= dirty->bottom) {
+        dirty->top = top;
+        dirty->bottom = bottom;
+    } else {
+        if (top < dirty->top)
+            dirty->top = top;
+        if (bottom > dirty->bottom)
+            dirty->bottom = bottom;
+    }
+}
+
+/**
+ * Marks a region of the back or blit surface as changed. Changes to the blit
+ * surface are copied to the back surface by wii_sdl_put_image_normal,
+ * changes to the back surface are uploaded by wii_sdl_flip.
+ *
+ * @param   surface The surface (back_surface or blit_surface)
+ * @param   rect The changed region (NULL for the entire surface)
+ */
+void wii_sdl_mark_dirty(SDL_Surface* surface, const SDL_Rect* rect) {
+    if (surface == NULL) {
+        return;
+    }
+    if (rect == NULL) {
+        wii_sdl_add_dirty_rows(surface, 0, surface->h);
+    } else if (rect->w > 0 && rect->h > 0) {
+        wii_sdl_add_dirty_rows(surface, rect->y, rect->y + rect->h);
+    }
+}
+
+/**
+ * Enables or disables dirty tracking of the back and blit surfaces. While
+ * enabled, the application must mark the regions it renders to the surfaces
+ * directly (the wii_sdl rendering functions mark their own changes).
+ * Enabling the tracking marks both surfaces as entirely dirty.
+ *
+ * @param   enabled Whether to track the dirty regions
+ */
+void wii_sdl_set_dirty_tracking(BOOL enabled) {
+    dirty_tracking = enabled;
+    back_dirty.top = back_dirty.bottom = 0;
+    blit_dirty.top = blit_dirty.bottom = 0;
+    put_image_last_scale = 0;
+    if (enabled) {
+        wii_sdl_mark_dirty(back_surface, NULL);
+        wii_sdl_mark_dirty(blit_surface, NULL);
+    }
+}
+
+/**
+ * Returns the statistics of the back surface uploads
+ *
+ * @param   stats The statistics (return value)
+ */
+void wii_sdl_get_upload_stats(wii_sdl_upload_stats* stats) {
+    *stats = upload_stats;
+}
+
+/**
+ * Resets the statistics of the back surface uploads
+ */
+void wii_sdl_reset_upload_stats() {
+    memset(&upload_stats, 0, sizeof(upload_stats));
+}
+
+/**
+ * Copies the pixels of a surface to a surface of the same size and format
+ *
+ * @param   src The source surface
+ * @param   dst The destination surface
+ */
+static void wii_sdl_copy_surface(SDL_Surface* src, SDL_Surface* dst) {
+    const u8* in = (const u8*)src->pixels;
+    u8* out = (u8*)dst->pixels;
+    int rowBytes = src->w * src->format->BytesPerPixel;
+    for (int y = 0; y < src->h; y++, in += src->pitch, out += dst->pitch) {
+        memcpy(out, in, rowBytes);
+    }
+}
+
+/**
+ * Frees the triple buffered surfaces
+ */
+static void wii_sdl_free_triple_surfaces() {
+    for (int i = 0; i < 3; i++) {
+        if (triple_surfaces[i] != NULL) {
+            SDL_FreeSurface(triple_surfaces[i]);
+            triple_surfaces[i] = NULL;
+        }
+    }
+}
+
+/**
+ * Enables or disables triple buffering of the back surface. While enabled,
+ * back_surface is one of three offscreen surfaces of the format of the
+ * screen. wii_sdl_flip publishes it as the newest frame (without waiting)
+ * and back_surface is replaced by a free surface, which must be redrawn
+ * entirely. The render side displays the newest frame with
+ * wii_sdl_present. Must not be called while either side is rendering.
+ *
+ * @param   enabled Whether to triple buffer the back surface
+ * @return  Whether triple buffering is in the requested state
+ */
+BOOL wii_sdl_set_triple_buffering(BOOL enabled) {
+    if (enabled == (screen_surface != NULL)) {
+        return TRUE;
+    }
+
+    if (enabled) {
+        SDL_PixelFormat* format = back_surface->format;
+        for (int i = 0; i < 3; i++) {
+            SDL_Surface* surface = SDL_CreateRGBSurface(
+                SDL_SWSURFACE, back_surface->w, back_surface->h,
+                format->BitsPerPixel, format->Rmask, format->Gmask,
+                format->Bmask, format->Amask);
+            if (surface == NULL) {
+                wii_sdl_free_triple_surfaces();
+                return FALSE;
+            }
+            if (format->palette != NULL) {
+                SDL_SetColors(surface, format->palette->colors, 0,
+                              format->palette->ncolors);
+            }
+            // Start with the current contents (borders are drawn once)
+            wii_sdl_copy_surface(back_surface, surface);
+            triple_surfaces[i] = surface;
+        }
+        wii_triple_buffer_init(&triple_buffer);
+        screen_surface = back_surface;
+        back_surface = triple_surfaces[triple_buffer.back];
+    } else {
+        back_surface = screen_surface;
+        screen_surface = NULL;
+        wii_sdl_free_triple_surfaces();
+    }
+
+    put_image_last_scale = 0;
+    wii_sdl_mark_dirty(back_surface, NULL);
+    return TRUE;
+}
+
+/**
+ * Returns the surface that is displayed (the back surface unless triple
+ * buffering). Palette changes must be applied to this surface.
+ *
+ * @return  The surface that is displayed
+ */
+SDL_Surface* wii_sdl_get_screen_surface() {
+    return screen_surface != NULL ? screen_surface : back_surface;
+}
+
+/**
+ * Displays the newest frame published by wii_sdl_flip while triple buffering
+ * (called by the render side, it never waits for the producer). The screen
+ * is uploaded from the pixels of the newest frame, they are not copied.
+ *
+ * @return  Whether a new frame was displayed
+ */
+BOOL wii_sdl_present() {
+    if (screen_surface == NULL) {
+        return FALSE;
+    }
+
+    upload_stats.frames++;
+    if (!wii_triple_buffer_acquire(&triple_buffer)) {
+        upload_stats.skippedFrames++;
+        upload_stats.lastBytes = 0;
+        return FALSE;
+    }
+
+    // The screen is uploaded from the pixels of the front surface (the
+    // surfaces share the size and format of the screen), the producer does
+    // not draw into it until it is exchanged by the next acquire
+    SDL_Surface* front = triple_surfaces[triple_buffer.front];
+    if (front->pitch == screen_surface->pitch) {
+        void* pixels = screen_surface->pixels;
+        screen_surface->pixels = front->pixels;
+        SDL_Flip(screen_surface);
+        screen_surface->pixels = pixels;
+    } else {
+        wii_sdl_copy_surface(front, screen_surface);
+        SDL_Flip(screen_surface);
+    }
+
+    upload_stats.lastBytes = screen_surface->h * screen_surface->pitch;
+    upload_stats.totalBytes += upload_stats.lastBytes;
+    return TRUE;
 }
 
 /**
@@ -100,6 +411,7 @@ void wii_sdl_black_screen() {
     SDL_FillRect(blit_surface, NULL,
                  SDL_MapRGB(blit_surface->format, 0x0, 0x0, 0x0));
     SDL_Flip(blit_surface);
+    wii_sdl_mark_dirty(blit_surface, NULL);
     wii_sdl_black_back_surface();
 }
 
@@ -107,48 +419,219 @@ void wii_sdl_black_screen() {
  * Blacks the back surface
  */
 void wii_sdl_black_back_surface() {
-    SDL_FillRect(back_surface, NULL,
-                 SDL_MapRGB(back_surface->format, 0x0, 0x0, 0x0));
-    SDL_Flip(back_surface);
+    if (screen_surface != NULL) {
+        // Each of the exchanged surfaces may be displayed next
+        for (int i = 0; i < 3; i++) {
+            SDL_FillRect(triple_surfaces[i], NULL,
+                         SDL_MapRGB(back_surface->format, 0x0, 0x0, 0x0));
+        }
+    }
+    SDL_Surface* screen = wii_sdl_get_screen_surface();
+    SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0x0, 0x0, 0x0));
+    SDL_Flip(screen);
+    // Uploaded already, but the scaled image must be copied again
+    put_image_last_scale = 0;
+}
+
+/** Scales the blit surface pixels into the back surface */
+typedef void (*put_image_scaler)(const u8* src, int srcPitch, u8* dst,
+                                 int dstPitch, int width, int height);
+
+/** The scalers for the surface pixel format (scales 1, 2 and 3) */
+static put_image_scaler put_image_scalers[3] = {NULL, NULL, NULL};
+/** The bytes per pixel the scalers were selected for (0 if none) */
+static int put_image_bpp = 0;
+
+/**
+ * Selects the scalers matching the pixel format of the blit and back
+ * surfaces. If the surfaces differ in format (or have a format without
+ * scalers) wii_sdl_put_image_normal falls back to SDL_BlitSurface.
+ */
+static void wii_sdl_select_scalers() {
+    put_image_bpp = 0;
+    if (blit_surface == NULL || back_surface == NULL) {
+        return;
+    }
+    int bpp = blit_surface->format->BytesPerPixel;
+    if (bpp != back_surface->format->BytesPerPixel) {
+        return;
+    }
+    switch (bpp) {
+        case 1:
+            put_image_scalers[0] = scale_image<ScaleRow8<1>, 1, u8>;
+            put_image_scalers[1] = scale_image<ScaleRow8<2>, 2, u8>;
+            put_image_scalers[2] = scale_image<ScaleRow8<3>, 3, u8>;
+            break;
+        case 2:
+            put_image_scalers[0] = scale_image<ScaleRow16<1>, 1, u16>;
+            put_image_scalers[1] = scale_image<ScaleRow16<2>, 2, u16>;
+            put_image_scalers[2] = scale_image<ScaleRow16<3>, 3, u16>;
+            break;
+        case 4:
+            put_image_scalers[0] = scale_image<ScaleRow32<1>, 1, u32>;
+            put_image_scalers[1] = scale_image<ScaleRow32<2>, 2, u32>;
+            put_image_scalers[2] = scale_image<ScaleRow32<3>, 3, u32>;
+            break;
+        default:
+            return;
+    }
+    put_image_bpp = bpp;
+}
+
+/**
+ * Sets the filter applied when rendering the blit surface to the Wii surface.
+ * Scales or pixel formats that the filter does not support are rendered
+ * unfiltered.
+ *
+ * @param   filter The filter (WII_FILTER_*)
+ */
+void wii_sdl_set_filter(int filter) {
+    if (filter < 0 || filter >= WII_FILTER_COUNT) {
+        filter = WII_FILTER_NONE;
+    }
+    if (filter != put_image_filter) {
+        put_image_filter = filter;
+        // The entire image must be rendered with the new filter
+        put_image_last_scale = 0;
+    }
+}
+
+/**
+ * Returns the filter applied when rendering the blit surface to the Wii
+ * surface
+ *
+ * @return  The filter (WII_FILTER_*)
+ */
+int wii_sdl_get_filter() {
+    return put_image_filter;
 }
 
 /**
  * Renders to the Wii surface.
  *
- * @param   scale The scale to render the surface (1 or 2)
+ * @param   scale The scale to render the surface (1, 2 and 3 have
+ *          specialized scalers for 8, 16 and 32bpp surfaces)
  */
 void wii_sdl_put_image_normal(int scale) {
-#if 0
-    // 16bpp+
-    SDL_Rect srcRect = {0, 0, blit_surface->w, blit_surface->h};
-    SDL_Rect destRect = {(WII_WIDTH - blit_surface->w) / 2,
-                         (WII_HEIGHT - blit_surface->h) / 2, 0, 0};
-
-    SDL_BlitSurface(blit_surface, &srcRect, back_surface, &destRect);
-#else
-    // 8bpp
+    int bpp = blit_surface->format->BytesPerPixel;
+    if (bpp != put_image_bpp ||
+        bpp != back_surface->format->BytesPerPixel) {
+        // The surfaces changed format since the scalers were selected
+        wii_sdl_select_scalers();
+    }
+
+    // Only the changed rows of the blit surface are copied when tracking
+    int top = 0;
+    int bottom = blit_surface->h;
+    if (dirty_tracking) {
+        if (scale != put_image_last_scale) {
+            put_image_last_scale = scale;
+            wii_sdl_mark_dirty(blit_surface, NULL);
+        }
+        top = blit_dirty.top;
+        bottom = blit_dirty.bottom;
+        blit_dirty.top = blit_dirty.bottom = 0;
+        if (top >= bottom) {
+            return;
+        }
+    }
+
+    if (!put_image_bpp) {
+        SDL_Rect srcRect = {0, (Sint16)top, (Uint16)blit_surface->w,
+                            (Uint16)(bottom - top)};
+        SDL_Rect destRect = {(Sint16)((WII_WIDTH - blit_surface->w) / 2),
+                             (Sint16)((WII_HEIGHT - blit_surface->h) / 2 +
+                                      top),
+                             0, 0};
+        SDL_BlitSurface(blit_surface, &srcRect, back_surface, &destRect);
+        wii_sdl_mark_dirty(back_surface, &destRect);
+        return;
+    }
+
     int offsetx = ((WII_WIDTH - (blit_surface->w * scale)) / 2);
     int offsety = ((WII_HEIGHT - (blit_surface->h * scale)) / 2);
 
-    int src = 0, dst = 0, start = 0, x = 0, y = 0, i = 0;
-    u8* backpixels = (u8*)back_surface->pixels;
-    u8* blitpixels = (u8*)blit_surface->pixels;
-    int startoffset = 0;
-    for (y = 0; y < blit_surface->h; y++) {
-        for (i = 0; i < scale; i++) {
-            start = startoffset + (y * blit_surface->w);
-            src = 0;
-            dst = ((((y * scale) + i) + offsety) * WII_WIDTH) + offsetx;
-            for (x = 0; x < blit_surface->w; x++) {
-                int j;
-                for (j = 0; j < scale; j++) {
-                    backpixels[dst++] = blitpixels[start + src];
-                }
-                src++;
-            }
-        }
+    if (wii_filter_supported(put_image_filter, bpp, scale)) {
+        // Rows next to the changed rows are affected by some filters
+        int reach = wii_filter_reach(put_image_filter);
+        top = top > reach ? top - reach : 0;
+        bottom = bottom + reach < blit_surface->h ? bottom + reach
+                                                  : blit_surface->h;
+        wii_filter_apply(put_image_filter, bpp,
+                         SDL_MapRGB(blit_surface->format, 0x0, 0x0, 0x0),
+                         blit_surface->pixels, blit_surface->pitch,
+                         (u8*)back_surface->pixels +
+                             (offsety * back_surface->pitch) +
+                             (offsetx * bpp),
+                         back_surface->pitch, blit_surface->w,
+                         blit_surface->h, scale, top, bottom);
+        wii_sdl_add_dirty_rows(back_surface, offsety + top * scale,
+                               offsety + bottom * scale);
+        return;
     }
-#endif
+
+    const u8* src =
+        (const u8*)blit_surface->pixels + (top * blit_surface->pitch);
+    u8* dst = (u8*)back_surface->pixels +
+              ((offsety + top * scale) * back_surface->pitch) +
+              (offsetx * bpp);
+    int w = blit_surface->w;
+    int h = bottom - top;
+    wii_sdl_add_dirty_rows(back_surface, offsety + top * scale,
+                           offsety + bottom * scale);
+    if (scale >= 1 && scale <= 3) {
+        put_image_scalers[scale - 1](src, blit_surface->pitch, dst,
+                                     back_surface->pitch, w, h);
+    } else if (bpp == 1) {
+        scale_image_any<u8>(scale, src, blit_surface->pitch, dst,
+                            back_surface->pitch, w, h);
+    } else if (bpp == 2) {
+        scale_image_any<u16>(scale, src, blit_surface->pitch, dst,
+                             back_surface->pitch, w, h);
+    } else {
+        scale_image_any<u32>(scale, src, blit_surface->pitch, dst,
+                             back_surface->pitch, w, h);
+    }
+}
+
+/**
+ * Converts an 8bpp surface into a tiled GX texture in one pass. The colors
+ * of the palette are converted to texels once, and again only when the
+ * palette of the surface changes.
+ *
+ * @param   surface The 8bpp surface
+ * @param   format The texture format (GX_TF_RGB565 or GX_TF_RGBA8)
+ * @param   texture The texture (the size of the surface padded to multiples
+ *          of four)
+ * @param   textureWidth The width of the texture (a multiple of four)
+ * @return  0 if successful, -1 if the surface or format is not supported
+ */
+int wii_sdl_surface_to_texture(SDL_Surface* surface,
+                               u8 format,
+                               void* texture,
+                               u16 textureWidth) {
+    SDL_Palette* palette = surface->format->palette;
+    if (surface->format->BytesPerPixel != 1 || palette == NULL) {
+        return -1;
+    }
+
+    int count = palette->ncolors < 256 ? palette->ncolors : 256;
+    if (count != texture_lut_count ||
+        memcmp(texture_lut_colors, palette->colors,
+               count * sizeof(SDL_Color))) {
+        memcpy(texture_lut_colors, palette->colors, count * sizeof(SDL_Color));
+        texture_lut_count = count;
+        texture_lut_version++;
+    }
+    if (wii_swizzle_lut_update(&texture_lut, format,
+                               (const u8*)texture_lut_colors, count,
+                               texture_lut_version, 0xff) < 0) {
+        return -1;
+    }
+
+    return wii_swizzle_indexed(
+        &texture_lut, (const u8*)surface->pixels + surface->offset,
+        surface->pitch, surface->w, surface->h, texture, textureWidth);
 }
 
 /**
@@ -163,6 +646,337 @@ void wii_sdl_get_text_size(TTF_Font* font, const char* text, int* w, int* h) {
     TTF_SizeText(font, text, w, h);
 }
 
+/**
+ * Returns the hash of the specified text
+ *
+ * @param   text The text
+ * @return  The hash of the text
+ */
+static u32 wii_sdl_text_hash(const char* text) {
+    u32 hash = 2166136261u;
+    for (const char* c = text; *c; c++) {
+        hash = (hash ^ (u8)*c) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Renders text into a surface of the display format
+ *
+ * @param   font The font to render with
+ * @param   text The text to render
+ * @param   fg The foreground color
+ * @param   shaded Whether to render the text shaded (on black)
+ * @return  The rendered text (NULL if it could not be rendered)
+ */
+static SDL_Surface* wii_sdl_render_text_surface(TTF_Font* font,
+                                                const char* text,
+                                                SDL_Color fg,
+                                                BOOL shaded) {
+    SDL_Surface* sText = shaded
+                             ? TTF_RenderText_Shaded(font, text, fg,
+                                                     SDL_COLOR_BLACK)
+                             : TTF_RenderText_Solid(font, text, fg);
+    if (sText == NULL) {
+        return NULL;
+    }
+
+    SDL_Surface* sTextDF = SDL_DisplayFormat(sText);
+    SDL_FreeSurface(sText);
+    return sTextDF;
+}
+
+/**
+ * Frees a rendered text cache entry
+ *
+ * @param   entry The entry
+ */
+static void wii_sdl_free_text_entry(text_surface* entry) {
+    if (entry->text == NULL) {
+        return;
+    }
+    free(entry->text);
+    entry->text = NULL;
+    if (entry->surface != NULL) {
+        SDL_FreeSurface(entry->surface);
+        entry->surface = NULL;
+    }
+    text_cache_bytes -= entry->bytes;
+    entry->bytes = 0;
+}
+
+/**
+ * Returns the rendered surface for the specified text. Surfaces are cached
+ * (least recently used are evicted) up to a count of TEXT_CACHE_SIZE and
+ * TEXT_CACHE_BYTES of memory.
+ *
+ * @param   font The font to render with
+ * @param   text The text to render
+ * @param   fg The foreground color
+ * @param   shaded Whether to render the text shaded (on black)
+ * @param   cachedOnly Whether to only return a cached surface (text with
+ *          numbers is composed from glyphs when not cached)
+ * @param   owned Whether the caller must free the surface (return value)
+ * @return  The rendered text (NULL if not cached and cachedOnly, or if it
+ *          could not be rendered)
+ */
+static SDL_Surface* wii_sdl_get_text_surface(TTF_Font* font,
+                                             const char* text,
+                                             SDL_Color fg,
+                                             BOOL shaded,
+                                             BOOL cachedOnly,
+                                             BOOL* owned) {
+    u32 hash = wii_sdl_text_hash(text);
+    u32 color = (fg.r << 16) | (fg.g << 8) | fg.b;
+    *owned = FALSE;
+
+    text_surface* oldest = &text_cache[0];
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        text_surface* entry = &text_cache[i];
+        if (entry->text && entry->textHash == hash && entry->font == font &&
+            entry->fg == color && entry->shaded == shaded &&
+            !strcmp(entry->text, text)) {
+            entry->lastUsed = ++text_cache_counter;
+            return entry->surface;
+        }
+        if (!entry->text ||
+            (oldest->text && entry->lastUsed < oldest->lastUsed)) {
+            oldest = entry;
+        }
+    }
+
+    if (cachedOnly) {
+        return NULL;
+    }
+
+    SDL_Surface* surface = wii_sdl_render_text_surface(font, text, fg, shaded);
+    if (surface == NULL) {
+        return NULL;
+    }
+
+    u32 bytes = surface->h * surface->pitch;
+    if (bytes > TEXT_CACHE_BYTES) {
+        *owned = TRUE;
+        return surface;
+    }
+
+    // Evict the least recently used entries until the surface fits
+    wii_sdl_free_text_entry(oldest);
+    while (text_cache_bytes + bytes > TEXT_CACHE_BYTES) {
+        text_surface* lru = NULL;
+        for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+            text_surface* entry = &text_cache[i];
+            if (entry->text && (!lru || entry->lastUsed < lru->lastUsed)) {
+                lru = entry;
+            }
+        }
+        wii_sdl_free_text_entry(lru);
+    }
+
+    oldest->text = strdup(text);
+    if (oldest->text == NULL) {
+        *owned = TRUE;
+        return surface;
+    }
+    oldest->textHash = hash;
+    oldest->font = font;
+    oldest->fg = color;
+    oldest->shaded = shaded;
+    oldest->surface = surface;
+    oldest->bytes = bytes;
+    oldest->lastUsed = ++text_cache_counter;
+    text_cache_bytes += bytes;
+
+    return surface;
+}
+
+/**
+ * Returns the glyph set for the specified font and color
+ *
+ * @param   font The font
+ * @param   fg The foreground color
+ * @param   shaded Whether the glyphs are rendered shaded (on black)
+ * @return  The glyph set
+ */
+static text_glyphs* wii_sdl_get_text_glyphs(TTF_Font* font,
+                                            SDL_Color fg,
+                                            BOOL shaded) {
+    u32 color = (fg.r << 16) | (fg.g << 8) | fg.b;
+    text_glyphs* set = NULL;
+    text_glyphs* oldest = &text_glyph_cache[0];
+    for (int i = 0; i < TEXT_GLYPH_SETS; i++) {
+        text_glyphs* glyphs = &text_glyph_cache[i];
+        if (glyphs->font == font && glyphs->fg == color &&
+            glyphs->shaded == shaded) {
+            set = glyphs;
+            break;
+        }
+        if (!glyphs->font ||
+            (oldest->font && glyphs->lastUsed < oldest->lastUsed)) {
+            oldest = glyphs;
+        }
+    }
+
+    if (set == NULL) {
+        set = oldest;
+        for (u32 i = 0; i < TEXT_GLYPH_COUNT; i++) {
+            if (set->glyphs[i] != NULL) {
+                SDL_FreeSurface(set->glyphs[i]);
+                set->glyphs[i] = NULL;
+            }
+        }
+        set->font = font;
+        set->fg = color;
+        set->shaded = shaded;
+    }
+    set->lastUsed = ++text_cache_counter;
+
+    return set;
+}
+
+/**
+ * Renders text containing numbers to the Wii surface. The numeric runs of
+ * the text are composed glyph by glyph from the cached glyphs of the font
+ * and color, the other runs are rendered through the text cache. So changing
+ * numbers such as counters don't require text to be rendered each frame.
+ *
+ * @param   font The font to render with
+ * @param   text The text to display
+ * @param   destRect The location to render the text
+ * @param   fg The foreground color
+ * @param   shaded Whether to render the text shaded (on black)
+ * @return  Whether the text was rendered
+ */
+static BOOL wii_sdl_render_composed_text(TTF_Font* font,
+                                         const char* text,
+                                         SDL_Rect* destRect,
+                                         SDL_Color fg,
+                                         BOOL shaded) {
+    text_glyphs* set = wii_sdl_get_text_glyphs(font, fg, shaded);
+
+    // Render the missing glyphs first, nothing is drawn if one fails
+    for (const char* c = text; *c; c++) {
+        const char* glyphChar = strchr(TEXT_GLYPH_CHARS, *c);
+        if (glyphChar == NULL) {
+            continue;
+        }
+        int index = glyphChar - TEXT_GLYPH_CHARS;
+        if (set->glyphs[index] == NULL) {
+            char glyph[2] = {*c, '\0'};
+            set->glyphs[index] =
+                wii_sdl_render_text_surface(font, glyph, fg, shaded);
+            if (set->glyphs[index] == NULL) {
+                return FALSE;
+            }
+        }
+    }
+
+    // The text is clipped to the size of the destination (if specified)
+    BOOL clip = destRect->w > 0 && destRect->h > 0;
+    int right = destRect->x + destRect->w;
+    int x = destRect->x;
+    int height = 0;
+    const char* c = text;
+    while (*c && (!clip || x < right)) {
+        SDL_Surface* part = NULL;
+        BOOL owned = FALSE;
+        const char* glyphChar = strchr(TEXT_GLYPH_CHARS, *c);
+        if (glyphChar != NULL) {
+            part = set->glyphs[glyphChar - TEXT_GLYPH_CHARS];
+            c++;
+        } else {
+            char run[128];
+            int len = strcspn(c, TEXT_GLYPH_CHARS);
+            if (len >= (int)sizeof(run)) {
+                len = sizeof(run) - 1;
+            }
+            memcpy(run, c, len);
+            run[len] = '\0';
+            c += len;
+            part = wii_sdl_get_text_surface(font, run, fg, shaded, FALSE,
+                                            &owned);
+            if (part == NULL) {
+                continue;
+            }
+        }
+
+        SDL_Rect srcRect = {0, 0, (Uint16)part->w, (Uint16)part->h};
+        if (clip) {
+            if (x + srcRect.w > right) {
+                srcRect.w = right - x;
+            }
+            if (srcRect.h > destRect->h) {
+                srcRect.h = destRect->h;
+            }
+        }
+        SDL_Rect partRect = {(Sint16)x, destRect->y, 0, 0};
+        SDL_BlitSurface(part, &srcRect, back_surface, &partRect);
+        if (owned) {
+            SDL_FreeSurface(part);
+        }
+        x += srcRect.w;
+        if (srcRect.h > height) {
+            height = srcRect.h;
+        }
+    }
+
+    destRect->w = x - destRect->x;
+    destRect->h = height;
+    wii_sdl_mark_dirty(back_surface, destRect);
+
+    return TRUE;
+}
+
+/**
+ * Frees the rendered text and glyphs of the specified font
+ *
+ * @param   font The font (NULL for all fonts)
+ */
+static void wii_sdl_free_font_text(TTF_Font* font) {
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        text_surface* entry = &text_cache[i];
+        if (font == NULL || entry->font == font) {
+            wii_sdl_free_text_entry(entry);
+        }
+    }
+    for (int i = 0; i < TEXT_GLYPH_SETS; i++) {
+        text_glyphs* set = &text_glyph_cache[i];
+        if (font != NULL && set->font != font) {
+            continue;
+        }
+        for (u32 j = 0; j < TEXT_GLYPH_COUNT; j++) {
+            if (set->glyphs[j] != NULL) {
+                SDL_FreeSurface(set->glyphs[j]);
+                set->glyphs[j] = NULL;
+            }
+        }
+        set->font = NULL;
+    }
+}
+
+/**
+ * Flushes the rendered text caches. Must be called when the format of the
+ * back surface changes.
+ */
+void wii_sdl_flush_text_cache() {
+    wii_sdl_free_font_text(NULL);
+}
+
+/**
+ * Closes the specified font. The cached text and glyphs of the font are
+ * freed first (they are keyed on the font pointer, which may be reused by
+ * a font opened later).
+ *
+ * @param   font The font to close
+ */
+void wii_sdl_close_font(TTF_Font* font) {
+    if (font == NULL) {
+        return;
+    }
+    wii_sdl_free_font_text(font);
+    TTF_CloseFont(font);
+}
+
 /**
  * Renders text to the Wii surface
  *
@@ -171,25 +985,35 @@ void wii_sdl_get_text_size(TTF_Font* font, const char* text, int* w, int* h) {
  * @param   destRect The location to render the text
  * @param   colorFG The forground color (optional)
  * @param   colorBG The background color (optional)
+ * @param   compose Whether to compose the numbers of text that is not cached
+ *          from cached glyphs
  */
-void wii_sdl_render_text(TTF_Font* font,
-                         const char* text,
-                         SDL_Rect* destRect,
-                         SDL_Color* colorFG,
-                         SDL_Color* colorBG) {
-    SDL_Surface* sText = NULL;
+static void wii_sdl_render_text_impl(TTF_Font* font,
+                                     const char* text,
+                                     SDL_Rect* destRect,
+                                     SDL_Color* colorFG,
+                                     SDL_Color* colorBG,
+                                     BOOL compose) {
+    SDL_Color fg = colorFG != NULL ? *colorFG : SDL_COLOR_WHITE;
+    BOOL shaded = colorBG != NULL;
 
-    if (colorBG != NULL) {
-        sText = TTF_RenderText_Shaded(
-            font, text, (colorFG != NULL ? *colorFG : SDL_COLOR_WHITE),
-            SDL_COLOR_BLACK);
-    } else {
-        sText = TTF_RenderText_Solid(
-            font, text, (colorFG != NULL ? *colorFG : SDL_COLOR_WHITE));
-    }
+    // Text with numbers is likely to change (counters and the like)
+    BOOL numeric = compose && strpbrk(text, "0123456789") != NULL;
 
-    if (sText == NULL) {
-        return;
+    BOOL owned;
+    SDL_Surface* sTextDF =
+        wii_sdl_get_text_surface(font, text, fg, shaded, numeric, &owned);
+    if (sTextDF == NULL) {
+        if (!numeric ||
+            wii_sdl_render_composed_text(font, text, destRect, fg, shaded)) {
+            return;
+        }
+        // Fall back to rendering the text as a whole
+        sTextDF = wii_sdl_render_text_surface(font, text, fg, shaded);
+        if (sTextDF == NULL) {
+            return;
+        }
+        owned = TRUE;
     }
 
     SDL_Rect srcRect = {0, 0, destRect->w, destRect->h};
@@ -198,23 +1022,47 @@ void wii_sdl_render_text(TTF_Font* font,
         srcRectPtr = &srcRect;
     }
 
-    SDL_Surface* sTextDF = SDL_DisplayFormat(sText);
-    SDL_FreeSurface(sText);
     SDL_BlitSurface(sTextDF, srcRectPtr, back_surface, destRect);
-    SDL_FreeSurface(sTextDF);
+    if (owned) {
+        SDL_FreeSurface(sTextDF);
+    }
+    wii_sdl_mark_dirty(back_surface, destRect);
 }
 
 /**
- * Returns a pointer to the specified x,y location in the Wii surface
+ * Renders text to the Wii surface. The rendered text is cached.
  *
- * @param   surface The surface
- * @param   x The x location
- * @param   y The y location
- * @return  A pointer to the specified x,y location in the Wii surface
+ * @param   font The font to render with
+ * @param   text The text to display
+ * @param   destRect The location to render the text
+ * @param   colorFG The forground color (optional)
+ * @param   colorBG The background color (optional)
+ */
+void wii_sdl_render_text(TTF_Font* font,
+                         const char* text,
+                         SDL_Rect* destRect,
+                         SDL_Color* colorFG,
+                         SDL_Color* colorBG) {
+    wii_sdl_render_text_impl(font, text, destRect, colorFG, colorBG, FALSE);
+}
+
+/**
+ * Renders text containing changing numbers (such as a counter) to the Wii
+ * surface. Text that is not cached as a whole is composed, its numbers are
+ * drawn from cached glyphs of the font and color.
+ *
+ * @param   font The font to render with
+ * @param   text The text to display
+ * @param   destRect The location to render the text
+ * @param   colorFG The forground color (optional)
+ * @param   colorBG The background color (optional)
  */
-static void* wii_sdl_get_vram_addr(SDL_Surface* surface, uint x, uint y) {
-    return ((u8*)surface->pixels) + surface->offset +
-           (x * surface->format->BytesPerPixel) + (y * surface->pitch);
+void wii_sdl_render_numeric_text(TTF_Font* font,
+                                 const char* text,
+                                 SDL_Rect* destRect,
+                                 SDL_Color* colorFG,
+                                 SDL_Color* colorBG) {
+    wii_sdl_render_text_impl(font, text, destRect, colorFG, colorBG, TRUE);
 }
 
 /**
@@ -235,96 +1083,12 @@ void wii_sdl_draw_rectangle(SDL_Surface* surface,
                             int h,
                             u32 border,
                             BOOL exor) {
-    if (x < 0) {
-        w += x;
-        x = 0;
-    }
-    if (y < 0) {
-        h += y;
-        y = 0;
-    }
-    if ((x + w) > surface->w)
-        w = surface->w - x;
-    if ((y + h) > surface->h)
-        h = surface->h - y;
-    if (w <= 0 || h <= 0)
+    if (!wii_span_clip(&x, &y, &w, &h, surface->w, surface->h))
         return;
 
-    BOOL is8 = surface->format->BytesPerPixel == 1;
-    BOOL is16 = surface->format->BytesPerPixel == 2;
-
-    int xo, yo;
-    if (exor) {
-        for (xo = x + 1; xo < (x + w - 1); xo++) {
-            if (is8)
-                *((u8*)wii_sdl_get_vram_addr(surface, xo, y)) ^= border;
-            else if (is16)
-                *((u16*)wii_sdl_get_vram_addr(surface, xo, y)) ^= border;
-            else
-                *((u32*)wii_sdl_get_vram_addr(surface, xo, y)) ^= border;
-            if (h > 1) {
-                if (is8)
-                    *((u8*)wii_sdl_get_vram_addr(surface, xo, y + h - 1)) ^= border;
-                else if (is16)
-                    *((u16*)wii_sdl_get_vram_addr(surface, xo, y + h - 1)) ^=
-                        border;
-                else
-                    *((u32*)wii_sdl_get_vram_addr(surface, xo, y + h - 1)) ^=
-                        border;
-            }
-        }
-        for (yo = y; yo < (y + h); yo++) {
-            if (is8)
-                *((u8*)wii_sdl_get_vram_addr(surface, x, yo)) ^= border;
-            else if (is16)
-                *((u16*)wii_sdl_get_vram_addr(surface, x, yo)) ^= border;
-            else
-                *((u32*)wii_sdl_get_vram_addr(surface, x, yo)) ^= border;
-            if (w > 1) {
-                if (is8)
-                    *((u8*)wii_sdl_get_vram_addr(surface, x + w - 1, yo)) ^= border;
-                else if (is16)
-                    *((u16*)wii_sdl_get_vram_addr(surface, x + w - 1, yo)) ^=
-                        border;
-                else
-                    *((u32*)wii_sdl_get_vram_addr(surface, x + w - 1, yo)) ^=
-                        border;
-            }
-        }
-    } else {
-        for (xo = x + 1; xo < (x + w - 1); xo++) {
-            if (is8)
-                *((u8*)wii_sdl_get_vram_addr(surface, xo, y)) = border;
-            else if (is16)
-                *((u16*)wii_sdl_get_vram_addr(surface, xo, y)) = border;
-            else
-                *((u32*)wii_sdl_get_vram_addr(surface, xo, y)) = border;
-            if (h > 1) {
-                if (is8)
-                    *((u8*)wii_sdl_get_vram_addr(surface, xo, y + h - 1)) = border;
-                else if (is16)
-                    *((u16*)wii_sdl_get_vram_addr(surface, xo, y + h - 1)) = border;
-                else
-                    *((u32*)wii_sdl_get_vram_addr(surface, xo, y + h - 1)) = border;
-            }
-        }
-        for (yo = y; yo < (y + h); yo++) {
-            if (is8)
-                *((u8*)wii_sdl_get_vram_addr(surface, x, yo)) = border;
-            else if (is16)
-                *((u16*)wii_sdl_get_vram_addr(surface, x, yo)) = border;
-            else
-                *((u32*)wii_sdl_get_vram_addr(surface, x, yo)) = border;
-            if (w > 1) {
-                if (is8)
-                    *((u8*)wii_sdl_get_vram_addr(surface, x + w - 1, yo)) = border;
-                else if (is16)
-                    *((u16*)wii_sdl_get_vram_addr(surface, x + w - 1, yo)) = border;
-                else
-                    *((u32*)wii_sdl_get_vram_addr(surface, x + w - 1, yo)) = border;
-            }
-        }
-    }
+    wii_span_frame((u8*)surface->pixels + surface->offset, surface->pitch,
+                   surface->format->BytesPerPixel, x, y, w, h, border, exor);
+    wii_sdl_add_dirty_rows(surface, y, y + h);
 }
 
 /**
@@ -343,32 +1107,12 @@ void wii_sdl_fill_rectangle(SDL_Surface* surface,
                             int w,
                             int h,
                             u32 color) {
-    if (x < 0) {
-        w += x;
-        x = 0;
-    }
-    if (y < 0) {
-        h += y;
-        y = 0;
-    }
-    if ((x + w) > surface->w)
-        w = surface->w - x;
-    if ((y + h) > surface->h)
-        h = surface->h - y;
-    if (w <= 0 || h <= 0)
+    if (!wii_span_clip(&x, &y, &w, &h, surface->w, surface->h))
         return;
 
-    BOOL is8 = surface->format->BytesPerPixel == 1;
-    int xo, yo;
-    for (xo = x; xo < w + x; xo++) {
-        for (yo = y; yo < h + y; yo++) {
-            if (is8) {
-                *((u8*)wii_sdl_get_vram_addr(surface, xo, yo)) = color;
-            } else {
-                *((u16*)wii_sdl_get_vram_addr(surface, xo, yo)) = color;
-            }
-        }
-    }
+    wii_span_fill((u8*)surface->pixels + surface->offset, surface->pitch,
+                  surface->format->BytesPerPixel, x, y, w, h, color, FALSE);
+    wii_sdl_add_dirty_rows(surface, y, y + h);
 }
 
 /**
@@ -380,6 +1124,9 @@ int wii_sdl_init() {
     // App initialization of the SDL
     wii_sdl_handle_init();
 
+    // Scalers for the pixel format of the surfaces
+    wii_sdl_select_scalers();
+
     // Don't show the cursor
     SDL_ShowCursor(SDL_DISABLE);
 
@@ -401,16 +1148,61 @@ int wii_sdl_init() {
 }
 
 /**
- * Renders the current back surface
+ * Renders the current back surface. If dirty tracking is enabled only the
+ * tile rows (groups of four rows) that changed since the last flip are
+ * uploaded, the flip is skipped if nothing changed. While triple buffering,
+ * the back surface is published for wii_sdl_present instead.
  */
 void wii_sdl_flip() {
-    SDL_Flip(back_surface);
+    if (screen_surface != NULL) {
+        // Publish the frame, it is displayed by wii_sdl_present
+        u32 next = wii_triple_buffer_publish(&triple_buffer);
+        back_surface = triple_surfaces[next];
+        back_dirty.top = back_dirty.bottom = 0;
+        // The free surface holds an older frame, the image is copied again
+        put_image_last_scale = 0;
+        return;
+    }
+
+    upload_stats.frames++;
+
+    int top = 0;
+    int bottom = back_surface->h;
+    if (dirty_tracking) {
+        top = back_dirty.top & ~3;
+        bottom = (back_dirty.bottom + 3) & ~3;
+        if (bottom > back_surface->h) {
+            bottom = back_surface->h;
+        }
+        back_dirty.top = back_dirty.bottom = 0;
+        if (top >= bottom) {
+            upload_stats.skippedFrames++;
+            upload_stats.lastBytes = 0;
+            return;
+        }
+    }
+
+    if (top == 0 && bottom == back_surface->h) {
+        SDL_Flip(back_surface);
+    } else if (back_surface->flags & SDL_DOUBLEBUF) {
+        // Double buffered surfaces can only be flipped as a whole
+        top = 0;
+        bottom = back_surface->h;
+        SDL_Flip(back_surface);
+    } else {
+        SDL_UpdateRect(back_surface, 0, top, back_surface->w, bottom - top);
+    }
+
+    upload_stats.lastBytes = (bottom - top) * back_surface->pitch;
+    upload_stats.totalBytes += upload_stats.lastBytes;
 }
 
 /**
  * Frees the SDL resources
  */
 void wii_sdl_free_resources() {
+    wii_sdl_flush_text_cache();
+    wii_sdl_set_triple_buffering(FALSE);
     if (back_surface != NULL) {
         SDL_FreeSurface(back_surface);
     }
@@ -418,17 +1210,9 @@ void wii_sdl_free_resources() {
         SDL_FreeSurface(blit_surface);
     }
 #if 0
-    if (sdl_font_18 != NULL) {
-        TTF_CloseFont(sdl_font_18);
-    }
-    if (sdl_font_14 != NULL) {
-        TTF_CloseFont(sdl_font_14);
-    }
-    if (sdl_font_13 != NULL) {
-        TTF_CloseFont(sdl_font_13);
-    }
-    if (sdl_font_12 != NULL) {
-        TTF_CloseFont(sdl_font_12);
-    }
+    wii_sdl_close_font(sdl_font_18);
+    wii_sdl_close_font(sdl_font_14);
+    wii_sdl_close_font(sdl_font_13);
+    wii_sdl_close_font(sdl_font_12);
 #endif
 }
@@ -0,0 +1,261 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#include <stdint.h>
+#include <string.h>
+
+#include "wii_span.h"
+
+//
+// Span writers are specialized by pixel type and by operation (set or
+// exclusive or). Horizontal spans are written a word at a time once the
+// destination is word aligned, vertical spans step a pointer by the pitch.
+//
+
+/**
+ * Sets pixels to the color
+ */
+struct SpanSet {
+    template <typename T> static inline void apply(T* p, T v) { *p = v; }
+};
+
+/**
+ * Exclusive ors the color with the pixels
+ */
+struct SpanXor {
+    template <typename T> static inline void apply(T* p, T v) { *p ^= v; }
+};
+
+/**
+ * Returns the color replicated across a word
+ *
+ * @param   color The color
+ * @return  The color replicated across a word
+ */
+template <typename Pixel>
+static inline u32 span_pattern(u32 color) {
+    u32 pattern = (Pixel)color;
+    for (unsigned int i = sizeof(Pixel); i < sizeof(u32); i <<= 1) {
+        pattern |= pattern << (i << 3);
+    }
+    return pattern;
+}
+
+/**
+ * Writes a horizontal span of pixels
+ *
+ * @param   dst The first pixel of the span
+ * @param   width The count of pixels
+ * @param   color The color
+ */
+template <typename Pixel, class Op>
+static inline void span_row(Pixel* dst, int width, u32 color) {
+    enum { PER_WORD = sizeof(u32) / sizeof(Pixel) };
+    Pixel pixel = (Pixel)color;
+    for (; width > 0 && ((uintptr_t)dst & (sizeof(u32) - 1)); width--) {
+        Op::apply(dst++, pixel);
+    }
+    u32 pattern = span_pattern<Pixel>(color);
+    u32* words = (u32*)dst;
+    for (int n = width / PER_WORD; n > 0; n--) {
+        Op::apply(words++, pattern);
+    }
+    dst = (Pixel*)words;
+    for (width &= PER_WORD - 1; width > 0; width--) {
+        Op::apply(dst++, pixel);
+    }
+}
+
+/**
+ * Writes a vertical span of pixels
+ *
+ * @param   dst The first pixel of the span
+ * @param   pitch The distance between the rows in bytes
+ * @param   height The count of pixels
+ * @param   color The color
+ */
+template <typename Pixel, class Op>
+static inline void span_column(u8* dst, int pitch, int height, u32 color) {
+    Pixel pixel = (Pixel)color;
+    for (; height > 0; height--, dst += pitch) {
+        Op::apply((Pixel*)dst, pixel);
+    }
+}
+
+/**
+ * Fills a rectangle a row at a time
+ */
+template <typename Pixel, class Op>
+static void span_fill(u8* dst, int pitch, int w, int h, u32 color) {
+    for (; h > 0; h--, dst += pitch) {
+        span_row<Pixel, Op>((Pixel*)dst, w, color);
+    }
+}
+
+/**
+ * Fills 8bpp rows with memset
+ */
+template <>
+void span_fill<u8, SpanSet>(u8* dst, int pitch, int w, int h, u32 color) {
+    for (; h > 0; h--, dst += pitch) {
+        memset(dst, (u8)color, w);
+    }
+}
+
+/**
+ * Draws the outline of a rectangle. The top and bottom rows exclude the
+ * corners, which are written by the left and right columns.
+ */
+template <typename Pixel, class Op>
+static void span_frame(u8* dst, int pitch, int w, int h, u32 color) {
+    if (w > 2) {
+        span_row<Pixel, Op>((Pixel*)dst + 1, w - 2, color);
+        if (h > 1) {
+            span_row<Pixel, Op>((Pixel*)(dst + (h - 1) * pitch) + 1, w - 2,
+                                color);
+        }
+    }
+    span_column<Pixel, Op>(dst, pitch, h, color);
+    if (w > 1) {
+        span_column<Pixel, Op>(dst + (w - 1) * sizeof(Pixel), pitch, h,
+                               color);
+    }
+}
+
+/** Writes a rectangle of pixels */
+typedef void (*span_rect_func)(u8* dst, int pitch, int w, int h, u32 color);
+
+/**
+ * Returns the writer for the specified pixel size and operation
+ *
+ * @param   fill Whether the rectangle is filled (or outlined)
+ * @param   bpp The bytes per pixel
+ * @param   exor Whether to exclusive or the color with the pixels
+ * @return  The writer (NULL if the pixel size is not supported)
+ */
+static span_rect_func span_select(BOOL fill, int bpp, BOOL exor) {
+    switch (bpp) {
+        case 1:
+            return fill ? (exor ? span_fill<u8, SpanXor>
+                                : span_fill<u8, SpanSet>)
+                        : (exor ? span_frame<u8, SpanXor>
+                                : span_frame<u8, SpanSet>);
+        case 2:
+            return fill ? (exor ? span_fill<u16, SpanXor>
+                                : span_fill<u16, SpanSet>)
+                        : (exor ? span_frame<u16, SpanXor>
+                                : span_frame<u16, SpanSet>);
+        case 4:
+            return fill ? (exor ? span_fill<u32, SpanXor>
+                                : span_fill<u32, SpanSet>)
+                        : (exor ? span_frame<u32, SpanXor>
+                                : span_frame<u32, SpanSet>);
+    }
+    return NULL;
+}
+
+/**
+ * Writes a rectangle of a pixel buffer
+ *
+ * @param   fill Whether the rectangle is filled (or outlined)
+ */
+static void span_rect(BOOL fill, void* pixels, int pitch, int bpp, int x,
+                      int y, int w, int h, u32 color, BOOL exor) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    span_rect_func func = span_select(fill, bpp, exor);
+    if (func != NULL) {
+        func((u8*)pixels + (y * pitch) + (x * bpp), pitch, w, h, color);
+    }
+}
+
+/**
+ * Clips a rectangle to the bounds of a pixel buffer
+ *
+ * @param   x The x location (updated)
+ * @param   y The y location (updated)
+ * @param   w The width (updated)
+ * @param   h The height (updated)
+ * @param   bufferW The width of the buffer
+ * @param   bufferH The height of the buffer
+ * @return  Whether any part of the rectangle lies within the buffer
+ */
+BOOL wii_span_clip(int* x, int* y, int* w, int* h, int bufferW, int bufferH) {
+    if (*x < 0) {
+        *w += *x;
+        *x = 0;
+    }
+    if (*y < 0) {
+        *h += *y;
+        *y = 0;
+    }
+    if ((*x + *w) > bufferW)
+        *w = bufferW - *x;
+    if ((*y + *h) > bufferH)
+        *h = bufferH - *y;
+    return *w > 0 && *h > 0;
+}
+
+/**
+ * Fills a rectangle of a pixel buffer a horizontal span (row) at a time. The
+ * rectangle must lie within the buffer.
+ *
+ * @param   pixels The first pixel of the buffer
+ * @param   pitch The distance between the rows of the buffer in bytes
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   x The x location
+ * @param   y The y location
+ * @param   w The width
+ * @param   h The height
+ * @param   color The color
+ * @param   exor Whether to exclusive or the color with the pixels
+ */
+void wii_span_fill(void* pixels, int pitch, int bpp, int x, int y, int w,
+                   int h, u32 color, BOOL exor) {
+    span_rect(TRUE, pixels, pitch, bpp, x, y, w, h, color, exor);
+}
+
+/**
+ * Draws the outline of a rectangle of a pixel buffer. Each pixel of the
+ * outline is written once (corners are not exclusive or'd twice). The
+ * rectangle must lie within the buffer.
+ *
+ * @param   pixels The first pixel of the buffer
+ * @param   pitch The distance between the rows of the buffer in bytes
+ * @param   bpp The bytes per pixel (1, 2 or 4)
+ * @param   x The x location
+ * @param   y The y location
+ * @param   w The width
+ * @param   h The height
+ * @param   color The color
+ * @param   exor Whether to exclusive or the color with the pixels
+ */
+void wii_span_frame(void* pixels, int pitch, int bpp, int x, int y, int w,
+                    int h, u32 color, BOOL exor) {
+    span_rect(FALSE, pixels, pitch, bpp, x, y, w, h, color, exor);
+}
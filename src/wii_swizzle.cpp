@@ -0,0 +1,424 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#include <gccore.h>
+#include <string.h>
+
+#include "wii_swizzle.h"
+
+/**
+ * Converts the rectangle to the specified texture format
+ *
+ * @param   format The texture format (GX_TF_*)
+ * @param   rows The source row layout
+ * @param   pixel The source pixel format
+ * @param   srcX The first source column of the rectangle
+ * @param   width The width of the rectangle
+ * @param   height The height of the rectangle
+ * @param   dst The texture
+ * @param   dstWidth The width of the texture
+ * @param   dstX The tile aligned column the rectangle is written to
+ * @param   dstY The tile aligned row the rectangle is written to
+ * @return  0 if successful, -1 if the format is not supported
+ */
+template <class Pixel, class Rows>
+static int swizzle_format(u8 format, const Rows& rows, const Pixel& pixel,
+                          u16 srcX, u16 width, u16 height, void* dst,
+                          u16 dstWidth, u16 dstX, u16 dstY) {
+    switch (format) {
+        case GX_TF_I4:
+            wii_swizzle<SwizzleI4>(rows, pixel, srcX, width, height, dst,
+                                   dstWidth, dstX, dstY);
+            break;
+        case GX_TF_I8:
+            wii_swizzle<SwizzleI8>(rows, pixel, srcX, width, height, dst,
+                                   dstWidth, dstX, dstY);
+            break;
+        case GX_TF_IA4:
+            wii_swizzle<SwizzleIA4>(rows, pixel, srcX, width, height, dst,
+                                    dstWidth, dstX, dstY);
+            break;
+        case GX_TF_IA8:
+            wii_swizzle<SwizzleIA8>(rows, pixel, srcX, width, height, dst,
+                                    dstWidth, dstX, dstY);
+            break;
+        case GX_TF_RGB565:
+            wii_swizzle<SwizzleRGB565>(rows, pixel, srcX, width, height, dst,
+                                       dstWidth, dstX, dstY);
+            break;
+        case GX_TF_RGB5A3:
+            wii_swizzle<SwizzleRGB5A3>(rows, pixel, srcX, width, height, dst,
+                                       dstWidth, dstX, dstY);
+            break;
+        case GX_TF_RGBA8:
+            wii_swizzle<SwizzleRGBA8>(rows, pixel, srcX, width, height, dst,
+                                      dstWidth, dstX, dstY);
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * RGBA8 tile reader (32 bytes of AR pairs followed by 32 bytes of GB pairs)
+ */
+struct DeswizzleRGBA8 {
+    enum { TILE_BYTES = 64 };
+    static inline void readRow(const u8* tile, int row, u8* rgb) {
+        const u8* ar = tile + (row << 3);
+        const u8* gb = ar + 32;
+        for (int i = 0; i < 4; i++, ar += 2, gb += 2, rgb += 3) {
+            rgb[0] = ar[1];
+            rgb[1] = gb[0];
+            rgb[2] = gb[1];
+        }
+    }
+};
+
+/**
+ * RGB565 tile reader (components are widened by replicating their high bits)
+ */
+struct DeswizzleRGB565 {
+    enum { TILE_BYTES = 32 };
+    static inline void readRow(const u8* tile, int row, u8* rgb) {
+        const u8* p = tile + (row << 3);
+        for (int i = 0; i < 4; i++, p += 2, rgb += 3) {
+            u32 r = p[0] >> 3;
+            u32 g = ((p[0] & 0x07) << 3) | (p[1] >> 5);
+            u32 b = p[1] & 0x1f;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+    }
+};
+
+/**
+ * Converts a band of 4x4 tiles into RGB rows, a whole tile per iteration.
+ * The last tile of a row is converted through a temporary if the image
+ * doesn't cover it.
+ *
+ * @param   src The texture
+ * @param   width The width of the image held by the texture
+ * @param   bandY The first texel row of the band
+ * @param   height The count of rows to convert (at most four)
+ * @param   dst The first RGB row
+ * @param   dstPitch The distance between the RGB rows in bytes
+ */
+template <class Texture>
+static void deswizzle_band(const u8* src, u16 width, u16 bandY, u16 height,
+                           u8* dst, int dstPitch) {
+    int tiles = (width + 3) >> 2;
+    int whole = width >> 2;
+    const u8* tile = src + (bandY >> 2) * tiles * Texture::TILE_BYTES;
+
+    for (int tx = 0; tx < whole; tx++, tile += Texture::TILE_BYTES) {
+        u8* out = dst + tx * 12;
+        for (int row = 0; row < height; row++, out += dstPitch) {
+            Texture::readRow(tile, row, out);
+        }
+    }
+
+    if (whole < tiles) {
+        u8 rgb[12];
+        u8* out = dst + whole * 12;
+        for (int row = 0; row < height; row++, out += dstPitch) {
+            Texture::readRow(tile, row, rgb);
+            memcpy(out, rgb, (width & 3) * 3);
+        }
+    }
+}
+
+/**
+ * Converts a band of tiles (four texel rows) of a tiled GX texture into RGB
+ * rows (R, G, B bytes). Alpha is dropped.
+ *
+ * @param   format The texture format (GX_TF_RGBA8 or GX_TF_RGB565)
+ * @param   src The texture
+ * @param   width The width of the image held by the texture (the texture is
+ *          padded to a multiple of the tile width)
+ * @param   bandY The first texel row of the band (a multiple of four)
+ * @param   height The count of rows to convert (at most four)
+ * @param   dst The first RGB row
+ * @param   dstPitch The distance between the RGB rows in bytes
+ * @return  0 if successful, -1 if the format is not supported
+ */
+extern "C" int wii_deswizzle_rgb8(u8 format, const void* src, u16 width,
+                                  u16 bandY, u16 height, u8* dst,
+                                  int dstPitch) {
+    switch (format) {
+        case GX_TF_RGBA8:
+            deswizzle_band<DeswizzleRGBA8>((const u8*)src, width, bandY,
+                                           height, dst, dstPitch);
+            break;
+        case GX_TF_RGB565:
+            deswizzle_band<DeswizzleRGB565>((const u8*)src, width, bandY,
+                                            height, dst, dstPitch);
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * Converts a rectangle of source rows into a region of a tiled GX texture.
+ * Texels of partially covered tiles that lie outside of the rectangle are
+ * cleared.
+ *
+ * @param   format The texture format (GX_TF_*)
+ * @param   srcLayout The layout of the source rows (WII_SWIZZLE_SRC_*)
+ * @param   rows The source rows (rows[0] is the first row of the rectangle)
+ * @param   srcX The first source column of the rectangle
+ * @param   width The width of the rectangle
+ * @param   height The height of the rectangle
+ * @param   defaultAlpha The alpha for sources without an alpha component
+ * @param   dst The texture
+ * @param   dstWidth The width of the texture (a multiple of the tile width)
+ * @param   dstX The tile aligned column the rectangle is written to
+ * @param   dstY The tile aligned row the rectangle is written to
+ * @return  0 if successful, -1 if the format or layout is not supported
+ */
+extern "C" int wii_swizzle_rows(u8 format, int srcLayout, const u8* const* rows,
+                                u16 srcX, u16 width, u16 height,
+                                u8 defaultAlpha, void* dst, u16 dstWidth,
+                                u16 dstX, u16 dstY) {
+    SwizzlePointerRows src(rows);
+    switch (srcLayout) {
+        case WII_SWIZZLE_SRC_RGB8:
+            return swizzle_format(format, src, SwizzlePixelRGB8(defaultAlpha),
+                                  srcX, width, height, dst, dstWidth, dstX,
+                                  dstY);
+        case WII_SWIZZLE_SRC_RGBA8:
+            return swizzle_format(format, src, SwizzlePixelRGBA8(), srcX,
+                                  width, height, dst, dstWidth, dstX, dstY);
+        case WII_SWIZZLE_SRC_I8:
+            return swizzle_format(format, src, SwizzlePixelI8(), srcX, width,
+                                  height, dst, dstWidth, dstX, dstY);
+        case WII_SWIZZLE_SRC_IA8:
+            return swizzle_format(format, src, SwizzlePixelIA8(), srcX, width,
+                                  height, dst, dstWidth, dstX, dstY);
+    }
+    return -1;
+}
+
+/**
+ * RGB565 texture of indexed pixels, the palette texels are RGB565 values
+ */
+struct IndexedRGB565 {
+    enum { TILE_BYTES = 32 };
+    static inline void writeRow(u8* tile, int row, const u32* lut,
+                                const u8* p) {
+#ifdef WII_SWIZZLE_SWAR
+        u32* d = (u32*)tile + (row << 1);
+        d[0] = (lut[p[0]] << 16) | lut[p[1]];
+        d[1] = (lut[p[2]] << 16) | lut[p[3]];
+#else
+        u8* d = tile + (row << 3);
+        for (int i = 0; i < 4; i++) {
+            u32 texel = lut[p[i]];
+            d[i << 1] = texel >> 8;
+            d[(i << 1) + 1] = texel;
+        }
+#endif
+    }
+    static inline void clearRow(u8* tile, int row, int from) {
+        u16* d = (u16*)tile + (row << 2);
+        for (int i = from; i < 4; i++) {
+            d[i] = 0;
+        }
+    }
+};
+
+/**
+ * RGBA8 texture of indexed pixels, the palette texels are AR << 16 | GB
+ */
+struct IndexedRGBA8 {
+    enum { TILE_BYTES = 64 };
+    static inline void writeRow(u8* tile, int row, const u32* lut,
+                                const u8* p) {
+        u32 t0 = lut[p[0]], t1 = lut[p[1]], t2 = lut[p[2]], t3 = lut[p[3]];
+#ifdef WII_SWIZZLE_SWAR
+        u32* ar = (u32*)tile + (row << 1);
+        u32* gb = ar + 8;
+        ar[0] = (t0 & 0xffff0000) | (t1 >> 16);
+        ar[1] = (t2 & 0xffff0000) | (t3 >> 16);
+        gb[0] = (t0 << 16) | (t1 & 0xffff);
+        gb[1] = (t2 << 16) | (t3 & 0xffff);
+#else
+        const u32 t[4] = {t0, t1, t2, t3};
+        u8* ar = tile + (row << 3);
+        u8* gb = ar + 32;
+        for (int i = 0; i < 4; i++, ar += 2, gb += 2) {
+            ar[0] = t[i] >> 24;
+            ar[1] = t[i] >> 16;
+            gb[0] = t[i] >> 8;
+            gb[1] = t[i];
+        }
+#endif
+    }
+    static inline void clearRow(u8* tile, int row, int from) {
+        u16* ar = (u16*)tile + (row << 2);
+        for (int i = from; i < 4; i++) {
+            ar[i] = ar[i + 16] = 0;
+        }
+    }
+};
+
+/**
+ * Converts an indexed image into a tiled texture. Whole tiles are converted
+ * with the four tile rows unrolled, partially covered tiles are converted a
+ * row at a time and their texels outside of the image are cleared.
+ *
+ * @param   lut The palette texels
+ * @param   src The first row of the image
+ * @param   srcPitch The distance between the rows of the image in bytes
+ * @param   width The width of the image
+ * @param   height The height of the image
+ * @param   dst The texture
+ * @param   dstWidth The width of the texture (a multiple of four)
+ */
+template <class Texture>
+static void swizzle_indexed(const u32* lut, const u8* src, int srcPitch,
+                            u16 width, u16 height, void* dst, u16 dstWidth) {
+    const u32 tileRowBytes = (dstWidth >> 2) * Texture::TILE_BYTES;
+    const int tilesWide = (width + 3) >> 2;
+    const int fullTilesWide = width >> 2;
+    u8* tileRow = (u8*)dst;
+
+    for (int ty = 0; ty < height; ty += 4, tileRow += tileRowBytes) {
+        const u8* r0 = src + ty * srcPitch;
+        u8* tile = tileRow;
+        if (ty + 4 <= height) {
+            const u8* r1 = r0 + srcPitch;
+            const u8* r2 = r1 + srcPitch;
+            const u8* r3 = r2 + srcPitch;
+            for (int tx = 0; tx < fullTilesWide;
+                 tx++, tile += Texture::TILE_BYTES) {
+                const int x = tx << 2;
+                Texture::writeRow(tile, 0, lut, r0 + x);
+                Texture::writeRow(tile, 1, lut, r1 + x);
+                Texture::writeRow(tile, 2, lut, r2 + x);
+                Texture::writeRow(tile, 3, lut, r3 + x);
+            }
+        }
+
+        // Tiles at the right and bottom edges of the image
+        for (int tx = (ty + 4 <= height ? fullTilesWide : 0); tx < tilesWide;
+             tx++, tile += Texture::TILE_BYTES) {
+            const int x = tx << 2;
+            const int cols = width - x < 4 ? width - x : 4;
+            for (int r = 0; r < 4; r++) {
+                u8 indices[4] = {0, 0, 0, 0};
+                if (ty + r < height) {
+                    memcpy(indices, r0 + r * srcPitch + x, cols);
+                }
+                Texture::writeRow(tile, r, lut, indices);
+                // Clear the texels outside of the image
+                Texture::clearRow(tile, r, ty + r < height ? cols : 0);
+            }
+        }
+
+        // Tiles of the texture right of the image
+        memset(tile, 0, tileRow + tileRowBytes - tile);
+    }
+}
+
+/**
+ * Computes the texels of a palette, unless they were computed for the same
+ * texture format and palette version already
+ *
+ * @param   lut The palette texels
+ * @param   format The texture format (GX_TF_RGB565 or GX_TF_RGBA8)
+ * @param   colors The colors of the palette, four bytes per color (R, G, B
+ *          and an unused byte, as SDL_Color)
+ * @param   count The count of colors (at most 256)
+ * @param   version The version of the palette (changes with its colors)
+ * @param   alpha The alpha of the colors (RGBA8)
+ * @return  0 if the texels are up to date, -1 if the format is not supported
+ */
+extern "C" int wii_swizzle_lut_update(wii_swizzle_lut* lut, u8 format,
+                                      const u8* colors, int count,
+                                      u32 version, u8 alpha) {
+    if (format != GX_TF_RGB565 && format != GX_TF_RGBA8) {
+        return -1;
+    }
+    if (lut->valid && lut->format == format && lut->version == version) {
+        return 0;
+    }
+
+    if (count > 256) {
+        count = 256;
+    }
+    int i = 0;
+    for (const u8* c = colors; i < count; i++, c += 4) {
+        u32 t = ((u32)c[0] << 24) | (c[1] << 16) | (c[2] << 8) | alpha;
+        lut->texels[i] = format == GX_TF_RGB565
+                             ? wii_swizzle_pack_rgb565(t)
+                             : ((u32)alpha << 24) | (c[0] << 16) |
+                                   (c[1] << 8) | c[2];
+    }
+    for (; i < 256; i++) {
+        lut->texels[i] = 0;
+    }
+
+    lut->format = format;
+    lut->version = version;
+    lut->valid = TRUE;
+    return 0;
+}
+
+/**
+ * Converts an indexed (8bpp) image into a tiled GX texture of the format of
+ * the palette texels, in one pass. Texels of the texture that lie outside of
+ * the image are cleared.
+ *
+ * @param   lut The palette texels
+ * @param   src The first row of the image
+ * @param   srcPitch The distance between the rows of the image in bytes
+ * @param   width The width of the image
+ * @param   height The height of the image
+ * @param   dst The texture (its height is a multiple of four)
+ * @param   dstWidth The width of the texture (a multiple of four)
+ * @return  0 if successful, -1 if the palette texels are not computed
+ */
+extern "C" int wii_swizzle_indexed(const wii_swizzle_lut* lut, const u8* src,
+                                   int srcPitch, u16 width, u16 height,
+                                   void* dst, u16 dstWidth) {
+    if (!lut->valid) {
+        return -1;
+    }
+    if (lut->format == GX_TF_RGB565) {
+        swizzle_indexed<IndexedRGB565>(lut->texels, src, srcPitch, width,
+                                       height, dst, dstWidth);
+    } else {
+        swizzle_indexed<IndexedRGBA8>(lut->texels, src, srcPitch, width,
+                                      height, dst, dstWidth);
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#include "wii_triple_buffer.h"
+
+/** Set in the middle index when it holds a frame the consumer has not seen */
+#define TRIPLE_BUFFER_NEW 0x4
+/** Mask of the buffer index of the middle index */
+#define TRIPLE_BUFFER_INDEX 0x3
+
+/**
+ * Initializes the exchange. The producer starts with buffer 0, the consumer
+ * with buffer 2.
+ *
+ * @param   tb The exchange
+ */
+void wii_triple_buffer_init(wii_triple_buffer* tb) {
+    tb->back = 0;
+    tb->middle = 1;
+    tb->front = 2;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * Publishes the buffer drawn by the producer as the newest frame (called by
+ * the producer)
+ *
+ * @param   tb The exchange
+ * @return  The index of the buffer the producer draws into next
+ */
+u32 wii_triple_buffer_publish(wii_triple_buffer* tb) {
+    // Release orders the drawing before the swap
+    u32 middle = __atomic_exchange_n(&tb->middle, tb->back | TRIPLE_BUFFER_NEW,
+                                     __ATOMIC_ACQ_REL);
+    tb->back = middle & TRIPLE_BUFFER_INDEX;
+    return tb->back;
+}
+
+/**
+ * Takes the newest frame published by the producer, if any (called by the
+ * consumer). The index of the frame is available in the front member.
+ *
+ * @param   tb The exchange
+ * @return  Whether a new frame was taken
+ */
+BOOL wii_triple_buffer_acquire(wii_triple_buffer* tb) {
+    // Only the producer sets the new flag, so it can't be cleared before the
+    // swap below
+    u32 middle = __atomic_load_n(&tb->middle, __ATOMIC_RELAXED);
+    if (!(middle & TRIPLE_BUFFER_NEW)) {
+        return FALSE;
+    }
+    // Acquire orders the reads of the frame after the swap
+    middle = __atomic_exchange_n(&tb->middle, tb->front, __ATOMIC_ACQ_REL);
+    tb->front = middle & TRIPLE_BUFFER_INDEX;
+    return TRUE;
+}
@@ -0,0 +1,154 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+#include "wii_ycbcr.h"
+
+#ifdef WII_YCBCR_LUT
+
+/**
+ * Per channel tables of the fixed point products. The luma tables hold the
+ * products of a single pixel, the chroma tables the products of the sum of
+ * the two pixels of a pair (so they have 511 entries). The chroma bias is
+ * folded into the blue (Cb) and red (Cr) tables.
+ */
+static struct ycbcr_tables {
+    s32 yR[256], yG[256], yB[256];
+    s32 cbR[511], cbG[511], cbB[511];
+    s32 crR[511], crG[511], crB[511];
+    s32 rCr[256], gCb[256], gCr[256], bCb[256];
+
+    ycbcr_tables() {
+        for (int i = 0; i < 256; i++) {
+            yR[i] = 19595 * i;
+            yG[i] = 38470 * i;
+            yB[i] = 7471 * i + 0x7fff;
+            rCr[i] = (91881 * (i - 128) + 0x8000) >> WII_YCBCR_SHIFT;
+            gCb[i] = -22554 * (i - 128);
+            gCr[i] = -46802 * (i - 128) + 0x8000;
+            bCb[i] = (116130 * (i - 128) + 0x8000) >> WII_YCBCR_SHIFT;
+        }
+        for (int i = 0; i < 511; i++) {
+            cbR[i] = -11059 * i;
+            cbG[i] = -21709 * i;
+            cbB[i] = 32768 * i + (WII_YCBCR_CHROMA_BIAS << 1);
+            crR[i] = 32768 * i + (WII_YCBCR_CHROMA_BIAS << 1);
+            crG[i] = -27439 * i;
+            crB[i] = -5329 * i;
+        }
+    }
+} tables;
+
+#endif
+
+/**
+ * Converts a row of RGB pixels to Y1CbY2Cr pairs
+ *
+ * @param   src The pixels (R, G, B bytes)
+ * @param   dst The pairs
+ * @param   width The count of pixels (must be even)
+ */
+void wii_ycbcr_from_rgb8_row(const u8* src, u32* dst, int width) {
+    for (int x = width >> 1; x > 0; x--, src += 6) {
+#ifdef WII_YCBCR_LUT
+        int r = src[0] + src[3], g = src[1] + src[4], b = src[2] + src[5];
+        u32 y1 = (tables.yR[src[0]] + tables.yG[src[1]] + tables.yB[src[2]]) >>
+                 WII_YCBCR_SHIFT;
+        u32 y2 = (tables.yR[src[3]] + tables.yG[src[4]] + tables.yB[src[5]]) >>
+                 WII_YCBCR_SHIFT;
+        u32 cb = (tables.cbR[r] + tables.cbG[g] + tables.cbB[b]) >>
+                 (WII_YCBCR_SHIFT + 1);
+        u32 cr = (tables.crR[r] + tables.crG[g] + tables.crB[b]) >>
+                 (WII_YCBCR_SHIFT + 1);
+        *dst++ = (y1 << 24) | (cb << 16) | (y2 << 8) | cr;
+#else
+        *dst++ = wii_ycbcr_from_rgb(src[0], src[1], src[2], src[3], src[4],
+                                    src[5]);
+#endif
+    }
+}
+
+/**
+ * Converts a row of Y1CbY2Cr pairs to RGB pixels
+ *
+ * @param   src The pairs
+ * @param   dst The pixels (R, G, B bytes)
+ * @param   width The count of pixels (must be even)
+ */
+void wii_ycbcr_to_rgb8_row(const u32* src, u8* dst, int width) {
+    for (int x = width >> 1; x > 0; x--, dst += 6) {
+#ifdef WII_YCBCR_LUT
+        u32 p = *src++;
+        int y1 = p >> 24, cb = (p >> 16) & 0xff, y2 = (p >> 8) & 0xff,
+            cr = p & 0xff;
+        int r = tables.rCr[cr];
+        int g = (tables.gCb[cb] + tables.gCr[cr]) >> WII_YCBCR_SHIFT;
+        int b = tables.bCb[cb];
+        dst[0] = wii_ycbcr_clamp(y1 + r);
+        dst[1] = wii_ycbcr_clamp(y1 + g);
+        dst[2] = wii_ycbcr_clamp(y1 + b);
+        dst[3] = wii_ycbcr_clamp(y2 + r);
+        dst[4] = wii_ycbcr_clamp(y2 + g);
+        dst[5] = wii_ycbcr_clamp(y2 + b);
+#else
+        wii_ycbcr_to_rgb(*src++, dst);
+#endif
+    }
+}
+
+/**
+ * Converts an RGB image to Y1CbY2Cr pairs
+ *
+ * @param   src The image (R, G, B bytes)
+ * @param   srcPitch The distance between the image rows in bytes
+ * @param   dst The pairs
+ * @param   dstPitch The distance between the pair rows in pairs
+ * @param   width The width of the image (must be even)
+ * @param   height The height of the image
+ */
+void wii_ycbcr_from_rgb8(const u8* src, int srcPitch, u32* dst, int dstPitch,
+                         int width, int height) {
+    for (int y = 0; y < height; y++, src += srcPitch, dst += dstPitch) {
+        wii_ycbcr_from_rgb8_row(src, dst, width);
+    }
+}
+
+/**
+ * Converts Y1CbY2Cr pairs to an RGB image
+ *
+ * @param   src The pairs
+ * @param   srcPitch The distance between the pair rows in pairs
+ * @param   dst The image (R, G, B bytes)
+ * @param   dstPitch The distance between the image rows in bytes
+ * @param   width The width of the image (must be even)
+ * @param   height The height of the image
+ */
+void wii_ycbcr_to_rgb8(const u32* src, int srcPitch, u8* dst, int dstPitch,
+                       int width, int height) {
+    for (int y = 0; y < height; y++, src += srcPitch, dst += dstPitch) {
+        wii_ycbcr_to_rgb8_row(src, dst, width);
+    }
+}
@@ -0,0 +1,111 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Measures the frames per second of the filters for a 256x224 source image
+// at scales 2 and 3, next to the plain integer scalers
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gctypes.h>
+
+#include "wii_filter.h"
+#include "wii_scale.h"
+
+#define WIDTH 256
+#define HEIGHT 224
+#define DST_WIDTH 768
+#define FRAMES 300
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/** Scales an image into the destination */
+typedef void (*scaler)(const u8* src, int srcPitch, u8* dst, int dstPitch,
+                       int width, int height);
+
+int main() {
+    static const char* names[] = {"none", "scalenx", "scanlines", "lcdgrid"};
+    static const int bpps[] = {1, 2, 4};
+    static const scaler scalers[3][2] = {
+        {scale_image<ScaleRow8<2>, 2, u8>, scale_image<ScaleRow8<3>, 3, u8>},
+        {scale_image<ScaleRow16<2>, 2, u16>,
+         scale_image<ScaleRow16<3>, 3, u16>},
+        {scale_image<ScaleRow32<2>, 2, u32>,
+         scale_image<ScaleRow32<3>, 3, u32>}};
+
+    u8* dst = (u8*)malloc(DST_WIDTH * HEIGHT * 3 * 4);
+    u32 sum = 0;
+
+    printf("frames/s           x2       x3\n");
+    for (int b = 0; b < 3; b++) {
+        int bpp = bpps[b];
+        u8* src = (u8*)malloc(WIDTH * HEIGHT * bpp);
+        // Mostly flat areas with some detail, as in pixel art
+        for (int i = 0; i < WIDTH * HEIGHT * bpp; i++) {
+            src[i] = (rand() % 4) * ((i % 7) == 0);
+        }
+
+        for (int filter = WII_FILTER_NONE; filter < WII_FILTER_COUNT;
+             filter++) {
+            printf("%2dbpp %-9s", bpp * 8, names[filter]);
+            for (int scale = 2; scale <= 3; scale++) {
+                double start = now();
+                for (int n = 0; n < FRAMES; n++) {
+                    if (filter == WII_FILTER_NONE) {
+                        scalers[b][scale - 2](src, WIDTH * bpp, dst,
+                                              DST_WIDTH * bpp, WIDTH, HEIGHT);
+                    } else {
+                        wii_filter_apply(filter, bpp, 0, src, WIDTH * bpp,
+                                         dst, DST_WIDTH * bpp, WIDTH, HEIGHT,
+                                         scale, 0, HEIGHT);
+                    }
+                }
+                printf(" %8.0f", FRAMES / (now() - start));
+            }
+            printf("\n");
+        }
+
+        for (int i = 0; i < DST_WIDTH * HEIGHT * bpp; i++) {
+            sum += dst[i];
+        }
+        free(src);
+    }
+    printf("[%08x]\n", sum);
+
+    free(dst);
+    return 0;
+}
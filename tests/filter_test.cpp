@@ -0,0 +1,201 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Tests the filters against pixel at a time references on random images,
+// for every pixel size, and that filtering a range of rows in parts gives
+// the same image as filtering it at once
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gctypes.h>
+
+#include "wii_filter.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/** The black pixel passed to the filters */
+#define BLACK 0x5a
+
+/**
+ * Returns the pixel of the image, clamping the location to its edges
+ */
+template <typename Pixel>
+static Pixel ref_pixel(const Pixel* src, int w, int h, int x, int y) {
+    x = x < 0 ? 0 : (x >= w ? w - 1 : x);
+    y = y < 0 ? 0 : (y >= h ? h - 1 : y);
+    return src[y * w + x];
+}
+
+/**
+ * Returns the darkened pixel
+ */
+template <typename Pixel>
+static Pixel ref_dark(Pixel p) {
+    switch (sizeof(Pixel)) {
+        case 1:
+            return BLACK;
+        case 2:
+            return (p >> 1) & 0x7bef;
+        default:
+            return (p >> 1) & 0x7f7f7f7f;
+    }
+}
+
+/**
+ * Filters the image a destination pixel at a time
+ */
+template <typename Pixel>
+static void ref_filter(int filter, const Pixel* s, int w, int h, Pixel* d,
+                       int scale) {
+    int dw = w * scale;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            Pixel A = ref_pixel(s, w, h, x - 1, y - 1);
+            Pixel B = ref_pixel(s, w, h, x, y - 1);
+            Pixel C = ref_pixel(s, w, h, x + 1, y - 1);
+            Pixel D = ref_pixel(s, w, h, x - 1, y);
+            Pixel E = ref_pixel(s, w, h, x, y);
+            Pixel F = ref_pixel(s, w, h, x + 1, y);
+            Pixel G = ref_pixel(s, w, h, x - 1, y + 1);
+            Pixel H = ref_pixel(s, w, h, x, y + 1);
+            Pixel I = ref_pixel(s, w, h, x + 1, y + 1);
+            Pixel o[9];
+            for (int i = 0; i < scale * scale; i++) {
+                int ox = i % scale, oy = i / scale;
+                o[i] = E;
+                if (filter == WII_FILTER_SCANLINES) {
+                    o[i] = oy == scale - 1 ? ref_dark(E) : E;
+                } else if (filter == WII_FILTER_LCD_GRID) {
+                    o[i] = ox == scale - 1 || oy == scale - 1 ? ref_dark(E)
+                                                              : E;
+                }
+            }
+            if (filter == WII_FILTER_SCALENX && B != H && D != F) {
+                if (scale == 2) {
+                    o[0] = D == B ? D : E;
+                    o[1] = B == F ? F : E;
+                    o[2] = D == H ? D : E;
+                    o[3] = H == F ? F : E;
+                } else {
+                    o[0] = D == B ? D : E;
+                    o[1] = (D == B && E != C) || (B == F && E != A) ? B : E;
+                    o[2] = B == F ? F : E;
+                    o[3] = (D == B && E != G) || (D == H && E != A) ? D : E;
+                    o[5] = (B == F && E != I) || (H == F && E != C) ? F : E;
+                    o[6] = D == H ? D : E;
+                    o[7] = (D == H && E != I) || (H == F && E != G) ? H : E;
+                    o[8] = H == F ? F : E;
+                }
+            }
+            for (int i = 0; i < scale * scale; i++) {
+                d[(y * scale + i / scale) * dw + x * scale + i % scale] = o[i];
+            }
+        }
+    }
+}
+
+template <typename Pixel>
+static void test_filter(int filter, int scale) {
+    int mismatches = 0, splitMismatches = 0;
+    for (int it = 0; it < 50; it++) {
+        int w = 1 + rand() % 40, h = 1 + rand() % 30;
+        int dw = w * scale, dh = h * scale;
+        Pixel* src = (Pixel*)malloc(w * h * sizeof(Pixel));
+        // Few colors, so neighbours match often
+        for (int i = 0; i < w * h; i++) {
+            src[i] = (Pixel)((rand() % 3) * 0x01234567u);
+        }
+        Pixel* expected = (Pixel*)calloc(dw * dh, sizeof(Pixel));
+        Pixel* actual = (Pixel*)calloc(dw * dh, sizeof(Pixel));
+        Pixel* split = (Pixel*)calloc(dw * dh, sizeof(Pixel));
+
+        ref_filter<Pixel>(filter, src, w, h, expected, scale);
+        wii_filter_apply(filter, sizeof(Pixel), BLACK, src, w * sizeof(Pixel),
+                         actual, dw * sizeof(Pixel), w, h, scale, 0, h);
+        if (memcmp(expected, actual, dw * dh * sizeof(Pixel))) {
+            mismatches++;
+        }
+
+        int mid = h / 2;
+        wii_filter_apply(filter, sizeof(Pixel), BLACK, src, w * sizeof(Pixel),
+                         split, dw * sizeof(Pixel), w, h, scale, mid, h);
+        wii_filter_apply(filter, sizeof(Pixel), BLACK, src, w * sizeof(Pixel),
+                         split, dw * sizeof(Pixel), w, h, scale, 0, mid);
+        if (memcmp(expected, split, dw * dh * sizeof(Pixel))) {
+            splitMismatches++;
+        }
+
+        free(src);
+        free(expected);
+        free(actual);
+        free(split);
+    }
+    CHECK(!mismatches, "filter %d %dbpp x%d: %d images differ", filter,
+          (int)sizeof(Pixel) * 8, scale, mismatches);
+    CHECK(!splitMismatches, "filter %d %dbpp x%d: %d split images differ",
+          filter, (int)sizeof(Pixel) * 8, scale, splitMismatches);
+}
+
+int main() {
+    srand(1);
+
+    for (int scale = 2; scale <= 4; scale++) {
+        for (int filter = WII_FILTER_SCALENX; filter < WII_FILTER_COUNT;
+             filter++) {
+            BOOL supported = wii_filter_supported(filter, 2, scale);
+            CHECK(supported == (filter != WII_FILTER_SCALENX || scale < 4),
+                  "filter %d x%d supported", filter, scale);
+            if (!supported) {
+                continue;
+            }
+            test_filter<u8>(filter, scale);
+            test_filter<u16>(filter, scale);
+            test_filter<u32>(filter, scale);
+        }
+    }
+    CHECK(!wii_filter_supported(WII_FILTER_NONE, 2, 2), "no filter");
+    CHECK(wii_filter_apply(WII_FILTER_SCALENX, 3, 0, NULL, 0, NULL, 0, 1, 1,
+                           2, 0, 1) == -1,
+          "24bpp is not supported");
+
+    printf("filter_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,273 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Tests that text is measured with every glyph rasterized, whatever the
+// per-frame budget for glyphs missing while drawing, and that the font can
+// be initialized again (while the pre-warm worker runs, and without leaking
+// the glyphs into the memory budget). Drawing cached text must not allocate.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#include <gccore.h>
+
+#include "FreeTypeGX.h"
+
+extern "C" void* __libc_malloc(size_t size);
+
+/** Whether the heap allocations are counted */
+static bool count_allocs = false;
+/** The count of heap allocations */
+static int allocs = 0;
+
+void* malloc(size_t size) {
+    if (count_allocs) {
+        allocs++;
+    }
+    return __libc_malloc(size);
+}
+
+void* operator new(size_t size) {
+    if (count_allocs) {
+        allocs++;
+    }
+    void* p = __libc_malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+#define FONT_FILE "../res/fonts/font.ttf"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/**
+ * Measures the text with a cold glyph cache
+ *
+ * @param   font The font buffer
+ * @param   size The size of the font buffer
+ * @param   budget The glyph miss budget (-1 for unlimited)
+ * @param   pixelSize The pixel size of the text
+ * @param   text The text to measure
+ * @return  The width of the text
+ */
+static uint16_t cold_width(uint8_t* font, long size, int budget,
+                           FT_UInt pixelSize, const char* text) {
+    InitFreeType(font, size);
+    FT_SetGlyphMissBudget(budget);
+    uint16_t width = FT_GetWidth(pixelSize, (char*)text);
+    FT_SetGlyphMissBudget(-1);
+    ClearFontData();
+    return width;
+}
+
+/**
+ * Initializes the font again while the pre-warm worker rasterizes glyphs
+ * with the face of the previous initialization
+ *
+ * @param   font The font buffer
+ * @param   size The size of the font buffer
+ */
+static void test_reinit_prewarm(uint8_t* font, long size) {
+    InitFreeType(font, size);
+    uint16_t full = FT_GetWidth(18, (char*)"Prewarm");
+    ClearFontData();
+
+    static const FT_UInt sizes[] = {12, 14, 18, 24, 32};
+    for (int i = 0; i < 4; i++) {
+        InitFreeType(font, size);
+        char text[96];
+        for (int c = 0; c < 94; c++) {
+            text[c] = 33 + c;
+        }
+        text[94] = '\0';
+        FT_PrewarmText(text);
+        FT_StartPrewarm(sizes, sizeof(sizes) / sizeof(sizes[0]));
+        InitFreeType(font, size);
+        uint16_t width = FT_GetWidth(18, (char*)"Prewarm");
+        CHECK(width == full, "width after re-init %u, expected %u", width,
+              full);
+        ClearFontData();
+    }
+}
+
+/**
+ * Initializes the font again without clearing the font data first, the
+ * glyphs of the previous initialization must not count against the budget
+ *
+ * @param   font The font buffer
+ * @param   size The size of the font buffer
+ */
+static void test_reinit_budget(uint8_t* font, long size) {
+    static const char* text = "The quick brown fox jumps over the lazy dog";
+    ftgxCacheStats stats;
+
+    InitFreeType(font, size);
+    FT_GetWidth(24, (char*)text);
+    FT_GetFontCacheStats(&stats);
+    uint32_t used = stats.totalBytes;
+    CHECK(used > 0, "no glyphs cached");
+
+    // A budget just over the glyphs of the text, then a cold cache again
+    FT_SetGlyphBudget(used + used / 2);
+    InitFreeType(font, size);
+    FT_GetFontCacheStats(&stats);
+    CHECK(stats.totalBytes == 0 && stats.glyphCount == 0,
+          "%u bytes, %u glyphs after re-init", stats.totalBytes,
+          stats.glyphCount);
+
+    uint32_t evicted = stats.evictedCount;
+    FT_GetWidth(24, (char*)text);
+    FT_GetFontCacheStats(&stats);
+    CHECK(stats.totalBytes == used, "%u bytes after re-init, expected %u",
+          stats.totalBytes, used);
+    CHECK(stats.evictedCount == evicted, "%u glyphs evicted after re-init",
+          stats.evictedCount - evicted);
+
+    FT_SetGlyphBudget(FTGX_DEFAULT_GLYPH_BUDGET);
+    ClearFontData();
+}
+
+/**
+ * Draws and measures text with the glyphs cached, which must not allocate
+ * (whatever the length of the text)
+ *
+ * @param   font The font buffer
+ * @param   size The size of the font buffer
+ */
+static void test_text_allocs(uint8_t* font, long size) {
+    static char shortText[] = "Frame 0123456789 \xc3\xa9\xc3\xa8";
+    static char longText[1024];
+    for (int i = 0; i < (int)sizeof(longText) - 1; i++) {
+        longText[i] = 'a' + i % 26;
+    }
+    longText[sizeof(longText) - 1] = '\0';
+
+    InitFreeType(font, size);
+    // The glyphs are cached and the text buffer grown once
+    FT_DrawText(0, 0, 14, shortText, ftgxWhite, FTGX_JUSTIFY_LEFT);
+    FT_DrawText(0, 0, 14, longText, ftgxWhite, FTGX_JUSTIFY_LEFT);
+
+    allocs = 0;
+    count_allocs = true;
+    for (int frame = 0; frame < 100; frame++) {
+        FT_DrawText(0, 0, 14, shortText, ftgxWhite, FTGX_JUSTIFY_LEFT);
+        FT_DrawText(0, 0, 14, longText, ftgxWhite, FTGX_JUSTIFY_LEFT);
+        FT_GetWidth(14, shortText);
+        FT_GetWidth(14, longText);
+    }
+    count_allocs = false;
+    CHECK(allocs == 0, "%d allocations in 100 frames", allocs);
+
+    ClearFontData();
+}
+
+int main() {
+    // The font data is locked before the font is initialized
+    ftgxCacheStats stats;
+    FT_GetFontCacheStats(&stats);
+    CHECK(stats.totalBytes == 0, "%u bytes before init", stats.totalBytes);
+
+    FILE* fp = fopen(FONT_FILE, "rb");
+    if (!fp) {
+        printf("unable to open %s\n", FONT_FILE);
+        return 1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t* font = (uint8_t*)malloc(size);
+    if (fread(font, 1, size, fp) != (size_t)size) {
+        printf("unable to read %s\n", FONT_FILE);
+        fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+
+    host_set_retrace_count(1);
+
+    static const char* texts[] = {
+        "A", "Hello, world", "The quick brown fox jumps over the lazy dog",
+        "0123456789 !?#%&"};
+    static const FT_UInt sizes[] = {12, 14, 18, 24};
+
+    for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            uint16_t full = cold_width(font, size, -1, sizes[s], texts[t]);
+            CHECK(full > 0, "'%s' %u: zero width", texts[t], sizes[s]);
+            for (int budget = 0; budget <= 2; budget++) {
+                uint16_t width =
+                    cold_width(font, size, budget, sizes[s], texts[t]);
+                CHECK(width == full, "'%s' %u budget %d: %u, expected %u",
+                      texts[t], sizes[s], budget, width, full);
+            }
+        }
+    }
+
+    test_reinit_prewarm(font, size);
+    test_reinit_budget(font, size);
+    test_text_allocs(font, size);
+
+    free(font);
+
+    printf("ftgx_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
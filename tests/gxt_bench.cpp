@@ -0,0 +1,185 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+//
+// Measures the load time of an image decoded from its PNG file (as on the
+// first load) against reading the texels from its pre-swizzled cache file
+// (as wii_gx_loadimage* does on later loads). The files are read from the
+// host's page cache, so the times only compare the decode with the copy.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <gccore.h>
+#include <png.h>
+
+#include "pngu.h"
+#include "wii_gx_image.h"
+
+#define LOADS 50
+#define IMAGE_FILE "build/gxt_bench.png"
+#define CACHE_DIR "build"
+
+/** An image to load, and how */
+typedef struct bench_image {
+    int width;
+    int height;
+    int colorType;
+    int maxdim;
+    bool compact;
+} bench_image;
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Writes a PNG of gradients with some noise, so it compresses about as well
+ * as the artwork loaded by the applications
+ */
+static bool write_png(const char* path, int width, int height, int colorType) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+    png_structp png =
+        png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png_create_info_struct(png);
+    png_init_io(png, fp);
+    png_set_IHDR(png, info, width, height, 8, colorType, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+
+    int channels = png_get_channels(png, info);
+    png_bytep row = (png_bytep)malloc(width * channels);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < channels; c++) {
+                row[x * channels + c] =
+                    (x * (c + 1) + y * (3 - c) + (rand() & 7)) & 0xff;
+            }
+        }
+        png_write_row(png, row);
+    }
+    png_write_end(png, info);
+    png_destroy_write_struct(&png, &info);
+    free(row);
+    fclose(fp);
+    return true;
+}
+
+int main() {
+    static const bench_image images[] = {
+        {640, 480, PNG_COLOR_TYPE_RGB_ALPHA, 0, false},
+        {640, 480, PNG_COLOR_TYPE_RGB, 0, true},
+        {1024, 768, PNG_COLOR_TYPE_RGB_ALPHA, 256, false}};
+    u32 sum = 0;
+
+    printf("image                                  png ms   gxt ms  speedup\n");
+    for (size_t i = 0; i < sizeof(images) / sizeof(images[0]); i++) {
+        const bench_image* image = &images[i];
+        struct stat st;
+        if (!write_png(IMAGE_FILE, image->width, image->height,
+                       image->colorType) ||
+            stat(IMAGE_FILE, &st)) {
+            fprintf(stderr, "unable to write %s\n", IMAGE_FILE);
+            return 1;
+        }
+
+        char cachepath[256];
+        wii_gx_image_cachepath(CACHE_DIR, IMAGE_FILE, image->maxdim,
+                               image->compact, cachepath, sizeof(cachepath));
+
+        int width, height;
+        u8 format;
+        u8* decoded = NULL;
+        double start = now();
+        for (int n = 0; n < LOADS; n++) {
+            free(decoded);
+            IMGCTX ctx = PNGU_SelectImageFromDevice(IMAGE_FILE);
+            decoded = wii_gx_image_decode(ctx, image->maxdim, image->compact,
+                                          &width, &height, &format);
+            PNGU_ReleaseImageContext(ctx);
+        }
+        double pngTime = (now() - start) / LOADS;
+        if (!decoded ||
+            !wii_gx_image_savecache(cachepath, IMAGE_FILE, st.st_size,
+                                    st.st_mtime, image->maxdim, decoded,
+                                    width, height, format)) {
+            fprintf(stderr, "unable to write %s\n", cachepath);
+            return 1;
+        }
+
+        int cachedWidth = 0, cachedHeight = 0;
+        u8 cachedFormat = 0;
+        u8* cached = NULL;
+        start = now();
+        for (int n = 0; n < LOADS; n++) {
+            free(cached);
+            cached = wii_gx_image_loadcache(
+                cachepath, IMAGE_FILE, st.st_size, st.st_mtime, image->maxdim,
+                image->compact, &cachedWidth, &cachedHeight, &cachedFormat);
+        }
+        double gxtTime = (now() - start) / LOADS;
+
+        int len = wii_gx_image_size(format, width, height);
+        if (!cached || cachedWidth != width || cachedHeight != height ||
+            cachedFormat != format || memcmp(decoded, cached, len)) {
+            fprintf(stderr, "cached texture differs from the decoded one\n");
+            return 1;
+        }
+        for (int j = 0; j < len; j++) {
+            sum += cached[j];
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%dx%d %s -> %dx%d%s", image->width,
+                 image->height,
+                 image->colorType == PNG_COLOR_TYPE_RGB ? "RGB" : "RGBA",
+                 width, height, image->compact ? " compact" : "");
+        printf("%-36s %8.3f %8.3f %7.1fx\n", name, pngTime * 1e3,
+               gxtTime * 1e3, pngTime / gxtTime);
+
+        free(decoded);
+        free(cached);
+        remove(cachepath);
+    }
+    remove(IMAGE_FILE);
+    PNGU_ReleaseBandBuffers();
+
+    printf("[%08x]\n", sum);
+    return 0;
+}
@@ -0,0 +1,176 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+//
+// Host (Linux) stand-in for the parts of libogc used by the modules built for
+// the tests and tools (texture formats, cache, thread and GX functions). The
+// functions are implemented by ogc_host.cpp, the GX functions do nothing.
+//
+
+#ifndef HOST_GCCORE_H
+#define HOST_GCCORE_H
+
+#include <gctypes.h>
+#include <malloc.h>
+#include <stdlib.h>
+
+#define GX_TF_I4 0x0
+#define GX_TF_I8 0x1
+#define GX_TF_IA4 0x2
+#define GX_TF_IA8 0x3
+#define GX_TF_RGB565 0x4
+#define GX_TF_RGB5A3 0x5
+#define GX_TF_RGBA8 0x6
+#define GX_TF_CMPR 0xE
+
+#define ATTRIBUTE_ALIGN(v) __attribute__((aligned(v)))
+
+#define GX_FALSE 0
+#define GX_TRUE 1
+#define GX_NONE 0
+#define GX_DIRECT 1
+#define GX_INDEX8 2
+#define GX_INDEX16 3
+#define GX_VA_POS 9
+#define GX_VA_CLR0 11
+#define GX_VA_TEX0 13
+#define GX_POS_XY 0
+#define GX_TEX_ST 1
+#define GX_CLR_RGBA 1
+#define GX_S16 3
+#define GX_F32 4
+#define GX_RGBA8 5
+#define GX_QUADS 0x80
+#define GX_VTXFMT0 0
+#define GX_VTXFMT1 1
+#define GX_TEVSTAGE0 0
+#define GX_TEXMAP0 0
+#define GX_MODULATE 0
+#define GX_DECAL 1
+#define GX_BLEND 2
+#define GX_REPLACE 3
+#define GX_PASSCLR 4
+#define GX_CLAMP 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _gx_color {
+    u8 r, g, b, a;
+} GXColor;
+
+typedef struct _gx_texobj {
+    u32 val[8];
+} GXTexObj;
+
+typedef u32 lwp_t;
+typedef u32 mutex_t;
+typedef u32 cond_t;
+
+#define LWP_THREAD_NULL 0xffffffff
+#define LWP_MUTEX_NULL 0xffffffff
+#define LWP_COND_NULL 0xffffffff
+
+#define VI_NTSC 0
+#define VI_PAL 1
+#define VI_MPAL 2
+#define VI_DEBUG 3
+#define VI_DEBUG_PAL 4
+#define VI_EURGB60 5
+
+typedef void (*VIRetraceCallback)(u32 retraceCnt);
+
+/**
+ * Interrupts can't be disabled on the host, the sections they guard are
+ * serialized by a global (recursive) lock instead
+ */
+#define _CPU_ISR_Disable(level) ((level) = host_isr_disable())
+#define _CPU_ISR_Restore(level) host_isr_restore(level)
+
+u32 host_isr_disable(void);
+void host_isr_restore(u32 level);
+
+/** Whether the calling thread has "disabled interrupts" (host only) */
+BOOL host_isr_disabled(void);
+
+/**
+ * Sets a handler called once, the next time interrupts are enabled again (as
+ * a pending interrupt is served), with interrupts disabled (host only)
+ */
+void host_set_pending_interrupt(void (*handler)(void));
+
+void DCFlushRange(void* startaddress, u32 len);
+void DCInvalidateRange(void* startaddress, u32 len);
+u32 VIDEO_GetRetraceCount(void);
+
+VIRetraceCallback VIDEO_SetPostRetraceCallback(VIRetraceCallback callback);
+void udelay(int us);
+
+/** Sets the retrace count returned by VIDEO_GetRetraceCount (host only) */
+void host_set_retrace_count(u32 count);
+
+/**
+ * Counts a retrace and calls the post-retrace callback with interrupts
+ * disabled, as the VI interrupt does (host only)
+ */
+void host_post_retrace(void);
+
+s32 LWP_CreateThread(lwp_t* thethread, void* (*entry)(void*), void* arg,
+                     void* stackbase, u32 stack_size, u8 prio);
+s32 LWP_JoinThread(lwp_t thethread, void** value_ptr);
+void LWP_YieldThread(void);
+s32 LWP_MutexInit(mutex_t* mutex, bool use_recursive);
+s32 LWP_MutexLock(mutex_t mutex);
+s32 LWP_MutexUnlock(mutex_t mutex);
+s32 LWP_MutexDestroy(mutex_t mutex);
+s32 LWP_CondInit(cond_t* cond);
+s32 LWP_CondWait(cond_t cond, mutex_t mutex);
+s32 LWP_CondSignal(cond_t cond);
+s32 LWP_CondBroadcast(cond_t cond);
+s32 LWP_CondDestroy(cond_t cond);
+lwp_t LWP_GetSelf(void);
+
+void GX_InitTexObj(GXTexObj* obj, void* img_ptr, u16 wd, u16 ht, u8 fmt,
+                   u8 wrap_s, u8 wrap_t, u8 mipmap);
+void GX_LoadTexObj(GXTexObj* obj, u8 mapid);
+void GX_InvalidateTexAll(void);
+void GX_SetTevOp(u8 tevstage, u8 mode);
+void GX_SetVtxDesc(u8 attr, u8 type);
+void GX_SetVtxAttrFmt(u8 vtxfmt, u32 vtxattr, u32 comptype, u32 compsize,
+                      u32 frac);
+void GX_Begin(u8 primitve, u8 vtxfmt, u16 vtxcnt);
+void GX_End(void);
+void GX_Position2s16(s16 x, s16 y);
+void GX_Color4u8(u8 r, u8 g, u8 b, u8 a);
+void GX_TexCoord2f32(f32 s, f32 t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
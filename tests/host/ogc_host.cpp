@@ -0,0 +1,216 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+//
+// Host (Linux) implementation of the libogc stand-in functions. Threads,
+// mutexes and condition variables map onto pthreads, the cache and GX
+// functions do nothing and the retrace count only changes when a test sets it
+// or calls host_post_retrace.
+//
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <gccore.h>
+
+#define HOST_MAX_HANDLES 16
+
+static pthread_t host_threads[HOST_MAX_HANDLES];
+static pthread_mutex_t host_mutexes[HOST_MAX_HANDLES];
+static pthread_cond_t host_conds[HOST_MAX_HANDLES];
+static u32 host_thread_count = 0;
+static u32 host_mutex_count = 0;
+static u32 host_cond_count = 0;
+static pthread_mutex_t host_isr_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread u32 host_isr_depth = 0;
+static void (*host_pending_interrupt)(void) = NULL;
+static u32 host_retrace = 0;
+static VIRetraceCallback host_post_callback = NULL;
+
+void DCFlushRange(void* startaddress, u32 len) {}
+
+void DCInvalidateRange(void* startaddress, u32 len) {}
+
+u32 VIDEO_GetRetraceCount(void) {
+    return __atomic_load_n(&host_retrace, __ATOMIC_RELAXED);
+}
+
+void host_set_retrace_count(u32 count) {
+    __atomic_store_n(&host_retrace, count, __ATOMIC_RELAXED);
+}
+
+VIRetraceCallback VIDEO_SetPostRetraceCallback(VIRetraceCallback callback) {
+    u32 level;
+    _CPU_ISR_Disable(level);
+    VIRetraceCallback prev = host_post_callback;
+    host_post_callback = callback;
+    _CPU_ISR_Restore(level);
+    return prev;
+}
+
+void host_post_retrace(void) {
+    u32 level;
+    _CPU_ISR_Disable(level);
+    u32 count = __atomic_add_fetch(&host_retrace, 1, __ATOMIC_RELAXED);
+    if (host_post_callback) {
+        host_post_callback(count);
+    }
+    _CPU_ISR_Restore(level);
+}
+
+void udelay(int us) {}
+
+s32 LWP_CreateThread(lwp_t* thethread, void* (*entry)(void*), void* arg,
+                     void* stackbase, u32 stack_size, u8 prio) {
+    if (host_thread_count == HOST_MAX_HANDLES ||
+        pthread_create(&host_threads[host_thread_count], NULL, entry, arg)) {
+        return -1;
+    }
+    *thethread = host_thread_count++;
+    return 0;
+}
+
+s32 LWP_JoinThread(lwp_t thethread, void** value_ptr) {
+    return pthread_join(host_threads[thethread], value_ptr);
+}
+
+void LWP_YieldThread(void) {
+    sched_yield();
+}
+
+s32 LWP_MutexInit(mutex_t* mutex, bool use_recursive) {
+    if (host_mutex_count == HOST_MAX_HANDLES) {
+        return -1;
+    }
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if (use_recursive) {
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    }
+    pthread_mutex_init(&host_mutexes[host_mutex_count], &attr);
+    pthread_mutexattr_destroy(&attr);
+    *mutex = host_mutex_count++;
+    return 0;
+}
+
+s32 LWP_MutexLock(mutex_t mutex) {
+    return pthread_mutex_lock(&host_mutexes[mutex]);
+}
+
+s32 LWP_MutexUnlock(mutex_t mutex) {
+    return pthread_mutex_unlock(&host_mutexes[mutex]);
+}
+
+s32 LWP_MutexDestroy(mutex_t mutex) {
+    return pthread_mutex_destroy(&host_mutexes[mutex]);
+}
+
+s32 LWP_CondInit(cond_t* cond) {
+    if (host_cond_count == HOST_MAX_HANDLES) {
+        return -1;
+    }
+    pthread_cond_init(&host_conds[host_cond_count], NULL);
+    *cond = host_cond_count++;
+    return 0;
+}
+
+s32 LWP_CondWait(cond_t cond, mutex_t mutex) {
+    return pthread_cond_wait(&host_conds[cond], &host_mutexes[mutex]);
+}
+
+s32 LWP_CondSignal(cond_t cond) {
+    return pthread_cond_signal(&host_conds[cond]);
+}
+
+s32 LWP_CondBroadcast(cond_t cond) {
+    return pthread_cond_broadcast(&host_conds[cond]);
+}
+
+s32 LWP_CondDestroy(cond_t cond) {
+    return pthread_cond_destroy(&host_conds[cond]);
+}
+
+lwp_t LWP_GetSelf(void) {
+    pthread_t self = pthread_self();
+    for (u32 i = 0; i < host_thread_count; i++) {
+        if (pthread_equal(host_threads[i], self)) {
+            return i;
+        }
+    }
+    // Threads not created by LWP_CreateThread (the main thread)
+    return HOST_MAX_HANDLES;
+}
+
+u32 host_isr_disable(void) {
+    pthread_mutex_lock(&host_isr_mutex);
+    host_isr_depth++;
+    return 0;
+}
+
+void host_isr_restore(u32 level) {
+    if (host_isr_depth == 1 && host_pending_interrupt) {
+        void (*handler)(void) = host_pending_interrupt;
+        host_pending_interrupt = NULL;
+        handler();
+    }
+    host_isr_depth--;
+    pthread_mutex_unlock(&host_isr_mutex);
+}
+
+BOOL host_isr_disabled(void) {
+    return host_isr_depth != 0;
+}
+
+void host_set_pending_interrupt(void (*handler)(void)) {
+    pthread_mutex_lock(&host_isr_mutex);
+    host_pending_interrupt = handler;
+    pthread_mutex_unlock(&host_isr_mutex);
+}
+
+void GX_InitTexObj(GXTexObj* obj, void* img_ptr, u16 wd, u16 ht, u8 fmt,
+                   u8 wrap_s, u8 wrap_t, u8 mipmap) {}
+
+void GX_LoadTexObj(GXTexObj* obj, u8 mapid) {}
+
+void GX_InvalidateTexAll(void) {}
+
+void GX_SetTevOp(u8 tevstage, u8 mode) {}
+
+void GX_SetVtxDesc(u8 attr, u8 type) {}
+
+void GX_SetVtxAttrFmt(u8 vtxfmt, u32 vtxattr, u32 comptype, u32 compsize,
+                      u32 frac) {}
+
+void GX_Begin(u8 primitve, u8 vtxfmt, u16 vtxcnt) {}
+
+void GX_End(void) {}
+
+void GX_Position2s16(s16 x, s16 y) {}
+
+void GX_Color4u8(u8 r, u8 g, u8 b, u8 a) {}
+
+void GX_TexCoord2f32(f32 s, f32 t) {}
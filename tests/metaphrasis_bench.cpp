@@ -0,0 +1,148 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Measures the glyphs per second converted from 8-bit intensity bitmaps into
+// I4, I8, IA4 and IA8 textures: the one-pass convertIntensityTo* converters
+// against the previous path of expanding the bitmap to RGBA32 and converting
+// it with convertBufferTo* (as FreeTypeGX::loadGlyphData did)
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gccore.h>
+
+#include "Metaphrasis.h"
+
+#define GLYPHS 50000
+
+/** The size of a glyph bitmap and of its texture (multiples of 8) */
+typedef struct glyph_size {
+    int width;
+    int height;
+    int textureWidth;
+    int textureHeight;
+} glyph_size;
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/** Converts an RGBA32 buffer into a new texture */
+typedef uint32_t* (*buffer_converter)(uint32_t* rgbaBuffer, uint16_t width,
+                                      uint16_t height);
+
+/** Converts an intensity bitmap into a texture */
+typedef void (*intensity_converter)(const uint8_t* intensityBuffer,
+                                    uint16_t imageWidth, uint16_t imageHeight,
+                                    int32_t imagePitch, void* textureBuffer,
+                                    uint16_t bufferWidth,
+                                    uint16_t bufferHeight);
+
+/**
+ * Converts the bitmap the previous way, through a temporary RGBA32 buffer
+ */
+static uint32_t* convert_rgba(buffer_converter convert, const uint8_t* bitmap,
+                              const glyph_size* g) {
+    int size = g->textureWidth * g->textureHeight * 4;
+    uint32_t* rgba = (uint32_t*)memalign(32, size);
+    memset(rgba, 0, size);
+    for (int y = 0; y < g->height; y++) {
+        for (int x = 0; x < g->width; x++) {
+            uint32_t pixel = bitmap[y * g->width + x];
+            rgba[y * g->textureWidth + x] =
+                (pixel << 24) | (pixel << 16) | (pixel << 8) | pixel;
+        }
+    }
+    uint32_t* texture = convert(rgba, g->textureWidth, g->textureHeight);
+    free(rgba);
+    return texture;
+}
+
+int main() {
+    static const char* names[] = {"I4", "I8", "IA4", "IA8"};
+    static const int bits[] = {4, 8, 8, 16};
+    static const buffer_converter buffers[] = {
+        Metaphrasis::convertBufferToI4, Metaphrasis::convertBufferToI8,
+        Metaphrasis::convertBufferToIA4, Metaphrasis::convertBufferToIA8};
+    static const intensity_converter intensities[] = {
+        Metaphrasis::convertIntensityToI4, Metaphrasis::convertIntensityToI8,
+        Metaphrasis::convertIntensityToIA4,
+        Metaphrasis::convertIntensityToIA8};
+
+    // The glyphs of the 18 pixel menu font and of a large title font
+    static const glyph_size sizes[] = {{13, 18, 16, 24}, {42, 46, 48, 48}};
+    u32 sum = 0;
+
+    for (int g = 0; g < 2; g++) {
+        const glyph_size* glyph = &sizes[g];
+        uint8_t* bitmap = (uint8_t*)malloc(glyph->width * glyph->height);
+        for (int i = 0; i < glyph->width * glyph->height; i++) {
+            bitmap[i] = (i % 5) ? rand() : 0;
+        }
+
+        printf("%dx%d glyphs/s   rgba32    one pass\n", glyph->width,
+               glyph->height);
+        for (int f = 0; f < 4; f++) {
+            int size = glyph->textureWidth * glyph->textureHeight * bits[f] / 8;
+
+            double start = now();
+            for (int n = 0; n < GLYPHS; n++) {
+                uint8_t* texture =
+                    (uint8_t*)convert_rgba(buffers[f], bitmap, glyph);
+                sum += texture[n % size];
+                free(texture);
+            }
+            double rgba = now() - start;
+
+            start = now();
+            for (int n = 0; n < GLYPHS; n++) {
+                uint8_t* texture = (uint8_t*)memalign(32, size);
+                intensities[f](bitmap, glyph->width, glyph->height,
+                               glyph->width, texture, glyph->textureWidth,
+                               glyph->textureHeight);
+                sum += texture[n % size];
+                free(texture);
+            }
+            double pass = now() - start;
+
+            printf("%-13s %9.0f %11.0f (%.1fx)\n", names[f], GLYPHS / rgba,
+                   GLYPHS / pass, rgba / pass);
+        }
+        free(bitmap);
+    }
+    printf("[%08x]\n", sum);
+
+    return 0;
+}
@@ -0,0 +1,557 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Tests the tiled PNG decode. Images are written with libpng both plain and
+// interlaced: plain images are decoded a band of rows at a time (streamed),
+// interlaced ones in full before they are swizzled, and both have to match
+// the swizzle of the pixels the images were written from. Small gray, gray
+// and alpha and indexed images pin the texture format chosen for them and
+// the layout of their texels.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gccore.h>
+#include <png.h>
+
+#include "pngu.h"
+#include "wii_swizzle.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/**
+ * A PNG image written to memory
+ */
+struct PngImage {
+    u8* data;
+    size_t size;
+};
+
+static void png_write_to_image(png_structp png, png_bytep data,
+                               png_size_t length) {
+    PngImage* image = (PngImage*)png_get_io_ptr(png);
+    image->data = (u8*)realloc(image->data, image->size + length);
+    memcpy(image->data + image->size, data, length);
+    image->size += length;
+}
+
+static void png_flush_image(png_structp png) {}
+
+/**
+ * Writes an image to memory
+ *
+ * @param   pixels The rows of pixels (of the color type's channel count,
+ *          rows of less than 8 bits per pixel are packed)
+ * @param   width The width of the image
+ * @param   height The height of the image
+ * @param   colorType The PNG color type
+ * @param   interlaced Whether to write the image Adam7 interlaced
+ * @param   palette The palette of indexed images (or NULL)
+ * @param   paletteSize The count of palette entries
+ * @param   trans The alpha of the first palette entries (or NULL)
+ * @param   transSize The count of alpha values
+ * @param   bitDepth The bits per sample
+ * @return  The PNG image (its data is to be freed by the caller)
+ */
+static PngImage write_png(const u8* pixels, int width, int height,
+                          int colorType, bool interlaced,
+                          const png_color* palette = NULL,
+                          int paletteSize = 0, const u8* trans = NULL,
+                          int transSize = 0, int bitDepth = 8) {
+    PngImage image = {NULL, 0};
+    png_structp png =
+        png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png_create_info_struct(png);
+    png_set_write_fn(png, &image, png_write_to_image, png_flush_image);
+    png_set_IHDR(png, info, width, height, bitDepth, colorType,
+                 interlaced ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    if (palette) {
+        png_set_PLTE(png, info, palette, paletteSize);
+    }
+    if (trans) {
+        png_set_tRNS(png, info, trans, transSize, NULL);
+    }
+
+    int pitch = (width * png_get_channels(png, info) * bitDepth + 7) / 8;
+    png_bytep* rows = (png_bytep*)malloc(height * sizeof(png_bytep));
+    for (int y = 0; y < height; y++) {
+        rows[y] = (png_bytep)pixels + y * pitch;
+    }
+    png_set_rows(png, info, rows);
+    png_write_png(png, info, PNG_TRANSFORM_IDENTITY, NULL);
+    png_destroy_write_struct(&png, &info);
+    free(rows);
+    return image;
+}
+
+/**
+ * Returns the size of a texture of the specified format
+ */
+static size_t texture_size(u8 format, int width, int height) {
+    switch (format) {
+        case GX_TF_I8:
+            return width * height;
+        case GX_TF_RGBA8:
+            return width * height * 4;
+        default:
+            return width * height * 2;
+    }
+}
+
+/**
+ * Decodes an image into a texture, scaled if the destination size differs
+ * from the image size
+ *
+ * @return  The texture (to be freed by the caller), NULL if the decode failed
+ */
+static u8* decode_png(const PngImage& image, int width, int height,
+                      int dstWidth, int dstHeight, u8 format, u8 alpha) {
+    size_t size = texture_size(format, dstWidth, dstHeight);
+    u8* texture = (u8*)malloc(size);
+    memset(texture, 0x5a, size);
+
+    IMGCTX ctx = PNGU_SelectImageFromBuffer(image.data);
+    int ret = dstWidth == width && dstHeight == height
+                  ? PNGU_DecodeTo4x4(ctx, width, height, texture, format,
+                                     alpha)
+                  : PNGU_DecodeTo4x4Scaled(ctx, width, height, texture,
+                                           dstWidth, dstHeight, format, alpha);
+    PNGU_ReleaseImageContext(ctx);
+    if (ret != PNGU_OK) {
+        free(texture);
+        return NULL;
+    }
+    return texture;
+}
+
+/**
+ * Swizzles RGBA pixels into a texture, box filtering them down to the
+ * destination size the same way as the scaled decode
+ *
+ * @return  The texture (to be freed by the caller)
+ */
+static u8* ref_texture(const u8* rgba, int width, int height, int dstWidth,
+                       int dstHeight, u8 format) {
+    u8* scaled = (u8*)malloc(dstWidth * dstHeight * 4);
+    for (int y = 0, sy = 0; y < dstHeight; y++) {
+        int yend = (y + 1) * height / dstHeight;
+        for (int x = 0; x < dstWidth; x++) {
+            int x0 = x * width / dstWidth, x1 = (x + 1) * width / dstWidth;
+            int n = (yend - sy) * (x1 - x0);
+            for (int c = 0; c < 4; c++) {
+                int sum = 0;
+                for (int j = sy; j < yend; j++) {
+                    for (int i = x0; i < x1; i++) {
+                        sum += rgba[(j * width + i) * 4 + c];
+                    }
+                }
+                scaled[(y * dstWidth + x) * 4 + c] = (sum + (n >> 1)) / n;
+            }
+        }
+        sy = yend;
+    }
+
+    const u8** rows = (const u8**)malloc(dstHeight * sizeof(u8*));
+    for (int y = 0; y < dstHeight; y++) {
+        rows[y] = scaled + y * dstWidth * 4;
+    }
+    size_t size = texture_size(format, dstWidth, dstHeight);
+    u8* texture = (u8*)malloc(size);
+    memset(texture, 0x5a, size);
+    wii_swizzle_rows(format, WII_SWIZZLE_SRC_RGBA8, rows, 0, dstWidth,
+                     dstHeight, 0xff, texture, dstWidth, 0, 0);
+    free(rows);
+    free(scaled);
+    return texture;
+}
+
+static const u8 formats[] = {GX_TF_RGBA8, GX_TF_RGB565, GX_TF_RGB5A3};
+
+/**
+ * Decodes RGB and RGBA images streamed and in full (interlaced), plain and
+ * scaled down from odd sizes, and compares the textures with each other and
+ * with the swizzle of the source pixels
+ */
+static void test_decode_4x4() {
+    static const int sizes[][4] = {
+        {4, 4, 4, 4},   {12, 8, 12, 8},   {20, 36, 20, 36}, {36, 4, 36, 4},
+        {100, 12, 100, 12}, {7, 5, 4, 4}, {13, 9, 12, 8},   {13, 9, 4, 4},
+        {33, 17, 32, 16},   {33, 17, 8, 4}, {41, 7, 20, 4}};
+    for (int hasAlpha = 0; hasAlpha < 2; hasAlpha++) {
+        int channels = hasAlpha ? 4 : 3;
+        int colorType = hasAlpha ? PNG_COLOR_TYPE_RGB_ALPHA : PNG_COLOR_TYPE_RGB;
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            int width = sizes[s][0], height = sizes[s][1];
+            int dstWidth = sizes[s][2], dstHeight = sizes[s][3];
+            u8 alpha = rand() & 1 ? 0xff : rand();
+
+            // Pixels of the image and as RGBA with the default alpha, alpha
+            // values cover both the opaque and translucent RGB5A3 texels
+            u8* pixels = (u8*)malloc(width * height * channels);
+            u8* rgba = (u8*)malloc(width * height * 4);
+            for (int i = 0; i < width * height; i++) {
+                for (int c = 0; c < 4; c++) {
+                    u8 v = rand();
+                    if (c == 3 && (rand() & 1)) {
+                        v |= 0xe0;
+                    }
+                    if (c < channels) {
+                        pixels[i * channels + c] = v;
+                    }
+                    rgba[i * 4 + c] = c < channels ? v : alpha;
+                }
+            }
+            PngImage plain =
+                write_png(pixels, width, height, colorType, false);
+            PngImage interlaced =
+                write_png(pixels, width, height, colorType, true);
+
+            for (size_t f = 0; f < sizeof(formats); f++) {
+                size_t size = texture_size(formats[f], dstWidth, dstHeight);
+                u8* streamed = decode_png(plain, width, height, dstWidth,
+                                          dstHeight, formats[f], alpha);
+                u8* full = decode_png(interlaced, width, height, dstWidth,
+                                      dstHeight, formats[f], alpha);
+                u8* expected = ref_texture(rgba, width, height, dstWidth,
+                                           dstHeight, formats[f]);
+                CHECK(streamed && full && !memcmp(streamed, full, size),
+                      "streamed and full decode differ, format %d %s %dx%d "
+                      "to %dx%d",
+                      formats[f], hasAlpha ? "RGBA" : "RGB", width, height,
+                      dstWidth, dstHeight);
+                CHECK(streamed && !memcmp(streamed, expected, size),
+                      "decode differs from the source, format %d %s %dx%d "
+                      "to %dx%d",
+                      formats[f], hasAlpha ? "RGBA" : "RGB", width, height,
+                      dstWidth, dstHeight);
+                free(streamed);
+                free(full);
+                free(expected);
+            }
+
+            free(plain.data);
+            free(interlaced.data);
+            free(pixels);
+            free(rgba);
+        }
+    }
+}
+
+/**
+ * Checks that sizes the texture can't hold without scaling are rejected
+ */
+static void test_decode_4x4_invalid() {
+    static const int sizes[][2] = {{13, 9}, {6, 4}, {4, 6}, {1, 1}};
+    u8 pixels[13 * 9 * 3] = {0};
+    u8 texture[16 * 12 * 4];
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int width = sizes[s][0], height = sizes[s][1];
+        PngImage image =
+            write_png(pixels, width, height, PNG_COLOR_TYPE_RGB, false);
+        IMGCTX ctx = PNGU_SelectImageFromBuffer(image.data);
+        CHECK(PNGU_DecodeTo4x4(ctx, width, height, texture, GX_TF_RGBA8,
+                               0xff) == PNGU_INVALID_WIDTH_OR_HEIGHT,
+              "%dx%d decoded without scaling", width, height);
+        PNGU_ReleaseImageContext(ctx);
+
+        ctx = PNGU_SelectImageFromBuffer(image.data);
+        CHECK(PNGU_DecodeTo4x4Scaled(ctx, width, height, texture, 16, 12,
+                                     GX_TF_RGBA8,
+                                     0xff) == PNGU_INVALID_WIDTH_OR_HEIGHT,
+              "%dx%d scaled up", width, height);
+        PNGU_ReleaseImageContext(ctx);
+        free(image.data);
+    }
+}
+
+/**
+ * An image of a single texture tile (8x4 texels for I8, 4x4 otherwise), so
+ * its texels are stored in the order of its pixels. The expected pixels are
+ * given as RGBA, or looked up in the palette for indexed images.
+ */
+struct Fixture {
+    const char* name;
+    int width;
+    int height;
+    int colorType;
+    int bitDepth;
+    const u8* pixels;            // The pixels as written to the image
+    const png_color* palette;    // The palette of indexed images
+    int paletteSize;
+    const u8* trans;             // The alpha of the palette entries
+    int transSize;
+    u8 format;                   // The expected format (RGB565 allowed)
+    u8 formatRGBA8;              // The expected format (RGB565 not allowed)
+    u8 rgba[32][4];              // The expected pixels (not indexed)
+};
+
+/**
+ * Returns the RGBA value of a fixture pixel
+ */
+static void fixture_pixel(const Fixture& f, int i, u8* p) {
+    if (!f.palette) {
+        memcpy(p, f.rgba[i], 4);
+        return;
+    }
+    int perByte = 8 / f.bitDepth;
+    int shift = 8 - f.bitDepth * (i % perByte + 1);
+    int index = (f.pixels[i / perByte] >> shift) & ((1 << f.bitDepth) - 1);
+    p[0] = f.palette[index].red;
+    p[1] = f.palette[index].green;
+    p[2] = f.palette[index].blue;
+    p[3] = index < f.transSize ? f.trans[index] : 0xff;
+}
+
+/**
+ * Returns the texels of a single tile texture in the specified format. The
+ * layouts are spelled out here: I8 holds the intensity (blue), IA8 the alpha
+ * in its high byte and the intensity in its low byte, RGB565 is big-endian
+ * and RGBA8 holds the AR pairs followed by the GB pairs.
+ */
+static size_t fixture_texels(const Fixture& f, u8 format, u8* texels) {
+    int count = f.width * f.height;
+    for (int i = 0; i < count; i++) {
+        u8 p[4];
+        fixture_pixel(f, i, p);
+        u16 rgb565 = ((p[0] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[2] >> 3);
+        switch (format) {
+            case GX_TF_I8:
+                texels[i] = p[2];
+                break;
+            case GX_TF_IA8:
+                texels[i * 2] = p[3];
+                texels[i * 2 + 1] = p[2];
+                break;
+            case GX_TF_RGB565:
+                texels[i * 2] = rgb565 >> 8;
+                texels[i * 2 + 1] = rgb565;
+                break;
+            case GX_TF_RGBA8:
+                texels[i * 2] = p[3];
+                texels[i * 2 + 1] = p[0];
+                texels[32 + i * 2] = p[1];
+                texels[32 + i * 2 + 1] = p[2];
+                break;
+        }
+    }
+    return texture_size(format, f.width, f.height);
+}
+
+// Gray 8 and 4 bit, gray and alpha
+static const u8 gray8[32] = {0,  1,  2,  3,  4,   5,   6,   7,
+                             8,  16, 32, 64, 128, 200, 254, 255,
+                             9,  19, 29, 39, 49,  59,  69,  79,
+                             90, 91, 92, 93, 94,  95,  96,  97};
+static const u8 gray4[16] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+                             0xf0, 0x0f, 0x5a, 0xa5, 0x11, 0x22, 0x33, 0x44};
+static const u8 grayAlpha[32] = {0x10, 0xff, 0x20, 0x80, 0x30, 0x00, 0x40, 0x7f,
+                                 0x50, 0x01, 0x60, 0xfe, 0x70, 0x3c, 0x80, 0xc3,
+                                 0x90, 0x11, 0xa0, 0x22, 0xb0, 0x33, 0xc0, 0x44,
+                                 0xd0, 0x55, 0xe0, 0x66, 0xf0, 0x77, 0xff, 0x88};
+
+// Palettes of gray and color entries, the alpha of translucent entries and of
+// entries that are all opaque
+static const png_color grayPalette[4] = {
+    {0, 0, 0}, {0x55, 0x55, 0x55}, {0xaa, 0xaa, 0xaa}, {0xff, 0xff, 0xff}};
+static const png_color colorPalette[4] = {
+    {0xff, 0, 0}, {0, 0xff, 0}, {0x12, 0x34, 0x56}, {0xfe, 0xdc, 0xba}};
+static const u8 translucent[4] = {0xff, 0x80, 0x00, 0x40};
+static const u8 opaque[4] = {0xff, 0xff, 0xff, 0xff};
+// Indices, 8 and 2 bit
+static const u8 indices8[32] = {0, 1, 2, 3, 3, 2, 1, 0, 1, 1, 2, 2, 0, 3, 0, 3,
+                                3, 3, 0, 0, 2, 1, 2, 1, 0, 0, 1, 1, 3, 2, 3, 2};
+static const u8 indices2[4] = {0x1b, 0xe4, 0x5a, 0xcc};
+
+// Opaque color
+static const u8 rgb[48] = {0x00, 0x01, 0x02, 0x10, 0x20, 0x30, 0xff, 0x00,
+                           0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0xff, 0x12,
+                           0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x0f,
+                           0xff, 0xff, 0xff, 0x80, 0x80, 0x80, 0x07, 0x03,
+                           0x07, 0x08, 0x04, 0x08, 0xf8, 0xfc, 0xf8, 0x11,
+                           0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99};
+
+#define GRAY(v) {v, v, v, 0xff}
+#define GRAY_ALPHA(v, a) {v, v, v, a}
+
+static const Fixture fixtures[] = {
+    {"gray",
+     8, 4, PNG_COLOR_TYPE_GRAY, 8, gray8, NULL, 0, NULL, 0,
+     GX_TF_I8, GX_TF_I8,
+     {GRAY(0),  GRAY(1),  GRAY(2),  GRAY(3),  GRAY(4),   GRAY(5),   GRAY(6),
+      GRAY(7),  GRAY(8),  GRAY(16), GRAY(32), GRAY(64),  GRAY(128), GRAY(200),
+      GRAY(254), GRAY(255), GRAY(9), GRAY(19), GRAY(29), GRAY(39),  GRAY(49),
+      GRAY(59), GRAY(69), GRAY(79), GRAY(90), GRAY(91),  GRAY(92),  GRAY(93),
+      GRAY(94), GRAY(95), GRAY(96), GRAY(97)}},
+    {"gray 4 bit",
+     8, 4, PNG_COLOR_TYPE_GRAY, 4, gray4, NULL, 0, NULL, 0,
+     GX_TF_I8, GX_TF_I8,
+     {GRAY(0x00), GRAY(0x11), GRAY(0x22), GRAY(0x33), GRAY(0x44), GRAY(0x55),
+      GRAY(0x66), GRAY(0x77), GRAY(0x88), GRAY(0x99), GRAY(0xaa), GRAY(0xbb),
+      GRAY(0xcc), GRAY(0xdd), GRAY(0xee), GRAY(0xff), GRAY(0xff), GRAY(0x00),
+      GRAY(0x00), GRAY(0xff), GRAY(0x55), GRAY(0xaa), GRAY(0xaa), GRAY(0x55),
+      GRAY(0x11), GRAY(0x11), GRAY(0x22), GRAY(0x22), GRAY(0x33), GRAY(0x33),
+      GRAY(0x44), GRAY(0x44)}},
+    {"gray and alpha",
+     4, 4, PNG_COLOR_TYPE_GRAY_ALPHA, 8, grayAlpha, NULL, 0, NULL, 0,
+     GX_TF_IA8, GX_TF_IA8,
+     {GRAY_ALPHA(0x10, 0xff), GRAY_ALPHA(0x20, 0x80), GRAY_ALPHA(0x30, 0x00),
+      GRAY_ALPHA(0x40, 0x7f), GRAY_ALPHA(0x50, 0x01), GRAY_ALPHA(0x60, 0xfe),
+      GRAY_ALPHA(0x70, 0x3c), GRAY_ALPHA(0x80, 0xc3), GRAY_ALPHA(0x90, 0x11),
+      GRAY_ALPHA(0xa0, 0x22), GRAY_ALPHA(0xb0, 0x33), GRAY_ALPHA(0xc0, 0x44),
+      GRAY_ALPHA(0xd0, 0x55), GRAY_ALPHA(0xe0, 0x66), GRAY_ALPHA(0xf0, 0x77),
+      GRAY_ALPHA(0xff, 0x88)}},
+    {"indexed gray",
+     8, 4, PNG_COLOR_TYPE_PALETTE, 8, indices8, grayPalette, 4, NULL, 0,
+     GX_TF_I8, GX_TF_I8, {}},
+    {"indexed gray, opaque tRNS",
+     8, 4, PNG_COLOR_TYPE_PALETTE, 8, indices8, grayPalette, 4, opaque, 4,
+     GX_TF_I8, GX_TF_I8, {}},
+    {"indexed gray and alpha",
+     4, 4, PNG_COLOR_TYPE_PALETTE, 8, indices8, grayPalette, 4, translucent, 4,
+     GX_TF_IA8, GX_TF_IA8, {}},
+    {"indexed color",
+     4, 4, PNG_COLOR_TYPE_PALETTE, 8, indices8, colorPalette, 4, NULL, 0,
+     GX_TF_RGB565, GX_TF_RGBA8, {}},
+    {"indexed color, opaque tRNS",
+     4, 4, PNG_COLOR_TYPE_PALETTE, 8, indices8, colorPalette, 4, opaque, 4,
+     GX_TF_RGB565, GX_TF_RGBA8, {}},
+    {"indexed color and alpha, 2 bit",
+     4, 4, PNG_COLOR_TYPE_PALETTE, 2, indices2, colorPalette, 4, translucent,
+     4, GX_TF_RGBA8, GX_TF_RGBA8, {}},
+    {"color",
+     4, 4, PNG_COLOR_TYPE_RGB, 8, rgb, NULL, 0, NULL, 0,
+     GX_TF_RGB565, GX_TF_RGBA8,
+     {{0x00, 0x01, 0x02, 0xff}, {0x10, 0x20, 0x30, 0xff},
+      {0xff, 0x00, 0x00, 0xff}, {0x00, 0xff, 0x00, 0xff},
+      {0x00, 0x00, 0xff, 0xff}, {0x12, 0x34, 0x56, 0xff},
+      {0x78, 0x9a, 0xbc, 0xff}, {0xde, 0xf0, 0x0f, 0xff},
+      {0xff, 0xff, 0xff, 0xff}, {0x80, 0x80, 0x80, 0xff},
+      {0x07, 0x03, 0x07, 0xff}, {0x08, 0x04, 0x08, 0xff},
+      {0xf8, 0xfc, 0xf8, 0xff}, {0x11, 0x22, 0x33, 0xff},
+      {0x44, 0x55, 0x66, 0xff}, {0x77, 0x88, 0x99, 0xff}}}};
+
+/**
+ * Checks the texture format chosen for the gray, gray and alpha and indexed
+ * fixtures, and the texels they are decoded to in that format
+ */
+static void test_texture_format() {
+    for (size_t i = 0; i < sizeof(fixtures) / sizeof(fixtures[0]); i++) {
+        const Fixture& f = fixtures[i];
+        PngImage image = write_png(f.pixels, f.width, f.height, f.colorType,
+                                   false, f.palette, f.paletteSize, f.trans,
+                                   f.transSize, f.bitDepth);
+        for (int allowRGB565 = 0; allowRGB565 < 2; allowRGB565++) {
+            u8 expectedFormat = allowRGB565 ? f.format : f.formatRGBA8;
+            u8 format = 0xff;
+            u8 texels[64], expected[64];
+            memset(texels, 0x5a, sizeof(texels));
+
+            IMGCTX ctx = PNGU_SelectImageFromBuffer(image.data);
+            int ret = PNGU_GetTextureFormat(ctx, allowRGB565, &format);
+            CHECK(ret == PNGU_OK && format == expectedFormat,
+                  "%s: format %d, expected %d", f.name, format,
+                  expectedFormat);
+            if (ret == PNGU_OK && format == expectedFormat) {
+                ret = PNGU_DecodeTo4x4(ctx, f.width, f.height, texels, format,
+                                       0xff);
+                size_t size = fixture_texels(f, format, expected);
+                CHECK(ret == PNGU_OK && !memcmp(texels, expected, size),
+                      "%s: texels of format %d", f.name, format);
+            }
+            PNGU_ReleaseImageContext(ctx);
+        }
+        free(image.data);
+    }
+}
+
+/**
+ * Pins the intensity and alpha layouts: a gray image decoded to IA8 gets the
+ * default alpha in the high byte of its texels, and IA4 texels (written by
+ * the swizzler, PNGU has no IA4 decode) hold the alpha in their high nibble
+ */
+static void test_intensity_alpha_layout() {
+    static const u8 pixels[16] = {0x00, 0x12, 0x34, 0x56, 0x78, 0x9a,
+                                  0xbc, 0xde, 0xf0, 0x0f, 0x1e, 0x2d,
+                                  0x3c, 0x4b, 0x5a, 0x69};
+    PngImage image = write_png(pixels, 4, 4, PNG_COLOR_TYPE_GRAY, false);
+    u8 texels[32];
+    IMGCTX ctx = PNGU_SelectImageFromBuffer(image.data);
+    int ret = PNGU_DecodeTo4x4(ctx, 4, 4, texels, GX_TF_IA8, 0xc0);
+    PNGU_ReleaseImageContext(ctx);
+    free(image.data);
+    bool match = ret == PNGU_OK;
+    for (int i = 0; i < 16; i++) {
+        match = match && texels[i * 2] == 0xc0 && texels[i * 2 + 1] == pixels[i];
+    }
+    CHECK(match, "gray to IA8: alpha not in the high byte");
+
+    // IA4 from intensity and alpha rows, a single 8x4 tile
+    u8 ia8[4][16];
+    const u8* rows[4] = {ia8[0], ia8[1], ia8[2], ia8[3]};
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 8; x++) {
+            ia8[y][x * 2] = 0x0f + x * 0x20;   // Intensity
+            ia8[y][x * 2 + 1] = 0xf0 - y * 0x30 - x;  // Alpha
+        }
+    }
+    ret = wii_swizzle_rows(GX_TF_IA4, WII_SWIZZLE_SRC_IA8, rows, 0, 8, 4, 0xff,
+                           texels, 8, 0, 0);
+    match = ret == 0;
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 8; x++) {
+            u8 expected = (ia8[y][x * 2 + 1] & 0xf0) | (ia8[y][x * 2] >> 4);
+            match = match && texels[y * 8 + x] == expected;
+        }
+    }
+    CHECK(match, "IA4: alpha not in the high nibble");
+}
+
+int main() {
+    srand(1);
+    test_decode_4x4();
+    test_decode_4x4_invalid();
+    test_texture_format();
+    test_intensity_alpha_layout();
+    PNGU_ReleaseBandBuffers();
+
+    printf("pngu_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Measures the integer scalers of the blit surface against the pixel at a
+// time loop they replaced, for a 320x240 surface scaled into a 640x480 one
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "wii_scale.h"
+
+#define SRC_WIDTH 320
+#define SRC_HEIGHT 240
+#define DST_WIDTH 640
+#define DST_HEIGHT 480
+#define FRAMES 500
+
+/**
+ * The 8bpp loop the scalers replaced (the rows are DST_WIDTH apart)
+ */
+static void old_scale(int scale, const u8* blitpixels, u8* backpixels,
+                      int width, int height) {
+    int offsetx = ((DST_WIDTH - (width * scale)) / 2);
+    int offsety = ((DST_HEIGHT - (height * scale)) / 2);
+    for (int y = 0; y < height; y++) {
+        for (int i = 0; i < scale; i++) {
+            int start = y * width;
+            int src = 0;
+            int dst = ((((y * scale) + i) + offsety) * DST_WIDTH) + offsetx;
+            for (int x = 0; x < width; x++) {
+                for (int j = 0; j < scale; j++) {
+                    backpixels[dst++] = blitpixels[start + src];
+                }
+                src++;
+            }
+        }
+    }
+}
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/** Scales an image into the destination */
+typedef void (*scaler)(const u8* src, int srcPitch, u8* dst, int dstPitch,
+                       int width, int height);
+
+/**
+ * Returns the frames per second of the scaler
+ */
+static double measure(scaler fn, int scale, int bpp, const u8* src, u8* dst) {
+    int w = DST_WIDTH / scale < SRC_WIDTH ? DST_WIDTH / scale : SRC_WIDTH;
+    int h = DST_HEIGHT / scale < SRC_HEIGHT ? DST_HEIGHT / scale : SRC_HEIGHT;
+    double start = now();
+    for (int n = 0; n < FRAMES; n++) {
+        fn(src, SRC_WIDTH * bpp, dst, DST_WIDTH * bpp, w, h);
+    }
+    return FRAMES / (now() - start);
+}
+
+int main() {
+    u8* src = (u8*)malloc(SRC_WIDTH * SRC_HEIGHT * 4);
+    u8* dst = (u8*)malloc(DST_WIDTH * DST_HEIGHT * 4);
+    for (int i = 0; i < SRC_WIDTH * SRC_HEIGHT * 4; i++) {
+        src[i] = rand();
+    }
+
+    static const scaler scalers[3][3] = {
+        {scale_image<ScaleRow8<1>, 1, u8>, scale_image<ScaleRow8<2>, 2, u8>,
+         scale_image<ScaleRow8<3>, 3, u8>},
+        {scale_image<ScaleRow16<1>, 1, u16>,
+         scale_image<ScaleRow16<2>, 2, u16>,
+         scale_image<ScaleRow16<3>, 3, u16>},
+        {scale_image<ScaleRow32<1>, 1, u32>,
+         scale_image<ScaleRow32<2>, 2, u32>,
+         scale_image<ScaleRow32<3>, 3, u32>}};
+    static const int bpps[3] = {1, 2, 4};
+
+    printf("frames/s        x1       x2       x3\n");
+    printf("8bpp old  ");
+    for (int scale = 1; scale <= 3; scale++) {
+        int w = DST_WIDTH / scale < SRC_WIDTH ? DST_WIDTH / scale : SRC_WIDTH;
+        int h =
+            DST_HEIGHT / scale < SRC_HEIGHT ? DST_HEIGHT / scale : SRC_HEIGHT;
+        double start = now();
+        for (int n = 0; n < FRAMES; n++) {
+            old_scale(scale, src, dst, w, h);
+        }
+        printf(" %8.0f", FRAMES / (now() - start));
+    }
+    printf("\n");
+    for (int b = 0; b < 3; b++) {
+        printf("%2dbpp     ", bpps[b] * 8);
+        for (int scale = 1; scale <= 3; scale++) {
+            printf(" %8.0f",
+                   measure(scalers[b][scale - 1], scale, bpps[b], src, dst));
+        }
+        printf("\n");
+    }
+
+    u32 sum = 0;
+    for (int i = 0; i < DST_WIDTH * DST_HEIGHT; i++) {
+        sum += dst[i];
+    }
+    printf("[%08x]\n", sum);
+
+    free(src);
+    free(dst);
+    return 0;
+}
@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Tests the integer scalers of the blit surface against a pixel at a time
+// reference, for every pixel size, scale, width remainder and pitch
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wii_scale.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/** Scales an image into the destination */
+typedef void (*scaler)(const u8* src, int srcPitch, u8* dst, int dstPitch,
+                       int width, int height);
+
+/**
+ * Scales an image a pixel at a time
+ */
+template <typename Pixel>
+static void ref_scale(int scale, const u8* src, int srcPitch, u8* dst,
+                      int dstPitch, int width, int height) {
+    for (int y = 0; y < height * scale; y++) {
+        const Pixel* in = (const Pixel*)(src + (y / scale) * srcPitch);
+        Pixel* out = (Pixel*)(dst + y * dstPitch);
+        for (int x = 0; x < width * scale; x++) {
+            out[x] = in[x / scale];
+        }
+    }
+}
+
+/**
+ * Scales an image with the specified scaler and the reference, and compares
+ * the destinations (including the bytes past the scaled rows)
+ */
+template <typename Pixel>
+static void test_scaler(const char* name, scaler fn, int scale) {
+    static const int widths[] = {1, 2, 3, 4, 5, 7, 8, 255, 256, 320};
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        int w = widths[i], h = 5;
+        // Odd pitches leave the rows unaligned
+        int srcPitch = w * sizeof(Pixel) + 3;
+        int dstPitch = w * scale * sizeof(Pixel) + 5;
+        u8* src = (u8*)malloc(srcPitch * h + 1) + 1;
+        u8* expected = (u8*)malloc(dstPitch * h * scale);
+        u8* actual = (u8*)malloc(dstPitch * h * scale + 1) + 1;
+        for (int j = 0; j < srcPitch * h; j++) {
+            src[j] = rand();
+        }
+        memset(expected, 0xa5, dstPitch * h * scale);
+        memset(actual, 0xa5, dstPitch * h * scale);
+
+        ref_scale<Pixel>(scale, src, srcPitch, expected, dstPitch, w, h);
+        fn(src, srcPitch, actual, dstPitch, w, h);
+        CHECK(!memcmp(expected, actual, dstPitch * h * scale),
+              "%s x%d width %d", name, scale, w);
+
+        free(src - 1);
+        free(expected);
+        free(actual - 1);
+    }
+}
+
+template <typename Pixel>
+static void any_scaler2(const u8* src, int srcPitch, u8* dst, int dstPitch,
+                        int width, int height) {
+    scale_image_any<Pixel>(2, src, srcPitch, dst, dstPitch, width, height);
+}
+
+template <typename Pixel>
+static void any_scaler4(const u8* src, int srcPitch, u8* dst, int dstPitch,
+                        int width, int height) {
+    scale_image_any<Pixel>(4, src, srcPitch, dst, dstPitch, width, height);
+}
+
+int main() {
+    srand(1);
+
+    test_scaler<u8>("8bpp", scale_image<ScaleRow8<1>, 1, u8>, 1);
+    test_scaler<u8>("8bpp", scale_image<ScaleRow8<2>, 2, u8>, 2);
+    test_scaler<u8>("8bpp", scale_image<ScaleRow8<3>, 3, u8>, 3);
+    test_scaler<u8>("8bpp", scale_image<ScaleRow8<4>, 4, u8>, 4);
+    test_scaler<u16>("16bpp", scale_image<ScaleRow16<1>, 1, u16>, 1);
+    test_scaler<u16>("16bpp", scale_image<ScaleRow16<2>, 2, u16>, 2);
+    test_scaler<u16>("16bpp", scale_image<ScaleRow16<3>, 3, u16>, 3);
+    test_scaler<u32>("32bpp", scale_image<ScaleRow32<1>, 1, u32>, 1);
+    test_scaler<u32>("32bpp", scale_image<ScaleRow32<2>, 2, u32>, 2);
+    test_scaler<u32>("32bpp", scale_image<ScaleRow32<3>, 3, u32>, 3);
+
+    test_scaler<u8>("8bpp any", any_scaler2<u8>, 2);
+    test_scaler<u8>("8bpp any", any_scaler4<u8>, 4);
+    test_scaler<u16>("16bpp any", any_scaler4<u16>, 4);
+    test_scaler<u32>("32bpp any", any_scaler4<u32>, 4);
+
+    printf("scale_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
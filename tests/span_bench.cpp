@@ -0,0 +1,166 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Measures the span writer against the pixel at a time loops of
+// wii_sdl_fill_rectangle and wii_sdl_draw_rectangle it replaced
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gctypes.h>
+
+#include "wii_span.h"
+
+#define WIDTH 640
+#define HEIGHT 480
+#define FILLS 200
+#define FRAMES 20000
+
+/** A pixel buffer */
+typedef struct buffer {
+    u8* pixels;
+    int pitch;
+    int bpp;
+} buffer;
+
+/**
+ * Returns a pointer to the specified location of the buffer
+ */
+static void* get_addr(buffer* b, int x, int y) {
+    return b->pixels + (x * b->bpp) + (y * b->pitch);
+}
+
+/**
+ * The fill loop the span writer replaced (16bpp pixels for 16 and 32bpp)
+ */
+static void old_fill(buffer* b, int x, int y, int w, int h, u32 color) {
+    BOOL is8 = b->bpp == 1;
+    for (int xo = x; xo < w + x; xo++) {
+        for (int yo = y; yo < h + y; yo++) {
+            if (is8) {
+                *((u8*)get_addr(b, xo, yo)) = color;
+            } else {
+                *((u16*)get_addr(b, xo, yo)) = color;
+            }
+        }
+    }
+}
+
+/**
+ * Writes a pixel as the outline loop the span writer replaced did
+ */
+static inline void old_put(buffer* b, int x, int y, u32 color, BOOL exor) {
+    if (b->bpp == 1) {
+        u8* p = (u8*)get_addr(b, x, y);
+        *p = exor ? *p ^ color : color;
+    } else if (b->bpp == 2) {
+        u16* p = (u16*)get_addr(b, x, y);
+        *p = exor ? *p ^ color : color;
+    } else {
+        u32* p = (u32*)get_addr(b, x, y);
+        *p = exor ? *p ^ color : color;
+    }
+}
+
+/**
+ * The outline loop the span writer replaced
+ */
+static void old_frame(buffer* b, int x, int y, int w, int h, u32 color,
+                      BOOL exor) {
+    for (int xo = x + 1; xo < (x + w - 1); xo++) {
+        old_put(b, xo, y, color, exor);
+        if (h > 1) {
+            old_put(b, xo, y + h - 1, color, exor);
+        }
+    }
+    for (int yo = y; yo < (y + h); yo++) {
+        old_put(b, x, yo, color, exor);
+        if (w > 1) {
+            old_put(b, x + w - 1, yo, color, exor);
+        }
+    }
+}
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    static const int bpps[] = {1, 2, 4};
+    u32 sum = 0;
+
+    for (int i = 0; i < 3; i++) {
+        int bpp = bpps[i];
+        buffer b = {(u8*)malloc(WIDTH * HEIGHT * bpp), WIDTH * bpp, bpp};
+
+        double start = now();
+        for (int n = 0; n < FILLS; n++) {
+            old_fill(&b, 0, 0, WIDTH, HEIGHT, n);
+        }
+        double oldFill = (now() - start) / FILLS;
+        start = now();
+        for (int n = 0; n < FILLS; n++) {
+            wii_span_fill(b.pixels, b.pitch, bpp, 0, 0, WIDTH, HEIGHT, n,
+                          FALSE);
+        }
+        double fill = (now() - start) / FILLS;
+
+        start = now();
+        for (int n = 0; n < FRAMES; n++) {
+            old_frame(&b, 20, 20, WIDTH - 40, HEIGHT - 40, n, n & 1);
+        }
+        double oldFrame = (now() - start) / FRAMES;
+        start = now();
+        for (int n = 0; n < FRAMES; n++) {
+            wii_span_frame(b.pixels, b.pitch, bpp, 20, 20, WIDTH - 40,
+                           HEIGHT - 40, n, n & 1);
+        }
+        double frame = (now() - start) / FRAMES;
+
+        printf("%2dbpp fill %dx%d: %.1fus (old %.1fus, %.1fx), "
+               "frame %dx%d: %.2fus (old %.2fus, %.1fx)\n",
+               bpp * 8, WIDTH, HEIGHT, fill * 1e6, oldFill * 1e6,
+               oldFill / fill, WIDTH - 40, HEIGHT - 40, frame * 1e6,
+               oldFrame * 1e6, oldFrame / frame);
+
+        for (int j = 0; j < WIDTH * HEIGHT * bpp; j++) {
+            sum += b.pixels[j];
+        }
+        free(b.pixels);
+    }
+    printf("[%08x]\n", sum);
+
+    return 0;
+}
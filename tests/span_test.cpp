@@ -0,0 +1,182 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Tests the span writer against a pixel at a time reference (the loops of
+// wii_sdl_fill_rectangle and wii_sdl_draw_rectangle it replaced, with the
+// clipping done once up front), for random clipped rectangles
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gctypes.h>
+
+#include "wii_span.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+#define WIDTH 640
+#define HEIGHT 480
+
+/** A pixel buffer */
+typedef struct buffer {
+    u8* pixels;
+    int pitch;
+    int bpp;
+} buffer;
+
+/**
+ * Writes a pixel of the buffer
+ */
+static void ref_put(buffer* b, int x, int y, u32 color, BOOL exor) {
+    u8* p = b->pixels + y * b->pitch + x * b->bpp;
+    if (b->bpp == 1) {
+        *p = exor ? *p ^ color : color;
+    } else if (b->bpp == 2) {
+        u16 v;
+        memcpy(&v, p, 2);
+        v = exor ? v ^ color : color;
+        memcpy(p, &v, 2);
+    } else {
+        u32 v;
+        memcpy(&v, p, 4);
+        v = exor ? v ^ color : color;
+        memcpy(p, &v, 4);
+    }
+}
+
+/**
+ * Fills a rectangle a pixel at a time
+ */
+static void ref_fill(buffer* b, int x, int y, int w, int h, u32 color,
+                     BOOL exor) {
+    for (int xo = x; xo < x + w; xo++) {
+        for (int yo = y; yo < y + h; yo++) {
+            ref_put(b, xo, yo, color, exor);
+        }
+    }
+}
+
+/**
+ * Draws the outline of a rectangle a pixel at a time
+ */
+static void ref_frame(buffer* b, int x, int y, int w, int h, u32 color,
+                      BOOL exor) {
+    for (int xo = x + 1; xo < x + w - 1; xo++) {
+        ref_put(b, xo, y, color, exor);
+        if (h > 1) {
+            ref_put(b, xo, y + h - 1, color, exor);
+        }
+    }
+    for (int yo = y; yo < y + h; yo++) {
+        ref_put(b, x, yo, color, exor);
+        if (w > 1) {
+            ref_put(b, x + w - 1, yo, color, exor);
+        }
+    }
+}
+
+static void test_clip() {
+    int x = -5, y = -3, w = 10, h = 10;
+    CHECK(wii_span_clip(&x, &y, &w, &h, WIDTH, HEIGHT) && x == 0 && y == 0 &&
+              w == 5 && h == 7,
+          "clip top left: %d,%d %dx%d", x, y, w, h);
+    x = WIDTH - 4, y = HEIGHT - 2, w = 10, h = 10;
+    CHECK(wii_span_clip(&x, &y, &w, &h, WIDTH, HEIGHT) && x == WIDTH - 4 &&
+              y == HEIGHT - 2 && w == 4 && h == 2,
+          "clip bottom right: %d,%d %dx%d", x, y, w, h);
+    x = -10, y = 0, w = 10, h = 10;
+    CHECK(!wii_span_clip(&x, &y, &w, &h, WIDTH, HEIGHT), "clip left");
+    x = 0, y = HEIGHT, w = 10, h = 10;
+    CHECK(!wii_span_clip(&x, &y, &w, &h, WIDTH, HEIGHT), "clip below");
+    x = 0, y = 0, w = 0, h = 10;
+    CHECK(!wii_span_clip(&x, &y, &w, &h, WIDTH, HEIGHT), "clip empty");
+}
+
+static void test_rectangles(int bpp) {
+    // The odd offset and pitch leave the rows unaligned
+    int pitch = WIDTH * bpp + 8 + (bpp > 1 ? bpp : 0);
+    int size = pitch * HEIGHT;
+    u8* expectedPixels = (u8*)malloc(size + 1) + 1;
+    u8* actualPixels = (u8*)malloc(size + 1) + 1;
+    buffer expected = {expectedPixels, pitch, bpp};
+    int mismatches = 0;
+
+    for (int t = 0; t < 20000; t++) {
+        if (t % 100 == 0) {
+            for (int i = 0; i < size; i++) {
+                expectedPixels[i] = actualPixels[i] = rand();
+            }
+        }
+        int x = rand() % 700 - 30, y = rand() % 520 - 20;
+        int w = rand() % 200 - 5, h = rand() % 200 - 5;
+        u32 color = rand() * 2654435761u;
+        BOOL exor = rand() & 1;
+        if (!wii_span_clip(&x, &y, &w, &h, WIDTH, HEIGHT)) {
+            continue;
+        }
+        if (t & 1) {
+            ref_fill(&expected, x, y, w, h, color, exor);
+            wii_span_fill(actualPixels, pitch, bpp, x, y, w, h, color, exor);
+        } else {
+            ref_frame(&expected, x, y, w, h, color, exor);
+            wii_span_frame(actualPixels, pitch, bpp, x, y, w, h, color, exor);
+        }
+        if (memcmp(expectedPixels, actualPixels, size)) {
+            mismatches++;
+            memcpy(actualPixels, expectedPixels, size);
+        }
+    }
+    CHECK(!mismatches, "%dbpp: %d rectangles differ", bpp * 8, mismatches);
+
+    free(expectedPixels - 1);
+    free(actualPixels - 1);
+}
+
+int main() {
+    srand(1);
+
+    test_clip();
+    test_rectangles(1);
+    test_rectangles(2);
+    test_rectangles(4);
+
+    printf("span_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
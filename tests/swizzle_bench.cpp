@@ -0,0 +1,97 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Measures the texels per second of wii_swizzle_rows converting a 640x480
+// RGBA8 (R, G, B, A bytes) image into each of the 16 and 32-bit texture
+// formats. Built with WII_SWIZZLE_SCALAR it measures the byte store fallback
+// in place of the SSE2 or NEON tile row writes.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gccore.h>
+
+#include "wii_swizzle.h"
+
+#define WIDTH 640
+#define HEIGHT 480
+#define FRAMES 200
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    static const u8 formats[] = {GX_TF_RGB565, GX_TF_RGB5A3, GX_TF_IA8,
+                                 GX_TF_RGBA8};
+    static const char* names[] = {"RGB565", "RGB5A3", "IA8", "RGBA8"};
+    static const int bytes[] = {2, 2, 2, 4};
+
+    u8* src = (u8*)malloc(WIDTH * HEIGHT * 4);
+    for (int i = 0; i < WIDTH * HEIGHT * 4; i++) {
+        src[i] = rand();
+    }
+    const u8* rows[HEIGHT];
+    for (int y = 0; y < HEIGHT; y++) {
+        rows[y] = src + y * WIDTH * 4;
+    }
+    u8* dst = (u8*)malloc(WIDTH * HEIGHT * 4);
+    u32 sum = 0;
+
+#ifdef WII_SWIZZLE_SCALAR
+    printf("%dx%d RGBA8 (scalar)   Mtexels/s\n", WIDTH, HEIGHT);
+#else
+    printf("%dx%d RGBA8            Mtexels/s\n", WIDTH, HEIGHT);
+#endif
+    for (int f = 0; f < 4; f++) {
+        double start = now();
+        for (int n = 0; n < FRAMES; n++) {
+            wii_swizzle_rows(formats[f], WII_SWIZZLE_SRC_RGBA8, rows, 0, WIDTH,
+                             HEIGHT, 0xff, dst, WIDTH, 0, 0);
+        }
+        double elapsed = now() - start;
+        printf("%-20s %10.1f\n", names[f],
+               (double)WIDTH * HEIGHT * FRAMES / elapsed / 1e6);
+
+        for (int i = 0; i < WIDTH * HEIGHT * bytes[f]; i++) {
+            sum += dst[i];
+        }
+    }
+    printf("[%08x]\n", sum);
+
+    free(src);
+    free(dst);
+    return 0;
+}
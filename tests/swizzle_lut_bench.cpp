@@ -0,0 +1,152 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Measures the frames per second of the conversion of a 256x224 indexed
+// (8bpp) image into a tiled texture: the palette lookup and conversion of
+// each pixel, the image expanded to RGB8 and swizzled, and the precomputed
+// palette texels of wii_swizzle_indexed
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gccore.h>
+
+#include "wii_swizzle.h"
+
+#define WIDTH 256
+#define HEIGHT 224
+#define FRAMES 300
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Converts the image a pixel at a time, looking up and converting the
+ * palette color of each pixel
+ */
+static void convert_pixels(u8 format, const u8* palette, const u8* src,
+                           u8* dst) {
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            const u8* c = palette + 4 * src[y * WIDTH + x];
+            int tile = (y >> 2) * (WIDTH >> 2) + (x >> 2);
+            int texel = ((y & 3) << 2) + (x & 3);
+            if (format == GX_TF_RGB565) {
+                u16 v = ((c[0] & 0xf8) << 8) | ((c[1] & 0xfc) << 3) |
+                        (c[2] >> 3);
+                u8* p = dst + tile * 32 + texel * 2;
+                p[0] = v >> 8;
+                p[1] = v;
+            } else {
+                u8* p = dst + tile * 64 + texel * 2;
+                p[0] = 0xff;
+                p[1] = c[0];
+                p[32] = c[1];
+                p[33] = c[2];
+            }
+        }
+    }
+}
+
+/**
+ * Expands the image to RGB8 and swizzles the expanded rows
+ */
+static void convert_expanded(u8 format, const u8* palette, const u8* src,
+                             u8* rgb, u8* dst) {
+    const u8* rows[HEIGHT];
+    for (int y = 0; y < HEIGHT; y++) {
+        u8* row = rgb + y * WIDTH * 3;
+        for (int x = 0; x < WIDTH; x++) {
+            memcpy(row + x * 3, palette + 4 * src[y * WIDTH + x], 3);
+        }
+        rows[y] = row;
+    }
+    wii_swizzle_rows(format, WII_SWIZZLE_SRC_RGB8, rows, 0, WIDTH, HEIGHT,
+                     0xff, dst, WIDTH, 0, 0);
+}
+
+int main() {
+    static const u8 formats[] = {GX_TF_RGB565, GX_TF_RGBA8};
+    static const char* names[] = {"RGB565", "RGBA8"};
+
+    u8 palette[256 * 4];
+    for (int i = 0; i < (int)sizeof(palette); i++) {
+        palette[i] = rand();
+    }
+    u8* src = (u8*)malloc(WIDTH * HEIGHT);
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        src[i] = rand();
+    }
+    u8* rgb = (u8*)malloc(WIDTH * HEIGHT * 3);
+    u8* dst = (u8*)malloc(WIDTH * HEIGHT * 4);
+    u32 sum = 0;
+
+    printf("frames/s    per pixel   expanded        lut\n");
+    for (int f = 0; f < 2; f++) {
+        u8 format = formats[f];
+        wii_swizzle_lut lut;
+        memset(&lut, 0, sizeof(lut));
+
+        printf("%-9s", names[f]);
+        for (int method = 0; method < 3; method++) {
+            double start = now();
+            for (int n = 0; n < FRAMES; n++) {
+                if (method == 0) {
+                    convert_pixels(format, palette, src, dst);
+                } else if (method == 1) {
+                    convert_expanded(format, palette, src, rgb, dst);
+                } else {
+                    // The palette is unchanged, the texels are computed once
+                    wii_swizzle_lut_update(&lut, format, palette, 256, 1, 0xff);
+                    wii_swizzle_indexed(&lut, src, WIDTH, WIDTH, HEIGHT, dst,
+                                        WIDTH);
+                }
+            }
+            printf(" %10.0f", FRAMES / (now() - start));
+        }
+        printf("\n");
+
+        for (int i = 0; i < WIDTH * HEIGHT * 2 * (f + 1); i++) {
+            sum += dst[i];
+        }
+    }
+    printf("[%08x]\n", sum);
+
+    free(src);
+    free(rgb);
+    free(dst);
+    return 0;
+}
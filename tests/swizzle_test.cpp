@@ -0,0 +1,361 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+//
+// Tests the tile swizzler against a straightforward reference that places
+// each texel of the GX texture formats individually
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gccore.h>
+
+#include "wii_swizzle.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/**
+ * Returns the tile dimensions and size of a texture format
+ */
+static void tile_info(u8 format, int* tw, int* th, int* bytes) {
+    *tw = 4;
+    *th = 4;
+    *bytes = 32;
+    switch (format) {
+        case GX_TF_I4:
+            *tw = 8;
+            *th = 8;
+            break;
+        case GX_TF_I8:
+        case GX_TF_IA4:
+            *tw = 8;
+            break;
+        case GX_TF_RGBA8:
+            *bytes = 64;
+            break;
+    }
+}
+
+/**
+ * Reads a source pixel as a packed RGBA value
+ */
+static u32 ref_read(int layout, const u8* p, u8 alpha) {
+    switch (layout) {
+        case WII_SWIZZLE_SRC_RGB8:
+            return ((u32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | alpha;
+        case WII_SWIZZLE_SRC_RGBA8:
+            return ((u32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        case WII_SWIZZLE_SRC_I8:
+            return ((u32)p[0] << 24) | (p[0] << 16) | (p[0] << 8) | p[0];
+        default:
+            return ((u32)p[0] << 24) | (p[0] << 16) | (p[0] << 8) | p[1];
+    }
+}
+
+static int layout_bytes(int layout) {
+    static const int bytes[] = {3, 4, 1, 2};
+    return bytes[layout];
+}
+
+/**
+ * Stores a 16-bit texel (big-endian, as read by the GPU)
+ */
+static void ref_store16(u8* tile, int offset, u16 texel) {
+    tile[offset] = texel >> 8;
+    tile[offset + 1] = texel;
+}
+
+/**
+ * Stores a texel at texture coordinates x, y
+ */
+static void ref_store(u8 format, u8* dst, int dstWidth, int x, int y,
+                      u32 t) {
+    int tw, th, bytes;
+    tile_info(format, &tw, &th, &bytes);
+    u8* tile = dst + ((y / th) * (dstWidth / tw) + x / tw) * bytes;
+    int i = (y % th) * tw + x % tw;
+    u8 r = t >> 24, g = t >> 16, b = t >> 8, a = t;
+
+    switch (format) {
+        case GX_TF_I4:
+            if (i & 1) {
+                tile[i >> 1] = (tile[i >> 1] & 0xf0) | (a >> 4);
+            } else {
+                tile[i >> 1] = (tile[i >> 1] & 0x0f) | (a & 0xf0);
+            }
+            break;
+        case GX_TF_I8:
+            tile[i] = a;
+            break;
+        case GX_TF_IA4:
+            tile[i] = (a & 0xf0) | (b >> 4);
+            break;
+        case GX_TF_IA8:
+            ref_store16(tile, i * 2, (a << 8) | b);
+            break;
+        case GX_TF_RGB565:
+            ref_store16(tile, i * 2,
+                        ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+            break;
+        case GX_TF_RGB5A3:
+            if (a >= 0xe0) {
+                ref_store16(tile, i * 2, 0x8000 | ((r >> 3) << 10) |
+                                             ((g >> 3) << 5) | (b >> 3));
+            } else {
+                ref_store16(tile, i * 2, ((a >> 5) << 12) | ((r >> 4) << 8) |
+                                             ((g >> 4) << 4) | (b >> 4));
+            }
+            break;
+        case GX_TF_RGBA8:
+            ref_store16(tile, i * 2, (a << 8) | r);
+            ref_store16(tile, 32 + i * 2, (g << 8) | b);
+            break;
+    }
+}
+
+/**
+ * Converts the rectangle with the reference. Texels of the covered tiles
+ * outside of the rectangle are cleared.
+ */
+static void ref_swizzle(u8 format, int layout, const u8* const* rows,
+                        int srcX, int width, int height, u8 alpha, u8* dst,
+                        int dstWidth, int dstX, int dstY) {
+    int tw, th, bytes;
+    tile_info(format, &tw, &th, &bytes);
+    int coveredW = (width + tw - 1) / tw * tw;
+    int coveredH = (height + th - 1) / th * th;
+    for (int y = 0; y < coveredH; y++) {
+        for (int x = 0; x < coveredW; x++) {
+            u32 t = 0;
+            if (x < width && y < height) {
+                t = ref_read(layout,
+                             rows[y] + (srcX + x) * layout_bytes(layout),
+                             alpha);
+            }
+            ref_store(format, dst, dstWidth, dstX + x, dstY + y, t);
+        }
+    }
+}
+
+static const u8 formats[] = {GX_TF_I4,     GX_TF_I8,     GX_TF_IA4,
+                             GX_TF_IA8,    GX_TF_RGB565, GX_TF_RGB5A3,
+                             GX_TF_RGBA8};
+
+/**
+ * Compares wii_swizzle_rows with the reference for all formats and source
+ * layouts over a range of rectangle sizes and positions
+ */
+static void test_swizzle_rows() {
+    static const int sizes[][2] = {{1, 1},  {3, 2},   {4, 4},   {7, 5},
+                                   {8, 8},  {9, 13},  {16, 4},  {31, 17},
+                                   {64, 3}, {100, 37}};
+    for (size_t f = 0; f < sizeof(formats); f++) {
+        int tw, th, bytes;
+        tile_info(formats[f], &tw, &th, &bytes);
+        for (int layout = 0; layout < 4; layout++) {
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+                int width = sizes[s][0], height = sizes[s][1];
+                int srcX = rand() % 5;
+                int dstX = (rand() % 3) * tw, dstY = (rand() % 3) * th;
+                int dstWidth = (dstX + width + tw - 1) / tw * tw + tw;
+                int dstHeight = (dstY + height + th - 1) / th * th + th;
+                int pitch = (srcX + width) * layout_bytes(layout) + 3;
+                size_t size = dstWidth * dstHeight * bytes / (tw * th);
+
+                u8* src = (u8*)malloc(pitch * height);
+                const u8** rows = (const u8**)malloc(height * sizeof(u8*));
+                for (int i = 0; i < pitch * height; i++) {
+                    src[i] = rand();
+                }
+                for (int y = 0; y < height; y++) {
+                    rows[y] = src + y * pitch;
+                }
+
+                // Tiles outside of the rectangle must be left alone
+                u8* expected = (u8*)malloc(size);
+                u8* actual = (u8*)malloc(size);
+                memset(expected, 0x5a, size);
+                memset(actual, 0x5a, size);
+
+                u8 alpha = rand();
+                ref_swizzle(formats[f], layout, rows, srcX, width, height,
+                            alpha, expected, dstWidth, dstX, dstY);
+                int ret = wii_swizzle_rows(formats[f], layout, rows, srcX,
+                                           width, height, alpha, actual,
+                                           dstWidth, dstX, dstY);
+                CHECK(ret == 0 && !memcmp(expected, actual, size),
+                      "wii_swizzle_rows format %d layout %d %dx%d at %d,%d",
+                      formats[f], layout, width, height, dstX, dstY);
+
+                free(src);
+                free(rows);
+                free(expected);
+                free(actual);
+            }
+        }
+    }
+
+    u8 texture[64];
+    const u8* row = texture;
+    CHECK(wii_swizzle_rows(GX_TF_CMPR, WII_SWIZZLE_SRC_RGB8, &row, 0, 4, 1,
+                           0xff, texture, 4, 0, 0) == -1,
+          "wii_swizzle_rows accepts an unsupported format");
+}
+
+/**
+ * Compares wii_swizzle_indexed with wii_swizzle_rows of the image expanded
+ * through the palette
+ */
+static void test_swizzle_indexed() {
+    static const u8 lutFormats[] = {GX_TF_RGB565, GX_TF_RGBA8};
+    static const int sizes[][2] = {{1, 1}, {3, 5},     {4, 4},
+                                   {7, 9}, {255, 223}, {256, 224}};
+    u8 palette[256 * 4];
+    for (int i = 0; i < (int)sizeof(palette); i++) {
+        palette[i] = rand();
+    }
+
+    for (size_t f = 0; f < sizeof(lutFormats); f++) {
+        u8 format = lutFormats[f];
+        wii_swizzle_lut lut;
+        memset(&lut, 0, sizeof(lut));
+        CHECK(wii_swizzle_indexed(&lut, palette, 4, 4, 4, palette, 4) == -1,
+              "wii_swizzle_indexed converts without palette texels");
+        wii_swizzle_lut_update(&lut, format, palette, 256, 1, 0xff);
+
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            int width = sizes[s][0], height = sizes[s][1];
+            int pitch = width + 5;
+            int dstWidth = ((width + 3) & ~3) + 8;
+            int dstHeight = (height + 3) & ~3;
+            size_t size =
+                dstWidth * dstHeight * (format == GX_TF_RGBA8 ? 4 : 2);
+
+            u8* src = (u8*)malloc(pitch * height);
+            u8* rgb = (u8*)malloc(width * height * 3);
+            const u8** rows = (const u8**)malloc(height * sizeof(u8*));
+            for (int i = 0; i < pitch * height; i++) {
+                src[i] = rand();
+            }
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    memcpy(rgb + (y * width + x) * 3,
+                           palette + 4 * src[y * pitch + x], 3);
+                }
+                rows[y] = rgb + y * width * 3;
+            }
+
+            // The indexed conversion clears the whole texture, including the
+            // tiles right of the image
+            u8* expected = (u8*)calloc(size, 1);
+            u8* actual = (u8*)malloc(size);
+            memset(actual, 0xcc, size);
+            wii_swizzle_rows(format, WII_SWIZZLE_SRC_RGB8, rows, 0, width,
+                             height, 0xff, expected, dstWidth, 0, 0);
+            wii_swizzle_indexed(&lut, src, pitch, width, height, actual,
+                                dstWidth);
+            CHECK(!memcmp(expected, actual, size),
+                  "wii_swizzle_indexed format %d %dx%d", format, width,
+                  height);
+
+            free(src);
+            free(rgb);
+            free(rows);
+            free(expected);
+            free(actual);
+        }
+    }
+}
+
+/**
+ * Converts textures back to RGB rows with wii_deswizzle_rgb8
+ */
+static void test_deswizzle() {
+    static const u8 rgbFormats[] = {GX_TF_RGB565, GX_TF_RGBA8};
+    const int width = 13, height = 10, dstWidth = 16, dstHeight = 12;
+    for (size_t f = 0; f < sizeof(rgbFormats); f++) {
+        u8 format = rgbFormats[f];
+        u8 src[width * height * 3];
+        const u8* rows[height];
+        for (int i = 0; i < (int)sizeof(src); i++) {
+            src[i] = rand();
+            // RGB565 keeps the upper bits of the components only
+            if (format == GX_TF_RGB565) {
+                src[i] &= (i % 3) == 1 ? 0xfc : 0xf8;
+            }
+        }
+        for (int y = 0; y < height; y++) {
+            rows[y] = src + y * width * 3;
+        }
+
+        u8 texture[dstWidth * dstHeight * 4];
+        wii_swizzle_rows(format, WII_SWIZZLE_SRC_RGB8, rows, 0, width, height,
+                         0xff, texture, dstWidth, 0, 0);
+
+        u8 out[width * height * 3];
+        for (int y = 0; y < height; y += 4) {
+            int rowCount = height - y < 4 ? height - y : 4;
+            wii_deswizzle_rgb8(format, texture, width, y, rowCount,
+                               out + y * width * 3, width * 3);
+        }
+
+        bool match = true;
+        for (int i = 0; i < (int)sizeof(src); i++) {
+            u8 expected = src[i];
+            if (format == GX_TF_RGB565) {
+                // Expanded by replicating the upper bits
+                int bits = (i % 3) == 1 ? 6 : 5;
+                expected |= expected >> bits;
+            }
+            match = match && out[i] == expected;
+        }
+        CHECK(match, "wii_deswizzle_rgb8 format %d", format);
+    }
+}
+
+int main() {
+    srand(1);
+    test_swizzle_rows();
+    test_swizzle_indexed();
+    test_deswizzle();
+
+    printf("swizzle_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Stress test of the triple buffer exchange. A producer thread draws
+// numbered frames into the buffers it is handed and publishes them as fast
+// as it can, while the consumer (the main thread) takes the newest frames.
+// Each frame taken must be drawn completely (no torn frames), newer than the
+// previous one, and the last frame published must be the last one taken.
+//
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <gctypes.h>
+
+#include "wii_triple_buffer.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/** The count of frames published by the producer */
+#define FRAMES 200000
+/** The count of words of each buffer */
+#define WORDS 1024
+
+/** The exchanged buffers */
+static u32 buffers[3][WORDS];
+/** The exchange of the buffers */
+static wii_triple_buffer exchange;
+/** Set once the producer published its last frame */
+static volatile int done = 0;
+
+/**
+ * Draws and publishes the frames (the producer)
+ */
+static void* produce(void* arg) {
+    u32 back = exchange.back;
+    for (u32 frame = 1; frame <= FRAMES; frame++) {
+        for (int i = 0; i < WORDS; i++) {
+            buffers[back][i] = frame;
+        }
+        back = wii_triple_buffer_publish(&exchange);
+        if (!(frame & 0x3f)) {
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+int main() {
+    wii_triple_buffer_init(&exchange);
+    memset(buffers, 0, sizeof(buffers));
+
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, produce, NULL)) {
+        printf("triple_buffer_stress: unable to create the producer\n");
+        return 1;
+    }
+
+    int taken = 0;
+    int torn = 0;
+    int stale = 0;
+    u32 last = 0;
+    for (;;) {
+        // Read before acquiring, a frame published before done is set is
+        // taken by this iteration
+        int finished = __atomic_load_n(&done, __ATOMIC_ACQUIRE);
+        if (wii_triple_buffer_acquire(&exchange)) {
+            const u32* frame = buffers[exchange.front];
+            for (int i = 1; i < WORDS; i++) {
+                if (frame[i] != frame[0]) {
+                    torn++;
+                    break;
+                }
+            }
+            if (frame[0] <= last) {
+                stale++;
+            }
+            last = frame[0];
+            taken++;
+        } else if (finished) {
+            break;
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+
+    CHECK(!torn, "%d of %d frames torn", torn, taken);
+    CHECK(!stale, "%d of %d frames not newer than the previous", stale, taken);
+    CHECK(last == FRAMES, "last frame taken %u, expected %u", last, FRAMES);
+    CHECK(!wii_triple_buffer_acquire(&exchange), "frame taken twice");
+
+    printf("triple_buffer_stress: %d checks, %d failures (%d frames taken)\n",
+           checks, failures, taken);
+    return failures ? 1 : 0;
+}
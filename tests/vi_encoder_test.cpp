@@ -0,0 +1,409 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+//
+// Tests the shadowed and queued encoder register writes of vi_encoder.cpp,
+// built with a stub I2C transaction (VI_ENCODER_I2C_STUB) which records the
+// writes into a model of the encoder registers. Covers the skipped writes,
+// the coalescing of queued registers into bursts (bridging short gaps of
+// known registers), the cancelling of queued values by direct writes, the
+// retrace flush callback chaining, and that each transaction is sent with
+// interrupts disabled (so a direct write from an interrupt can't come
+// between a queued value being taken and sent, and be overwritten by it).
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include <gccore.h>
+
+#include "vi_encoder.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/** The slave address of the encoder */
+#define ENCODER_ADDR 0xe0
+/** The first gamma register and the count of them */
+#define GAMMA_REG 0x10
+#define GAMMA_SIZE 0x21
+
+/** A transaction sent to the encoder */
+typedef struct send {
+    u8 reg;
+    u32 count;
+} send;
+
+/** The VI registers read by vi_encoder.cpp */
+vu16 __viStubRegs[64];
+
+/** The encoder registers, as written by the successful transactions */
+static u8 encoder[0x100];
+/** The transactions sent since the last reset_sends */
+static send sends[0x100];
+static u32 sendCount = 0;
+/** Transactions sent with interrupts enabled, or not to the encoder */
+static u32 unlockedSends = 0;
+static u32 badSends = 0;
+/** Whether the next transaction fails */
+static BOOL failNext = FALSE;
+/** The gamma tables, as written by VIDEO_SetGamma */
+static u8 gammas[VI_GM_3_0 + 1][GAMMA_SIZE];
+
+/** The retrace counts passed to on_retrace */
+static u32 retraceCalls = 0;
+static u32 lastRetrace = 0;
+/** The trap filter setting written by write_trap_filter */
+static int interruptEnable = 0;
+
+extern "C" u32 __VISendI2CData(u8 addr, void* val, u32 len) {
+    u8* buf = (u8*)val;
+    if (!host_isr_disabled()) {
+        unlockedSends++;
+    }
+    if (addr != ENCODER_ADDR || len < 2 || buf[0] + len - 1 > 0x100) {
+        badSends++;
+        return 0;
+    }
+    if (sendCount < sizeof(sends) / sizeof(sends[0])) {
+        sends[sendCount].reg = buf[0];
+        sends[sendCount].count = len - 1;
+    }
+    sendCount++;
+    if (failNext) {
+        failNext = FALSE;
+        return 0;
+    }
+    memcpy(&encoder[buf[0]], &buf[1], len - 1);
+    return 1;
+}
+
+/**
+ * Forgets the transactions sent
+ */
+static void reset_sends() {
+    sendCount = 0;
+}
+
+/**
+ * Returns whether the single transaction sent wrote the registers
+ */
+static BOOL sent_once(u8 reg, u32 count) {
+    return sendCount == 1 && sends[0].reg == reg && sends[0].count == count;
+}
+
+/**
+ * A post-retrace callback set by the application
+ */
+static void on_retrace(u32 retraceCnt) {
+    retraceCalls++;
+    lastRetrace = retraceCnt;
+}
+
+/**
+ * Another post-retrace callback, set after the retrace flush
+ */
+static void on_retrace_later(u32 retraceCnt) {}
+
+/**
+ * Writes unchanged registers are skipped, failed writes are resent
+ */
+static void test_skip() {
+    VIEncoderStats stats;
+
+    VIDEO_InvalidateEncoderState();
+    VIDEO_ResetEncoderStats();
+    reset_sends();
+    VIDEO_SetTrapFilter(TRUE);
+    VIDEO_SetTrapFilter(TRUE);
+    VIDEO_GetEncoderStats(&stats);
+    CHECK(sent_once(0x03, 1) && encoder[0x03] == 1,
+          "trap filter: %u transactions", sendCount);
+    CHECK(stats.issued == 1 && stats.skipped == 1,
+          "trap filter: %u issued, %u skipped", stats.issued, stats.skipped);
+
+    // The register is unknown after a failed write
+    reset_sends();
+    failNext = TRUE;
+    VIDEO_SetTrapFilter(FALSE);
+    CHECK(sendCount == 1 && encoder[0x03] == 1, "failed write: %u sent",
+          sendCount);
+    VIDEO_SetTrapFilter(FALSE);
+    CHECK(sendCount == 2 && encoder[0x03] == 0, "resent write: %u sent",
+          sendCount);
+
+    // As are all of them once invalidated
+    reset_sends();
+    VIDEO_InvalidateEncoderState();
+    VIDEO_SetTrapFilter(FALSE);
+    CHECK(sent_once(0x03, 1), "invalidated write: %u sent", sendCount);
+
+    // A failed queued write is sent again when queued again
+    reset_sends();
+    failNext = TRUE;
+    VIDEO_QueueWSS(0x1234);
+    VIDEO_FlushEncoderUpdates();
+    VIDEO_QueueWSS(0x1234);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sendCount == 2 && encoder[0x08] == 0x12 && encoder[0x09] == 0x34,
+          "failed queued write: %u sent", sendCount);
+}
+
+/**
+ * Queued registers are coalesced, neighbouring ones sent in one burst
+ */
+static void test_coalesce() {
+    VIDEO_InvalidateEncoderState();
+    __viStubRegs[1] = VI_DEBUG << 8;
+
+    // Queuing again replaces the pending value
+    reset_sends();
+    VIDEO_QueueWSS(0x1234);
+    VIDEO_QueueWSS(0x5678);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sent_once(0x08, 2) && encoder[0x08] == 0x56 && encoder[0x09] == 0x78,
+          "requeued: %u transactions", sendCount);
+
+    // Nothing is left to flush, nor sent for values the encoder holds
+    reset_sends();
+    VIDEO_FlushEncoderUpdates();
+    VIDEO_QueueWSS(0x5678);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sendCount == 0, "flushed twice: %u transactions", sendCount);
+
+    // Neighbouring registers are sent in one burst, a pending register which
+    // holds its value already is bridged
+    reset_sends();
+    VIDEO_QueueRGBOverDrive(2);
+    VIDEO_QueueWSS(0x6500);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sent_once(0x08, 3) && encoder[0x08] == 0x65 &&
+              encoder[0x09] == 0x00 && encoder[0x0A] == 0x05,
+          "burst: %u transactions", sendCount);
+    reset_sends();
+    VIDEO_QueueWSS(0x1200);
+    VIDEO_QueueRGBOverDrive(3);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sent_once(0x08, 3) && encoder[0x08] == 0x12 &&
+              encoder[0x09] == 0x00 && encoder[0x0A] == 0x07,
+          "bridged burst: %u transactions", sendCount);
+
+    // Registers apart are sent separately (0x04 to 0x07 are unknown)
+    reset_sends();
+    VIDEO_QueueWSS(0x4321);
+    VIDEO_QueueTrapFilter(TRUE);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sendCount == 2 && sends[0].reg == 0x03 && sends[0].count == 1 &&
+              sends[1].reg == 0x08 && sends[1].count == 2,
+          "apart: %u transactions", sendCount);
+
+    __viStubRegs[1] = 0;
+}
+
+/**
+ * Changing the gamma from each table to each other sends the changed
+ * coefficients, bridging gaps of up to 2 unchanged ones
+ */
+static void test_gamma_gaps() {
+    VIDEO_InvalidateEncoderState();
+    for (int g = VI_GM_0_1; g <= VI_GM_3_0; g++) {
+        VIDEO_SetGamma((VIGamma)g);
+        memcpy(gammas[g], &encoder[GAMMA_REG], GAMMA_SIZE);
+    }
+
+    int mismatches = 0, bridged = 0, split = 0;
+    for (int from = VI_GM_0_1; from <= VI_GM_3_0; from++) {
+        for (int to = VI_GM_0_1; to <= VI_GM_3_0; to++) {
+            const u8* a = gammas[from];
+            const u8* b = gammas[to];
+
+            VIDEO_SetGamma((VIGamma)from);
+            reset_sends();
+            VIDEO_QueueGamma((VIGamma)to);
+            VIDEO_FlushEncoderUpdates();
+
+            // The expected bursts, each from a changed coefficient to the
+            // last one followed by less than 3 unchanged ones
+            send expected[GAMMA_SIZE];
+            u32 expectedCount = 0;
+            for (u32 i = 0; i < GAMMA_SIZE;) {
+                if (a[i] == b[i]) {
+                    i++;
+                    continue;
+                }
+                u32 start = i, end = i, gap = 0, changed = 1;
+                for (i++; i < GAMMA_SIZE; i++) {
+                    if (a[i] != b[i]) {
+                        end = i;
+                        gap = 0;
+                        changed++;
+                    } else if (++gap > 2) {
+                        break;
+                    }
+                }
+                expected[expectedCount].reg = GAMMA_REG + start;
+                expected[expectedCount].count = end - start + 1;
+                expectedCount++;
+                if (changed < end - start + 1) {
+                    bridged++;
+                }
+                i = end + 1;
+            }
+            if (expectedCount > 1) {
+                split++;
+            }
+
+            BOOL match = sendCount == expectedCount &&
+                         !memcmp(&encoder[GAMMA_REG], b, GAMMA_SIZE);
+            for (u32 i = 0; match && i < expectedCount; i++) {
+                match = sends[i].reg == expected[i].reg &&
+                        sends[i].count == expected[i].count;
+            }
+            if (!match) {
+                mismatches++;
+            }
+        }
+    }
+    CHECK(!mismatches, "gamma: %d changes sent differently", mismatches);
+    CHECK(bridged && split, "gamma: %d bridged bursts, %d split changes",
+          bridged, split);
+}
+
+/**
+ * A direct write cancels the queued values of the registers it covers
+ */
+static void test_direct_cancel() {
+    VIDEO_InvalidateEncoderState();
+    VIDEO_SetTrapFilter(FALSE);
+    VIDEO_SetGamma(VI_GM_1_0);
+
+    reset_sends();
+    VIDEO_QueueTrapFilter(TRUE);
+    VIDEO_QueueGamma(VI_GM_2_2);
+    VIDEO_SetTrapFilter(FALSE);
+    VIDEO_SetGamma(VI_GM_1_0);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sendCount == 0 && encoder[0x03] == 0 &&
+              !memcmp(&encoder[GAMMA_REG], gammas[VI_GM_1_0], GAMMA_SIZE),
+          "unchanged direct writes: %u transactions", sendCount);
+
+    reset_sends();
+    VIDEO_QueueTrapFilter(FALSE);
+    VIDEO_QueueWSS(0x0102);
+    VIDEO_SetTrapFilter(TRUE);
+    VIDEO_FlushEncoderUpdates();
+    CHECK(sendCount == 2 && sends[0].reg == 0x03 && sends[1].reg == 0x08 &&
+              encoder[0x03] == 1,
+          "direct write: %u transactions", sendCount);
+}
+
+/**
+ * The retrace flush chains the previous callback, which is restored only
+ * while the flush is the installed callback
+ */
+static void test_retrace_flush() {
+    VIDEO_InvalidateEncoderState();
+    VIDEO_SetPostRetraceCallback(on_retrace);
+    host_set_retrace_count(100);
+
+    VIDEO_SetEncoderRetraceFlush(TRUE);
+    reset_sends();
+    VIDEO_QueueWSS(0x4242);
+    host_post_retrace();
+    CHECK(sent_once(0x08, 2), "retrace flush: %u transactions", sendCount);
+    CHECK(retraceCalls == 1 && lastRetrace == 101,
+          "retrace flush: %u chained calls (%u)", retraceCalls, lastRetrace);
+
+    VIDEO_SetEncoderRetraceFlush(FALSE);
+    CHECK(VIDEO_SetPostRetraceCallback(on_retrace) == on_retrace,
+          "disabled retrace flush: previous callback not restored");
+    reset_sends();
+    VIDEO_QueueWSS(0x2424);
+    host_post_retrace();
+    CHECK(sendCount == 0 && retraceCalls == 2,
+          "disabled retrace flush: %u transactions", sendCount);
+    VIDEO_FlushEncoderUpdates();
+
+    // A callback set after the flush was enabled is kept
+    VIDEO_SetEncoderRetraceFlush(TRUE);
+    VIDEO_SetPostRetraceCallback(on_retrace_later);
+    VIDEO_SetEncoderRetraceFlush(FALSE);
+    CHECK(VIDEO_SetPostRetraceCallback(NULL) == on_retrace_later,
+          "later callback replaced");
+}
+
+/**
+ * An interrupt writing the trap filter directly
+ */
+static void write_trap_filter() {
+    VIDEO_SetTrapFilter(interruptEnable);
+}
+
+/**
+ * A direct write from an interrupt served while the queued values are
+ * flushed is kept, rather than overwritten by a queued value of the same
+ * register taken before it
+ */
+static void test_interrupted_flush() {
+    VIDEO_InvalidateEncoderState();
+    for (interruptEnable = 0; interruptEnable < 2; interruptEnable++) {
+        reset_sends();
+        VIDEO_QueueTrapFilter(!interruptEnable);
+        VIDEO_QueueWSS(0x0100 + interruptEnable);
+        host_set_pending_interrupt(write_trap_filter);
+        VIDEO_FlushEncoderUpdates();
+        CHECK(encoder[0x03] == interruptEnable,
+              "interrupted flush: trap filter %d overwritten (%u sent)",
+              interruptEnable, sendCount);
+    }
+}
+
+int main() {
+    test_skip();
+    test_coalesce();
+    test_gamma_gaps();
+    test_direct_cancel();
+    test_retrace_flush();
+    test_interrupted_flush();
+
+    CHECK(!unlockedSends, "%u transactions sent with interrupts enabled",
+          unlockedSends);
+    CHECK(!badSends, "%u invalid transactions", badSends);
+
+    printf("vi_encoder_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Measures the throughput of the YCbCr conversions of a 640x480 frame
+// against the division based encoder and floating point decoder they
+// replaced. Built with and without WII_YCBCR_LUT.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "wii_ycbcr.h"
+
+#define WIDTH 640
+#define HEIGHT 480
+#define FRAMES 100
+
+/**
+ * The division based encoder the fixed point one replaced
+ */
+static u32 old_from_rgb(int r1, int g1, int b1, int r2, int g2, int b2) {
+    int y1 = (299 * r1 + 587 * g1 + 114 * b1) / 1000;
+    int cb1 = (-16874 * r1 - 33126 * g1 + 50000 * b1 + 12800000) / 100000;
+    int cr1 = (50000 * r1 - 41869 * g1 - 8131 * b1 + 12800000) / 100000;
+    int y2 = (299 * r2 + 587 * g2 + 114 * b2) / 1000;
+    int cb2 = (-16874 * r2 - 33126 * g2 + 50000 * b2 + 12800000) / 100000;
+    int cr2 = (50000 * r2 - 41869 * g2 - 8131 * b2 + 12800000) / 100000;
+    return (y1 << 24) | (((cb1 + cb2) >> 1) << 16) | (y2 << 8) |
+           ((cr1 + cr2) >> 1);
+}
+
+/**
+ * The floating point decoder the fixed point one replaced
+ */
+static void old_to_rgb(u32 ycbycr, u8* rgb) {
+    int y1 = ycbycr >> 24, cb = (ycbycr >> 16) & 0xff, y2 = (ycbycr >> 8) & 0xff,
+        cr = ycbycr & 0xff;
+    int r = 1.371f * (cr - 128);
+    int g = -0.698f * (cr - 128) - 0.336f * (cb - 128);
+    int b = 1.732f * (cb - 128);
+    rgb[0] = wii_ycbcr_clamp(y1 + r);
+    rgb[1] = wii_ycbcr_clamp(y1 + g);
+    rgb[2] = wii_ycbcr_clamp(y1 + b);
+    rgb[3] = wii_ycbcr_clamp(y2 + r);
+    rgb[4] = wii_ycbcr_clamp(y2 + g);
+    rgb[5] = wii_ycbcr_clamp(y2 + b);
+}
+
+/**
+ * Returns the current time in seconds
+ */
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    u8* rgb = (u8*)malloc(WIDTH * HEIGHT * 3);
+    u32* pairs = (u32*)malloc(WIDTH * HEIGHT * 2);
+    srand(1);
+    for (int i = 0; i < WIDTH * HEIGHT * 3; i++) {
+        rgb[i] = rand();
+    }
+
+    double start = now();
+    for (int n = 0; n < FRAMES; n++) {
+        for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH / 2; x++) {
+                const u8* p = rgb + (y * WIDTH + x * 2) * 3;
+                pairs[y * WIDTH / 2 + x] =
+                    old_from_rgb(p[0], p[1], p[2], p[3], p[4], p[5]);
+            }
+        }
+    }
+    double oldEncode = now() - start;
+
+    start = now();
+    for (int n = 0; n < FRAMES; n++) {
+        wii_ycbcr_from_rgb8(rgb, WIDTH * 3, pairs, WIDTH / 2, WIDTH, HEIGHT);
+    }
+    double encode = now() - start;
+
+    start = now();
+    for (int n = 0; n < FRAMES; n++) {
+        for (int i = 0; i < WIDTH * HEIGHT / 2; i++) {
+            old_to_rgb(pairs[i], rgb + i * 6);
+        }
+    }
+    double oldDecode = now() - start;
+
+    start = now();
+    for (int n = 0; n < FRAMES; n++) {
+        wii_ycbcr_to_rgb8(pairs, WIDTH / 2, rgb, WIDTH * 3, WIDTH, HEIGHT);
+    }
+    double decode = now() - start;
+
+    u32 sum = 0;
+    for (int i = 0; i < WIDTH * HEIGHT / 2; i++) {
+        sum += pairs[i] + rgb[i];
+    }
+
+#ifdef WII_YCBCR_LUT
+    const char* kernel = "tables";
+#else
+    const char* kernel = "multiplies";
+#endif
+    printf("%dx%d frames/s (%s): encode %.0f (old %.0f), decode %.0f "
+           "(old %.0f) [%08x]\n",
+           WIDTH, HEIGHT, kernel, FRAMES / encode, FRAMES / oldEncode,
+           FRAMES / decode, FRAMES / oldDecode, sum);
+
+    free(rgb);
+    free(pairs);
+    return 0;
+}
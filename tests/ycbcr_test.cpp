@@ -0,0 +1,223 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+//
+// Tests the YCbCr conversions against floating point references of the
+// encode matrix and its inverse, against the division based encoder they
+// replaced and for round trips. Built with and without WII_YCBCR_LUT.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wii_ycbcr.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                \
+    do {                                \
+        checks++;                       \
+        if (!(cond)) {                  \
+            failures++;                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");               \
+        }                               \
+    } while (0)
+
+/**
+ * The division based encoder the fixed point one replaced (from a libogc
+ * example)
+ */
+static u32 old_from_rgb(int r1, int g1, int b1, int r2, int g2, int b2) {
+    int y1 = (299 * r1 + 587 * g1 + 114 * b1) / 1000;
+    int cb1 = (-16874 * r1 - 33126 * g1 + 50000 * b1 + 12800000) / 100000;
+    int cr1 = (50000 * r1 - 41869 * g1 - 8131 * b1 + 12800000) / 100000;
+    int y2 = (299 * r2 + 587 * g2 + 114 * b2) / 1000;
+    int cb2 = (-16874 * r2 - 33126 * g2 + 50000 * b2 + 12800000) / 100000;
+    int cr2 = (50000 * r2 - 41869 * g2 - 8131 * b2 + 12800000) / 100000;
+    return (y1 << 24) | (((cb1 + cb2) >> 1) << 16) | (y2 << 8) |
+           ((cr1 + cr2) >> 1);
+}
+
+/**
+ * Returns the pair of the specified pixels, rounded from floating point
+ */
+static u32 ref_from_rgb(int r1, int g1, int b1, int r2, int g2, int b2) {
+    double r = (r1 + r2) / 2.0, g = (g1 + g2) / 2.0, b = (b1 + b2) / 2.0;
+    int y1 = (int)floor(0.299 * r1 + 0.587 * g1 + 0.114 * b1 + 0.5);
+    int y2 = (int)floor(0.299 * r2 + 0.587 * g2 + 0.114 * b2 + 0.5);
+    int cb = (int)floor(-0.168736 * r - 0.331264 * g + 0.5 * b + 128.5);
+    int cr = (int)floor(0.5 * r - 0.418688 * g - 0.081312 * b + 128.5);
+    return (y1 << 24) | (cb << 16) | (y2 << 8) | cr;
+}
+
+/**
+ * Returns the largest difference between the components of two pairs
+ */
+static int pair_diff(u32 a, u32 b) {
+    int max = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        int d = abs((int)((a >> shift) & 0xff) - (int)((b >> shift) & 0xff));
+        if (d > max) {
+            max = d;
+        }
+    }
+    return max;
+}
+
+/**
+ * Returns the largest difference of the decoded pixels from the floating
+ * point inverse of the encode matrix
+ */
+static int decode_diff(u32 ycbycr) {
+    u8 rgb[6];
+    wii_ycbcr_to_rgb(ycbycr, rgb);
+
+    double y[2] = {(double)(ycbycr >> 24), (double)((ycbycr >> 8) & 0xff)};
+    double cb = (double)((ycbycr >> 16) & 0xff) - 128;
+    double cr = (double)(ycbycr & 0xff) - 128;
+    int max = 0;
+    for (int i = 0; i < 2; i++) {
+        double ref[3] = {y[i] + 1.402 * cr,
+                         y[i] - 0.344136 * cb - 0.714136 * cr,
+                         y[i] + 1.772 * cb};
+        for (int c = 0; c < 3; c++) {
+            int v = (int)floor(ref[c] + 0.5);
+            v = v < 0 ? 0 : (v > 255 ? 255 : v);
+            int d = abs(v - rgb[i * 3 + c]);
+            if (d > max) {
+                max = d;
+            }
+        }
+    }
+    return max;
+}
+
+static void test_encode() {
+    int refMax = 0, oldMax = 0, colorMismatches = 0;
+    srand(1);
+    for (int i = 0; i < 1000000; i++) {
+        int c[6];
+        for (int k = 0; k < 6; k++) {
+            c[k] = rand() & 0xff;
+        }
+        if (i & 1) {
+            memcpy(c + 3, c, 3 * sizeof(int));
+        }
+        u32 p = wii_ycbcr_from_rgb(c[0], c[1], c[2], c[3], c[4], c[5]);
+        int d = pair_diff(p, ref_from_rgb(c[0], c[1], c[2], c[3], c[4], c[5]));
+        refMax = d > refMax ? d : refMax;
+        d = pair_diff(p, old_from_rgb(c[0], c[1], c[2], c[3], c[4], c[5]));
+        oldMax = d > oldMax ? d : oldMax;
+        if ((i & 1) && wii_ycbcr_from_color(c[0], c[1], c[2]) != p) {
+            colorMismatches++;
+        }
+    }
+    CHECK(!colorMismatches, "from_color differs from from_rgb %d times",
+          colorMismatches);
+    CHECK(refMax <= 1, "encode differs from the reference by %d", refMax);
+    CHECK(oldMax <= 1, "encode differs from the old encoder by %d", oldMax);
+}
+
+static void test_decode() {
+    int max = 0;
+    for (u32 y = 0; y < 256; y += 5) {
+        for (u32 cb = 0; cb < 256; cb++) {
+            for (u32 cr = 0; cr < 256; cr++) {
+                int d = decode_diff((y << 24) | (cb << 16) | (y << 8) | cr);
+                max = d > max ? d : max;
+            }
+        }
+    }
+    CHECK(max <= 1, "decode differs from the reference by %d", max);
+}
+
+static void test_round_trip() {
+    int max = 0;
+    for (int r = 0; r < 256; r += 3) {
+        for (int g = 0; g < 256; g += 3) {
+            for (int b = 0; b < 256; b += 3) {
+                u8 rgb[6];
+                wii_ycbcr_to_rgb(wii_ycbcr_from_color(r, g, b), rgb);
+                int d = abs(rgb[0] - r);
+                d = abs(rgb[1] - g) > d ? abs(rgb[1] - g) : d;
+                d = abs(rgb[2] - b) > d ? abs(rgb[2] - b) : d;
+                max = d > max ? d : max;
+            }
+        }
+    }
+    CHECK(max <= 1, "round trip is off by %d", max);
+}
+
+static void test_images() {
+    const int w = 34, h = 7, srcPitch = w * 3 + 5, dstPitch = w / 2 + 3;
+    u8 src[srcPitch * h];
+    u32 pairs[dstPitch * h];
+    u8 dst[srcPitch * h];
+    srand(2);
+    for (int i = 0; i < srcPitch * h; i++) {
+        src[i] = rand();
+    }
+    memset(pairs, 0xa5, sizeof(pairs));
+    memset(dst, 0xa5, sizeof(dst));
+
+    wii_ycbcr_from_rgb8(src, srcPitch, pairs, dstPitch, w, h);
+    wii_ycbcr_to_rgb8(pairs, dstPitch, dst, srcPitch, w, h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w / 2; x++) {
+            const u8* p = src + y * srcPitch + x * 6;
+            u32 pair = pairs[y * dstPitch + x];
+            CHECK(pair == wii_ycbcr_from_rgb(p[0], p[1], p[2], p[3], p[4],
+                                             p[5]),
+                  "from_rgb8 %d,%d", x, y);
+            u8 rgb[6];
+            wii_ycbcr_to_rgb(pair, rgb);
+            CHECK(!memcmp(rgb, dst + y * srcPitch + x * 6, 6),
+                  "to_rgb8 %d,%d", x, y);
+        }
+        for (int x = w / 2; x < dstPitch; x++) {
+            CHECK(pairs[y * dstPitch + x] == 0xa5a5a5a5,
+                  "from_rgb8 wrote past the row %d,%d", x, y);
+        }
+        for (int x = w * 3; x < srcPitch; x++) {
+            CHECK(dst[y * srcPitch + x] == 0xa5,
+                  "to_rgb8 wrote past the row %d,%d", x, y);
+        }
+    }
+}
+
+int main() {
+    test_encode();
+    test_decode();
+    test_round_trip();
+    test_images();
+
+    printf("ycbcr_test: %d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+//
+// Font cache baker. Bakes the FreeTypeGX font cache (see FT_SaveFontCache)
+// on a Linux host, so the Wii loads the prebaked glyphs on its first start
+// instead of rasterizing and writing them itself. The cache is matched to
+// the font by its size and hash, so it must be baked from the same font
+// buffer the application passes to InitFreeType.
+//
+//   ftgx_bake <font file> <cache file> [pixel size ...]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeTypeGX.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr,
+                "usage: %s <font file> <cache file> [pixel size ...]\n",
+                argv[0]);
+        return 2;
+    }
+
+    FILE* fp = fopen(argv[1], "rb");
+    if (!fp) {
+        fprintf(stderr, "unable to open %s\n", argv[1]);
+        return 1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t* font = (uint8_t*)malloc(size);
+    if (!font || fread(font, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "unable to read %s\n", argv[1]);
+        fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+
+    // NULL selects the default sizes
+    FT_UInt* sizes = NULL;
+    int sizeCount = argc - 3;
+    if (sizeCount > 0) {
+        sizes = (FT_UInt*)malloc(sizeCount * sizeof(FT_UInt));
+        for (int i = 0; i < sizeCount; i++) {
+            sizes[i] = atoi(argv[i + 3]);
+        }
+    }
+
+    InitFreeType(font, size);
+    if (!FT_SaveFontCache(argv[2], sizes, sizeCount)) {
+        fprintf(stderr, "unable to write %s\n", argv[2]);
+        return 1;
+    }
+
+    ftgxCacheStats stats;
+    FT_GetFontCacheStats(&stats);
+    printf("%s: %u glyphs, %u bytes of textures\n", argv[2],
+           stats.glyphCount, stats.totalBytes);
+
+    ClearFontData();
+    free(sizes);
+    free(font);
+    return 0;
+}
@@ -0,0 +1,143 @@
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  wii-emucommon:                                                           //
+//  Wii emulator common code                                                 //
+//                                                                           //
+//  [github.com/raz0red/wii-emucommon]                                       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+//  Copyright (C) 2019 raz0red                                               //
+//                                                                           //
+//  This program is free software; you can redistribute it and/or            //
+//  modify it under the terms of the GNU General Public License              //
+//  as published by the Free Software Foundation; either version 2           //
+//  of the License, or (at your option) any later version.                   //
+//                                                                           //
+//  This program is distributed in the hope that it will be useful,          //
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+//  GNU General Public License for more details.                             //
+//                                                                           //
+//  You should have received a copy of the GNU General Public License        //
+//  along with this program; if not, write to the Free Software              //
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA            //
+//  02110-1301, USA.                                                         //
+//---------------------------------------------------------------------------//
+
+//
+// Image cache baker. Decodes a directory of PNG images into the pre-swizzled
+// texture cache files (.gxt) that wii_gx_loadimage* reads once an image
+// cache directory is set (see wii_gx_set_image_cache_dir), so the Wii skips
+// the PNG decode on the first load as well.
+//
+// The cache files are named after the path the application loads an image
+// from, so the device directory is the image directory as the Wii sees it
+// (for example sd:/apps/myemu/res). They are only used while the size and
+// modification time of an image match those it was baked from, so bake from
+// the images as they are on the SD card; a cache that doesn't match is
+// simply decoded and written again by the Wii.
+//
+//   gxt_bake [-c] [-m maxdim] <image dir> <device dir> <cache dir>
+//
+//   -c          bake the compact variant (wii_gx_loadimage_compact)
+//   -m maxdim   bake for the maximum dimension (wii_gx_loadimage_scaled and
+//               wii_gx_loadimage_compact)
+//
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gccore.h>
+
+#include "pngu.h"
+#include "wii_gx_image.h"
+
+/**
+ * Returns whether the file name has a .png extension
+ */
+static bool ispng(const char* name) {
+    size_t len = strlen(name);
+    return len > 4 && !strcasecmp(name + len - 4, ".png");
+}
+
+int main(int argc, char* argv[]) {
+    bool compact = false;
+    int maxdim = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "cm:")) != -1) {
+        switch (opt) {
+            case 'c':
+                compact = true;
+                break;
+            case 'm':
+                maxdim = atoi(optarg);
+                break;
+            default:
+                argc = 0;
+                break;
+        }
+    }
+    if (argc - optind != 3) {
+        fprintf(stderr,
+                "usage: %s [-c] [-m maxdim] <image dir> <device dir> "
+                "<cache dir>\n",
+                argv[0]);
+        return 2;
+    }
+    const char* imagedir = argv[optind];
+    const char* devicedir = argv[optind + 1];
+    const char* cachedir = argv[optind + 2];
+
+    DIR* dir = opendir(imagedir);
+    if (!dir) {
+        fprintf(stderr, "unable to open %s\n", imagedir);
+        return 1;
+    }
+    mkdir(cachedir, 0777);
+
+    int baked = 0, failed = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!ispng(entry->d_name)) {
+            continue;
+        }
+
+        char path[4096], imgpath[4096], cachepath[4096];
+        snprintf(path, sizeof(path), "%s/%s", imagedir, entry->d_name);
+        snprintf(imgpath, sizeof(imgpath), "%s/%s", devicedir, entry->d_name);
+        wii_gx_image_cachepath(cachedir, imgpath, maxdim, compact, cachepath,
+                               sizeof(cachepath));
+
+        struct stat st;
+        int width, height;
+        u8 format;
+        u8* data = NULL;
+        if (!stat(path, &st)) {
+            IMGCTX ctx = PNGU_SelectImageFromDevice(path);
+            data = wii_gx_image_decode(ctx, maxdim, compact, &width, &height,
+                                       &format);
+            PNGU_ReleaseImageContext(ctx);
+        }
+        if (data && wii_gx_image_savecache(cachepath, imgpath, st.st_size,
+                                           st.st_mtime, maxdim, data, width,
+                                           height, format)) {
+            printf("%s -> %s (%dx%d, format %d)\n", imgpath, cachepath, width,
+                   height, format);
+            baked++;
+        } else {
+            fprintf(stderr, "unable to bake %s\n", path);
+            failed++;
+        }
+        free(data);
+    }
+    closedir(dir);
+    PNGU_ReleaseBandBuffers();
+
+    printf("%d images baked, %d failed\n", baked, failed);
+    return failed ? 1 : 0;
+}